@@ -0,0 +1,75 @@
+// @file:     main.cc
+// @author:   agent
+// @created:  2026.10.17
+// @license:  Apache License 2.0
+//
+// @desc:     Main function for the native DB pattern recognition plugin. 
+//            Reads the DBs from the problem file, recognizes patterns among
+//            the DBs which are not yet in aggregates and returns a command 
+//            forming an aggregate for each recognized pattern.
+
+#include "pattern_recognition.h"
+#include "siqadconn.h"
+
+#include <iostream>
+#include <string>
+
+using namespace dbpr;
+
+bool boolParameter(phys::SiQADConnector &sqconn, const std::string &key, bool fallback)
+{
+  if (!sqconn.parameterExists(key))
+    return fallback;
+  std::string val = sqconn.getParameter(key);
+  return val == "true" || val == "1";
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " IN_FILE OUT_FILE" << std::endl;
+    return 1;
+  }
+
+  phys::SiQADConnector sqconn("DBPatternRecognition", argv[1], argv[2]);
+
+  RecognitionParams params;
+  if (sqconn.parameterExists("min_dbp_inner_distance"))
+    params.d_inner_min = std::stof(sqconn.getParameter("min_dbp_inner_distance"));
+  if (sqconn.parameterExists("max_dbp_inner_distance"))
+    params.d_inner_max = std::stof(sqconn.getParameter("max_dbp_inner_distance"));
+  if (sqconn.parameterExists("min_chain_length"))
+    params.min_chain_length = std::stoi(sqconn.getParameter("min_chain_length"));
+  params.pairs = boolParameter(sqconn, "recognize_pairs", true);
+  params.chains = boolParameter(sqconn, "recognize_chains", false);
+  params.fan_outs = boolParameter(sqconn, "recognize_fan_outs", false);
+
+  // only DBs which are not already in aggregates take part
+  phys::DBArrays *db_arrays = sqconn.dbArrays();
+  std::vector<float> xs, ys;
+  for (size_t i=0; i<db_arrays->size(); i++) {
+    if (db_arrays->aggregate()[i] != 0)
+      continue;
+    xs.push_back(db_arrays->x()[i]);
+    ys.push_back(db_arrays->y()[i]);
+  }
+
+  DBPatternRecognition recognizer(xs, ys, params);
+  std::vector<Pattern> patterns = recognizer.runRecognition();
+
+  int type_counts[3] = {0, 0, 0};
+  for (const Pattern &pattern : patterns) {
+    std::vector<std::pair<float, float>> db_locs;
+    for (int db : pattern.db_inds)
+      db_locs.push_back(std::make_pair(xs[db], ys[db]));
+    phys::AggregateCommand command(db_locs);
+    sqconn.addSQCommand(&command);
+    type_counts[pattern.type]++;
+  }
+  std::cout << "Recognized " << type_counts[Pair] << " pairs, " 
+    << type_counts[Chain] << " chains and " << type_counts[FanOut] 
+    << " fan-outs." << std::endl;
+
+  // results are written when the connector goes out of scope
+  return 0;
+}
@@ -0,0 +1,179 @@
+// @file:     pattern_recognition.cc
+// @author:   agent
+// @created:  2026.10.17
+// @license:  Apache License 2.0
+//
+// @desc:     Implementation of DBPatternRecognition.
+
+#include "pattern_recognition.h"
+#include "siqadconn.h"
+
+#include <cmath>
+#include <queue>
+#include <algorithm>
+
+using namespace dbpr;
+
+DBPatternRecognition::DBPatternRecognition(const std::vector<float> &xs,
+    const std::vector<float> &ys, const RecognitionParams &params)
+  : xs(xs), ys(ys), params(params)
+{
+}
+
+std::vector<Pattern> DBPatternRecognition::runRecognition()
+{
+  std::vector<Pattern> patterns;
+  if (xs.size() < 2)
+    return patterns;
+
+  buildNeighborGraph();
+  visited.assign(xs.size(), false);
+  taken.assign(xs.size(), false);
+
+  // chains and fan-outs are tree-shaped components of the neighbor graph, 
+  // components containing loops are left to pair recognition
+  if (params.chains || params.fan_outs) {
+    std::vector<int> comp;
+    for (size_t i=0; i<xs.size(); i++) {
+      if (visited[i] || neighbors[i].empty())
+        continue;
+      int edge_count = collectComponent(i, comp);
+      if (edge_count != static_cast<int>(comp.size()) - 1)
+        continue;
+
+      size_t max_degree = 0;
+      for (int db : comp)
+        max_degree = std::max(max_degree, neighbors[db].size());
+
+      Pattern pattern;
+      if (max_degree <= 2 && params.chains
+          && static_cast<int>(comp.size()) >= params.min_chain_length) {
+        pattern.type = Chain;
+        pattern.db_inds = chainOrder(comp);
+      } else if (max_degree > 2 && params.fan_outs) {
+        pattern.type = FanOut;
+        pattern.db_inds = fanOutOrder(comp);
+      } else {
+        continue;
+      }
+      for (int db : comp)
+        taken[db] = true;
+      patterns.push_back(pattern);
+    }
+  }
+
+  if (params.pairs)
+    recognizePairs(patterns);
+
+  return patterns;
+}
+
+void DBPatternRecognition::buildNeighborGraph()
+{
+  // cells as wide as the maximum distance so that each query only visits the
+  // surrounding 3x3 cells
+  phys::DBSpatialIndex index(xs, ys, params.d_inner_max);
+
+  // pair recognition only needs the nearest neighbor of each DB
+  bool keep_neighbors = params.chains || params.fan_outs;
+  neighbors.assign(xs.size(), std::vector<int>());
+  nearest.assign(xs.size(), -1);
+  for (size_t i=0; i<xs.size(); i++) {
+    float nearest_r = params.d_inner_max;
+    for (int j : index.neighborsOfDB(i, params.d_inner_max)) {
+      float r = std::hypot(xs[i] - xs[j], ys[i] - ys[j]);
+      if (r <= params.d_inner_min || r >= params.d_inner_max)
+        continue;
+      if (keep_neighbors)
+        neighbors[i].push_back(j);
+      // neighbors come in ascending order, ties go to the lowest index
+      if (r < nearest_r) {
+        nearest_r = r;
+        nearest[i] = j;
+      }
+    }
+  }
+}
+
+int DBPatternRecognition::collectComponent(int db_ind, std::vector<int> &comp)
+{
+  comp.clear();
+  size_t degree_sum = 0;
+  std::queue<int> to_visit;
+  to_visit.push(db_ind);
+  visited[db_ind] = true;
+  while (!to_visit.empty()) {
+    int db = to_visit.front();
+    to_visit.pop();
+    comp.push_back(db);
+    degree_sum += neighbors[db].size();
+    for (int n : neighbors[db]) {
+      if (!visited[n]) {
+        visited[n] = true;
+        to_visit.push(n);
+      }
+    }
+  }
+  return degree_sum / 2;
+}
+
+std::vector<int> DBPatternRecognition::chainOrder(const std::vector<int> &comp) const
+{
+  // start from the lowest indexed end and walk to the other
+  int start = -1;
+  for (int db : comp)
+    if (neighbors[db].size() == 1 && (start < 0 || db < start))
+      start = db;
+
+  std::vector<int> order;
+  int prev = -1, curr = start;
+  while (curr >= 0) {
+    order.push_back(curr);
+    int next = -1;
+    for (int n : neighbors[curr])
+      if (n != prev)
+        next = n;
+    prev = curr;
+    curr = next;
+  }
+  return order;
+}
+
+std::vector<int> DBPatternRecognition::fanOutOrder(const std::vector<int> &comp) const
+{
+  int root = comp.front();
+  for (int db : comp)
+    if (neighbors[db].size() > neighbors[root].size()
+        || (neighbors[db].size() == neighbors[root].size() && db < root))
+      root = db;
+
+  std::vector<int> order;
+  std::vector<int> parent(1, -1);
+  order.push_back(root);
+  for (size_t i=0; i<order.size(); i++) {
+    for (int n : neighbors[order[i]]) {
+      if (n != parent[i]) {
+        order.push_back(n);
+        parent.push_back(order[i]);
+      }
+    }
+  }
+  return order;
+}
+
+void DBPatternRecognition::recognizePairs(std::vector<Pattern> &patterns)
+{
+  for (size_t i=0; i<xs.size(); i++) {
+    int j = nearest[i];
+    if (taken[i] || j < 0 || taken[j])
+      continue;
+    if (nearest[j] == static_cast<int>(i)) {
+      Pattern pattern;
+      pattern.type = Pair;
+      pattern.db_inds = {static_cast<int>(i), j};
+      taken[i] = true;
+      taken[j] = true;
+      patterns.push_back(pattern);
+    }
+  }
+}
@@ -0,0 +1,85 @@
+// @file:     pattern_recognition.h
+// @author:   agent
+// @created:  2026.10.17
+// @license:  Apache License 2.0
+//
+// @desc:     Recognize DB patterns (pairs, chains and fan-outs) in a DB 
+//            layout using a neighbor graph built from a spatial hash, so that
+//            no pairwise distance matrix is ever formed.
+
+#ifndef _DBP_PATTERN_RECOGNITION_H_
+#define _DBP_PATTERN_RECOGNITION_H_
+
+#include <vector>
+
+namespace dbpr {
+
+  // Kinds of patterns that can be recognized.
+  enum PatternType{Pair, Chain, FanOut};
+
+  // A recognized pattern, DB indices refer to the arrays given to the
+  // recognizer. Chains list their DBs from one end to the other, fan-outs 
+  // list their DBs in breadth-first order starting from the widest branch 
+  // point.
+  struct Pattern
+  {
+    PatternType type;
+    std::vector<int> db_inds;
+  };
+
+  // Recognition parameters.
+  struct RecognitionParams
+  {
+    float d_inner_min=0;      // DBs closer than this are not considered neighbors
+    float d_inner_max=200;    // DBs further than this are not considered neighbors
+    bool pairs=true;          // recognize DB pairs
+    bool chains=false;        // recognize chains of DBs
+    bool fan_outs=false;      // recognize trees of DBs with branch points
+    int min_chain_length=3;   // chains with fewer DBs are left to pair recognition
+  };
+
+  class DBPatternRecognition
+  {
+  public:
+
+    // Constructor taking the DB locations and the recognition parameters.
+    DBPatternRecognition(const std::vector<float> &xs, 
+                         const std::vector<float> &ys,
+                         const RecognitionParams &params);
+
+    // Perform the recognition in one pass over the neighbor graph and return
+    // the recognized patterns. Each DB belongs to at most one pattern.
+    std::vector<Pattern> runRecognition();
+
+  private:
+
+    // Build the neighbor lists of all DBs and the nearest neighbor of each.
+    void buildNeighborGraph();
+
+    // Collect the connected component containing db_ind into comp, returning
+    // the number of edges in the component.
+    int collectComponent(int db_ind, std::vector<int> &comp);
+
+    // Order the DBs of a chain component from one end to the other.
+    std::vector<int> chainOrder(const std::vector<int> &comp) const;
+
+    // Order the DBs of a fan-out component breadth-first from its widest 
+    // branch point.
+    std::vector<int> fanOutOrder(const std::vector<int> &comp) const;
+
+    // Pair up mutual nearest neighbors among the DBs not taken by other 
+    // patterns.
+    void recognizePairs(std::vector<Pattern> &patterns);
+
+    std::vector<float> xs, ys;
+    RecognitionParams params;
+
+    std::vector<std::vector<int>> neighbors;  // in-range neighbors of each DB
+    std::vector<int> nearest;                 // nearest in-range neighbor, -1 if none
+    std::vector<bool> visited;                // DB already assigned to a component
+    std::vector<bool> taken;                  // DB already part of a pattern
+  };
+
+}
+
+#endif
@@ -13,33 +13,79 @@ __version__     = '0.1'
 __date__        = '2019-03-13'  # last update
 
 from argparse import ArgumentParser
+from urllib.parse import unquote
 import os.path
+import sys
+import traceback
 import numpy as np
-from scipy.spatial import distance
 
 import siqadconn
 
 class SiQADInterface:
     '''Interface with SiQAD using SiQADConnector and command line arguments.'''
 
-    dbs = []        # list of tuples of floats containing DB locations (x, y)
+    dbs = []        # N x 2 array of DB locations (x, y)
 
     def __init__(self):
         '''Initialize the interface.'''
         self.parse_cml_args()
-        self.sqconn = siqadconn.SiQADConnector("DBPairRecognizer", 
-                self.args.in_file, self.args.out_file)
 
     def exec(self):
-        '''Execute the recognition process.
+        '''Execute the recognition process, or serve requests from SiQAD if 
+        running as a daemon.
         
         Returns:
             An integer indicating the exit state (0 for clean, 1 for error).
         '''
-        # TODO exception checks 
-        self.init_problem()
-        self.perform_recognition()
-        self.export_results()
+        if self.args.daemon:
+            return self.serve_requests()
+        return self.run_job(self.args.in_file, self.args.out_file)
+
+    def run_job(self, in_file, out_file):
+        '''Perform the recognition on a single problem file. Exceptions are
+        passed on after the partial output of the failed job is deleted.'''
+        sqconn = siqadconn.SiQADConnector("DBPairRecognizer", in_file, 
+                out_file)
+        try:
+            self.init_problem(sqconn)
+            self.perform_recognition()
+            self.export_results(sqconn)
+        except BaseException as e:
+            # frames in the traceback hold on to the connector, clear them so
+            # that it is destroyed before its partial output is deleted
+            traceback.clear_frames(e.__traceback__)
+            del sqconn
+            if os.path.exists(out_file):
+                os.remove(out_file)
+            raise
+        # results are written when the connector is destroyed
+        del sqconn
+        return 0
+
+    def serve_requests(self):
+        '''Serve job step requests from SiQAD until stdin is closed, saving 
+        the interpreter start-up and imports for every job step. Each request 
+        is a line "run <problem path> <result path> <step tmp path>" with 
+        percent-encoded paths and is answered by "[SQDAEMON] done <exit code>".
+        Steps exchanging through shared memory append the problem and result
+        segment names, which SiQADConnector picks up from the environment.
+        '''
+        for line in sys.stdin:
+            fields = line.split()
+            ret = 1
+            if len(fields) >= 3 and fields[0] == 'run':
+                for i, key in ((4, 'SIQAD_PROBLEM_SHM'), (5, 'SIQAD_RESULT_SHM')):
+                    if len(fields) > i:
+                        os.environ[key] = unquote(fields[i])
+                    else:
+                        os.environ.pop(key, None)
+                try:
+                    ret = self.run_job(unquote(fields[1]), unquote(fields[2]))
+                except Exception:
+                    traceback.print_exc(file=sys.stdout)
+            else:
+                print('Unrecognized request: {}'.format(line.strip()))
+            print('[SQDAEMON] done {}'.format(ret), flush=True)
         return 0
 
     def parse_cml_args(self):
@@ -55,25 +101,32 @@ class SiQADInterface:
                 "locations and return SiQAD commands instructing SiQAD to form "
                 "an aggregate for each DB-pair. DBs which are already in "
                 "aggregates are ignored.")
-        parser.add_argument(dest="in_file", type=file_must_exist,
+        parser.add_argument(dest="in_file", type=file_must_exist, nargs="?",
                 help="Path to the problem file.", metavar="IN_FILE")
         parser.add_argument(dest="out_file", help="Path to the output file.",
-                metavar="OUT_FILE")
+                nargs="?", metavar="OUT_FILE")
+        parser.add_argument("--daemon", action="store_true",
+                help="Serve job step requests from SiQAD on stdin instead of "
+                "running once.")
         self.args = parser.parse_args()
+        if not self.args.daemon and (self.args.in_file is None 
+                or self.args.out_file is None):
+            parser.error("IN_FILE and OUT_FILE are required unless running "
+                    "as a daemon.")
 
-    def init_problem(self):
+    def init_problem(self, sqconn):
         '''Initialize problem using user parameters and DB design retrieved from 
         SiQADConnector.'''
 
-        # TODO the following loop gets DBs that are already in aggregates, see 
-        # if there's a flag to prevent this or other ways of reading DBs such as 
-        # directly accessing the items data structure.
-        for db in self.sqconn.dbCollection():
-            self.dbs.append((db.x, db.y))
+        # take DB locations straight from the connector's flat arrays, 
+        # skipping DBs which are already in aggregates
+        db_arrays = sqconn.dbArrays()
+        free_dbs = db_arrays.aggregate == 0
+        self.dbs = np.column_stack((db_arrays.x[free_dbs], db_arrays.y[free_dbs]))
 
         # plugin parameters
-        self.d_inner_max = float(self.sqconn.getParameter('max_dbp_inner_distance'))
-        self.d_inner_min = float(self.sqconn.getParameter('min_dbp_inner_distance'))
+        self.d_inner_max = float(sqconn.getParameter('max_dbp_inner_distance'))
+        self.d_inner_min = float(sqconn.getParameter('min_dbp_inner_distance'))
         print('inner_max={}, inner_min={}'.format(self.d_inner_max, self.d_inner_min))
 
     def perform_recognition(self):
@@ -83,7 +136,7 @@ class SiQADInterface:
         recognizer = DBPairRecognition(self.dbs, self.d_inner_min, self.d_inner_max)
         self.dbp_aggs = recognizer.run_recognition()
 
-    def export_results(self):
+    def export_results(self, sqconn):
         '''Convert the results stored in self.dbp_aggs to SiQADCommands and 
         export the commands through SiQADConnector.'''
 
@@ -94,13 +147,13 @@ class SiQADInterface:
         for i in range(len(self.dbp_aggs)):
             agg = []
             for db_ind in self.dbp_aggs[i]:
-                agg.append(self.dbs[db_ind])
+                agg.append((float(self.dbs[db_ind][0]), float(self.dbs[db_ind][1])))
             dbp_aggs_with_loc.append(agg)
         #print(dbp_aggs_with_loc)
 
         for i in range(len(self.dbp_aggs)):
             #print('About to add command for agg: {}'.format(dbp_aggs_with_loc[i]))
-            self.sqconn.addCommand('add', 'Aggregate', dbagg=dbp_aggs_with_loc[i])
+            sqconn.addCommand('add', 'Aggregate', dbagg=dbp_aggs_with_loc[i])
             #self.sqconn.addSQCommand(siqadconn.AggregateCommand(dbp_aggs))
 
 
@@ -132,23 +185,24 @@ class DBPairRecognition:
         # TODO set default values for d_inner_min and max if the input ones are 
         # None.
 
-        # construct distance matrix and prune out-of-range elements,
-        # "pruning" is done by setting the out-of-bound values to values greater
-        # than the max bound
-        db_r = distance.cdist(self.dbs, self.dbs, 'euclidean')
-        db_r_pruned = np.where((db_r>self.d_inner_min) & (db_r<self.d_inner_max), 
-                db_r, self.d_inner_max+1)
-
-        # find DB index corresponding to the nearest DB of each row
-        min_ind = np.argmin(db_r_pruned, axis=1)
+        # find the nearest in-range DB of each DB, only DBs in nearby cells of 
+        # the spatial index are compared
+        index = siqadconn.DBSpatialIndex(self.dbs[:,0].astype(float).tolist(),
+                self.dbs[:,1].astype(float).tolist(), self.d_inner_max)
+        min_ind = np.full(len(self.dbs), -1, dtype=int)
+        for i in range(len(self.dbs)):
+            min_r = self.d_inner_max
+            for j in index.neighborsOfDB(i, self.d_inner_max):
+                r = np.hypot(*(self.dbs[i] - self.dbs[j]))
+                if self.d_inner_min < r < min_r:
+                    min_r = r
+                    min_ind[i] = j
 
         db_ind_aggs = []
         for i in range(len(min_ind)):
-            if db_r_pruned[i][min_ind[i]] > self.d_inner_max or min_ind[i] < 0:
+            if min_ind[i] < 0:
                 continue
             j = min_ind[i]
-            if i == j:
-                continue
             if i == min_ind[j]:
                 # found mutual nearest neighbor
                 print('nearest neighbors (min_ind[i], min_ind[j])={}'.format((min_ind[i], min_ind[j])))
@@ -158,6 +212,5 @@ class DBPairRecognition:
         return db_ind_aggs
 
 if __name__ == "__main__":
-    import sys
     interface = SiQADInterface()
     sys.exit(interface.exec())
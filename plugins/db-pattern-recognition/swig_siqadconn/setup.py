@@ -6,10 +6,13 @@ setup.py file for SWIG phys connector
 
 from distutils.core import setup, Extension
 import os
+import sys
 os.environ["CC"] = "g++"
 os.environ["CXX"] = "g++"
 siqadconn_module = Extension('_siqadconn',
                                 sources=['siqadconn_wrap.cxx', 'siqadconn.cc'],
+                                # POSIX shared memory for problem and result exchange
+                                libraries=['rt'] if sys.platform.startswith('linux') else [],
                                 )
 
 setup (
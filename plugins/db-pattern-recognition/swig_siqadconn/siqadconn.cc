@@ -8,17 +8,139 @@
 
 #include "siqadconn.h"
 #include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cctype>
+#include <cstdint>
 #include <stdexcept>
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/xml_parser.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
 #include <boost/algorithm/string/join.hpp>
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 
 using namespace phys;
 
 boost::bimap<SQCommand::CommandAction, std::string> SQCommand::command_action_string;
 boost::bimap<SQCommand::CommandItem, std::string> SQCommand::command_item_string;
 
+// Bounds checked reader over a binary problem (or one of its sections), the
+// layout mirrors the binary result format:
+//   header:   char magic[4] = "SQPB", uint32 version, uint32 section count, 
+//             uint32 reserved, then one {uint32 type, uint32 reserved, 
+//             uint64 offset, uint64 size} entry per section
+//   program, sim_params: uint32 count, count * {string key, string value}
+//   layers:     uint32 count, count * {string name, string type, string role,
+//               float zoffset, float zheight}
+//   aggregates: uint32 count, uint32 reserved, count * {int32 parent}, in 
+//               pre-order with -1 for the top level
+//   dbdots:     uint64 count, count * {float x, float y, int32 n, int32 m, 
+//               int32 l, int32 aggregate}
+//   electrodes: uint64 count, count * {int32 layer_id, int32 electrode_type,
+//               int32 net, int32 aggregate, double x1, y1, x2, y2, potential,
+//               phase, angle, pixel_per_angstrom}
+// Strings are a uint32 byte count followed by UTF-8 bytes. All values are 
+// little-endian.
+class phys::BinaryProblemReader
+{
+public:
+  enum SectionType{ProgramSection=1, SimParamsSection=2, LayersSection=3,
+    AggregatesSection=4, DBDotsSection=5, ElectrodesSection=6};
+
+  BinaryProblemReader(const char *data, size_t size) : data(data), size(size) {}
+
+  // Return a reader over the section of the given type, empty if absent.
+  BinaryProblemReader section(SectionType type) const
+  {
+    if (size < 16 || std::memcmp(data, "SQPB", 4) != 0)
+      throw std::runtime_error("Not a binary problem");
+    uint32_t header[3];
+    std::memcpy(header, data + 4, sizeof(header));
+    if (header[0] != 1)
+      throw std::runtime_error("Unsupported binary problem version");
+    if (16 + uint64_t(header[1]) * 24 > size)
+      throw std::runtime_error("Binary problem is truncated");
+    for (uint32_t i=0; i<header[1]; i++) {
+      const char *entry = data + 16 + i * 24;
+      uint32_t sec_type;
+      uint64_t loc[2];
+      std::memcpy(&sec_type, entry, sizeof(sec_type));
+      std::memcpy(loc, entry + 8, sizeof(loc));
+      if (sec_type != type)
+        continue;
+      if (loc[0] > size || loc[1] > size - loc[0])
+        throw std::runtime_error("Binary problem section exceeds the problem size");
+      return BinaryProblemReader(data + loc[0], loc[1]);
+    }
+    return BinaryProblemReader(nullptr, 0);
+  }
+
+  bool empty() const {return size == 0;}
+
+  template<typename T>
+  T read()
+  {
+    T val;
+    std::memcpy(&val, take(sizeof(T)), sizeof(T));
+    return val;
+  }
+
+  std::string readString()
+  {
+    uint32_t len = read<uint32_t>();
+    return std::string(take(len), len);
+  }
+
+private:
+  const char *take(size_t bytes)
+  {
+    if (bytes > size - pos)
+      throw std::runtime_error("Binary problem section is truncated");
+    const char *p = data + pos;
+    pos += bytes;
+    return p;
+  }
+
+  const char *data;
+  size_t size;
+  size_t pos=0;
+};
+
+// Write data into a newly created POSIX shared memory segment of the given 
+// name, replacing any segment of that name.
+static bool writeSharedSegment(const std::string &name, const std::string &data)
+{
+#ifdef _WIN32
+  return false;
+#else
+  int fd = shm_open(name.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0600);
+  if (fd < 0)
+    return false;
+  if (ftruncate(fd, data.size()) != 0) {
+    close(fd);
+    shm_unlink(name.c_str());
+    return false;
+  }
+  void *mapped = mmap(nullptr, data.size(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    shm_unlink(name.c_str());
+    return false;
+  }
+  std::memcpy(mapped, data.data(), data.size());
+  munmap(mapped, data.size());
+  return true;
+#endif
+}
+
 //CONSTRUCTOR
 SiQADConnector::SiQADConnector(const std::string &eng_name,
   const std::string &input_path, const std::string &output_path)
@@ -31,8 +153,28 @@ SiQADConnector::SiQADConnector(const std::string &eng_name,
   elec_poly_col = new ElectrodePolyCollection(item_tree);
   db_col = new DBCollection(item_tree);
 
-  // read problem from input_path
-  readProblem(input_path);
+  // SiQAD may hand the problem over in shared memory and ask for binary 
+  // results in shared memory, the files remain as the fallback
+  const char *problem_shm = std::getenv("SIQAD_PROBLEM_SHM");
+  const char *result_shm_name = std::getenv("SIQAD_RESULT_SHM");
+  if (result_shm_name != nullptr)
+    result_shm = result_shm_name;
+
+  // read problem from the shared segment if there is one, input_path otherwise
+  if (problem_shm == nullptr || *problem_shm == '\0' || !readProblemShared(problem_shm))
+    readProblem(input_path);
+  db_arrays = new DBArrays(item_tree);
+}
+
+//DESTRUCTOR
+SiQADConnector::~SiQADConnector()
+{
+  if ((binary_results || !result_shm.empty()) && result_writer == nullptr)
+    writeResultsBinary();
+  else
+    writeResultsXml();
+  delete result_writer;
+  delete db_spatial_index;
 }
 
 void SiQADConnector::setExport(std::string type, std::vector< std::pair< std::string, std::string > > &data_in)
@@ -59,6 +201,86 @@ void SiQADConnector::setExport(std::string type, std::vector< std::vector< std::
         type + std::string("' with class std::vector<std::vector<std::string>>"));
 }
 
+void SiQADConnector::exportChargeConfig(const int8_t *charges, size_t db_count,
+    double energy, int count, int physically_valid)
+{
+  if (!charge_records.empty() && db_count != charge_db_count)
+    throw std::invalid_argument("All exported charge configs must have the same DB count");
+  for (size_t i=0; i<db_count; i++)
+    if (charges[i] < -1 || charges[i] > 1)
+      throw std::invalid_argument("Charges must be -1, 0 or 1");
+  charge_db_count = db_count;
+  charge_states.insert(charge_states.end(), charges, charges + db_count);
+  charge_records.push_back({energy, count, physically_valid});
+}
+
+void SiQADConnector::exportPotentials(const float *x, const float *y,
+    const float *val, size_t count)
+{
+  pot_xs.insert(pot_xs.end(), x, x + count);
+  pot_ys.insert(pot_ys.end(), y, y + count);
+  pot_vals.insert(pot_vals.end(), val, val + count);
+}
+
+void SiQADConnector::exportPotentials(const std::vector<float> &x,
+    const std::vector<float> &y, const std::vector<float> &val)
+{
+  if (x.size() != y.size() || x.size() != val.size())
+    throw std::invalid_argument("Potential arrays must have the same length");
+  exportPotentials(x.data(), y.data(), val.data(), x.size());
+}
+
+void SiQADConnector::exportDBLocations(const float *x, const float *y, size_t count)
+{
+  db_xs.insert(db_xs.end(), x, x + count);
+  db_ys.insert(db_ys.end(), y, y + count);
+}
+
+void SiQADConnector::exportDBLocations(const std::vector<float> &x,
+    const std::vector<float> &y)
+{
+  if (x.size() != y.size())
+    throw std::invalid_argument("DB location arrays must have the same length");
+  exportDBLocations(x.data(), y.data(), x.size());
+}
+
+void SiQADConnector::streamExport(std::string type, std::vector< std::pair< std::string, std::string > > &data_in)
+{
+  if (type != "db_loc")
+    throw std::invalid_argument(std::string("No candidate for stream type '") +
+        type + std::string("' with class std::vector<std::pair<std::string, std::string>>"));
+
+  // all locations go into a single record since they must arrive together
+  std::string record = "<physloc>";
+  for (auto &loc : data_in)
+    record += "<dbdot x=\"" + loc.first + "\" y=\"" + loc.second + "\"/>";
+  record += "</physloc>";
+  std::cout << stream_marker << record << std::endl;
+}
+
+void SiQADConnector::streamExport(std::string type, std::vector< std::vector< std::string > > &data_in)
+{
+  if (type != "db_charge")
+    throw std::invalid_argument(std::string("No candidate for stream type '") +
+        type + std::string("' with class std::vector<std::vector<std::string>>"));
+
+  // one record per distribution, flushed at the end of the batch
+  for (auto &row : data_in) {
+    if (row.size() < 3)
+      throw std::invalid_argument("db_charge stream rows require at least dist, energy and count");
+    std::string record = "<dist energy=\"" + row[1] + "\" count=\"" + row[2] + "\"";
+    if (row.size() > 3)
+      record += " physically_valid=\"" + row[3] + "\"";
+    if (row.size() > 4)
+      record += " state_count=\"" + row[4] + "\"";
+    else if (row[0].find_first_of("+-") != std::string::npos)
+      record += " state_count=\"3\"";
+    record += ">" + row[0] + "</dist>";
+    std::cout << stream_marker << record << '\n';
+  }
+  std::cout.flush();
+}
+
 void SiQADConnector::addSQCommand(SQCommand *command)
 {
   export_commands.push_back(command->finalCommand());
@@ -69,131 +291,646 @@ void SiQADConnector::addSQCommand(SQCommand *command)
 
 
 // FILE HANDLING
-// parse problem XML, return true if successful
+
+namespace phys {
+
+  // Pull parser reading the problem file through a buffered stream, so the
+  // file is never held in memory as a whole and no tree of it is built. The 
+  // interface follows QXmlStreamReader. Handles elements, attributes, text,
+  // CDATA, comments, processing instructions and the predefined and numeric
+  // entities, which covers everything SiQAD writes.
+  class ProblemXmlReader
+  {
+  public:
+    enum Token{StartElement, EndElement, Characters, EndDocument};
+
+    ProblemXmlReader(const std::string &path)
+      : buf(1 << 16)
+    {
+      file.rdbuf()->pubsetbuf(buf.data(), buf.size());
+      file.open(path, std::ios::binary);
+      if (!file)
+        throw std::runtime_error("Unable to open problem file " + path);
+      sb = file.rdbuf();
+    }
+
+    // Read the next token.
+    Token readNext();
+
+    // Read until the next child start element of the current element, 
+    // return false if the current element ends first.
+    bool readNextStartElement();
+
+    // Skip the rest of the current element including its children.
+    void skipCurrentElement();
+
+    // Read the text of the current element up to its end, child elements are
+    // skipped.
+    std::string readElementText();
+
+    // Name of the current start or end element.
+    const std::string &name() const {return tag_name;}
+
+    // Text of the current Characters token.
+    const std::string &text() const {return chars;}
+
+    // Attributes of the current start element.
+    const std::vector<std::pair<std::string, std::string>> &attributes() const {return attrs;}
+
+    // Return whether the current start element has the given attribute.
+    bool hasAttribute(const std::string &key) const;
+
+    // Return the value of the given attribute, throws if it doesn't exist.
+    std::string attribute(const std::string &key) const;
+
+    // Throw an error referring to the current line.
+    void error(const std::string &msg) const
+    {
+      throw std::runtime_error("Problem file line " + std::to_string(line) + ": " + msg);
+    }
+
+  private:
+
+    typedef std::char_traits<char> traits;
+
+    int get()
+    {
+      int c = sb->sbumpc();
+      if (c == '\n')
+        line++;
+      return c;
+    }
+    int peek() {return sb->sgetc();}
+    void skipSpace() {while (std::isspace(peek())) get();}
+
+    // Read an element or attribute name.
+    std::string readName();
+
+    // Consume characters up to and including the given terminator.
+    void skipPast(const std::string &terminator);
+
+    // Decode the entity following an '&' and append it to out.
+    void decodeEntity(std::string &out);
+
+    std::vector<char> buf;    // stream buffer
+    std::ifstream file;
+    std::streambuf *sb=nullptr;
+    int line=1;
+    bool pending_end=false;   // the last start element was self-closing
+    std::string tag_name;
+    std::string chars;
+    std::vector<std::pair<std::string, std::string>> attrs;
+  };
+
+}
+
+ProblemXmlReader::Token ProblemXmlReader::readNext()
+{
+  if (pending_end) {
+    pending_end = false;
+    return EndElement;
+  }
+
+  while (true) {
+    int c = peek();
+    if (c == traits::eof())
+      return EndDocument;
+
+    // character data, whitespace between elements is dropped
+    if (c != '<') {
+      chars.clear();
+      bool blank = true;
+      while ((c = peek()) != traits::eof() && c != '<') {
+        get();
+        if (c == '&') {
+          decodeEntity(chars);
+          blank = false;
+        } else {
+          chars += static_cast<char>(c);
+          blank = blank && std::isspace(c);
+        }
+      }
+      if (blank)
+        continue;
+      return Characters;
+    }
+
+    get();  // '<'
+    c = peek();
+    if (c == '?') {
+      skipPast("?>");
+      continue;
+    } else if (c == '!') {
+      get();
+      if (peek() == '-') {
+        skipPast("-->");
+        continue;
+      } else if (peek() == '[') {
+        skipPast("[CDATA[");
+        chars.clear();
+        while (chars.size() < 3 || chars.compare(chars.size() - 3, 3, "]]>") != 0) {
+          if ((c = get()) == traits::eof())
+            error("Unterminated CDATA section");
+          chars += static_cast<char>(c);
+        }
+        chars.resize(chars.size() - 3);
+        return Characters;
+      }
+      skipPast(">");  // DOCTYPE
+      continue;
+    } else if (c == '/') {
+      get();
+      tag_name = readName();
+      skipSpace();
+      if (get() != '>')
+        error("Expected '>' after end tag " + tag_name);
+      return EndElement;
+    }
+
+    // start element with its attributes
+    tag_name = readName();
+    attrs.clear();
+    while (true) {
+      skipSpace();
+      c = get();
+      if (c == '>') {
+        break;
+      } else if (c == '/') {
+        if (get() != '>')
+          error("Expected '>' after '/' in tag " + tag_name);
+        pending_end = true;
+        break;
+      } else if (c == traits::eof()) {
+        error("Unexpected end of file in tag " + tag_name);
+      }
+      sb->sungetc();
+      std::string key = readName();
+      skipSpace();
+      if (get() != '=')
+        error("Expected '=' after attribute " + key);
+      skipSpace();
+      int quote = get();
+      if (quote != '"' && quote != '\'')
+        error("Expected quoted value for attribute " + key);
+      std::string val;
+      while ((c = get()) != quote) {
+        if (c == traits::eof())
+          error("Unterminated value for attribute " + key);
+        if (c == '&')
+          decodeEntity(val);
+        else
+          val += static_cast<char>(c);
+      }
+      attrs.push_back(std::make_pair(key, val));
+    }
+    return StartElement;
+  }
+}
+
+bool ProblemXmlReader::readNextStartElement()
+{
+  while (true) {
+    switch (readNext()) {
+      case StartElement:
+        return true;
+      case EndElement:
+      case EndDocument:
+        return false;
+      default:
+        break;
+    }
+  }
+}
+
+void ProblemXmlReader::skipCurrentElement()
+{
+  int depth = 1;
+  while (depth > 0) {
+    switch (readNext()) {
+      case StartElement:
+        depth++;
+        break;
+      case EndElement:
+        depth--;
+        break;
+      case EndDocument:
+        error("Unexpected end of file");
+      default:
+        break;
+    }
+  }
+}
+
+std::string ProblemXmlReader::readElementText()
+{
+  std::string element_text;
+  while (true) {
+    switch (readNext()) {
+      case Characters:
+        element_text += chars;
+        break;
+      case StartElement:
+        skipCurrentElement();
+        break;
+      case EndElement:
+        return element_text;
+      case EndDocument:
+        error("Unexpected end of file");
+    }
+  }
+}
+
+bool ProblemXmlReader::hasAttribute(const std::string &key) const
+{
+  for (auto &attr : attrs)
+    if (attr.first == key)
+      return true;
+  return false;
+}
+
+std::string ProblemXmlReader::attribute(const std::string &key) const
+{
+  for (auto &attr : attrs)
+    if (attr.first == key)
+      return attr.second;
+  error("Element " + tag_name + " has no attribute " + key);
+  return std::string();
+}
+
+std::string ProblemXmlReader::readName()
+{
+  std::string name;
+  int c;
+  while ((c = peek()) != traits::eof() && !std::isspace(c)
+         && c != '>' && c != '/' && c != '=')
+    name += static_cast<char>(get());
+  if (name.empty())
+    error("Expected a name");
+  return name;
+}
+
+void ProblemXmlReader::skipPast(const std::string &terminator)
+{
+  std::string window;
+  while (window != terminator) {
+    int c = get();
+    if (c == traits::eof())
+      error("Expected '" + terminator + "' before end of file");
+    window += static_cast<char>(c);
+    if (window.size() > terminator.size())
+      window.erase(0, 1);
+  }
+}
+
+void ProblemXmlReader::decodeEntity(std::string &out)
+{
+  std::string ent;
+  int c;
+  while ((c = get()) != ';') {
+    if (c == traits::eof() || ent.size() > 8)
+      error("Malformed entity");
+    ent += static_cast<char>(c);
+  }
+  if (ent == "amp")       out += '&';
+  else if (ent == "lt")   out += '<';
+  else if (ent == "gt")   out += '>';
+  else if (ent == "quot") out += '"';
+  else if (ent == "apos") out += '\'';
+  else if (ent.size() > 1 && ent[0] == '#') {
+    // numeric character reference, encoded as UTF-8
+    unsigned long cp = (ent[1] == 'x') ? std::stoul(ent.substr(2), nullptr, 16)
+                                       : std::stoul(ent.substr(1));
+    if (cp < 0x80) {
+      out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+      out += static_cast<char>(0xC0 | (cp >> 6));
+      out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+      out += static_cast<char>(0xE0 | (cp >> 12));
+      out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+      out += static_cast<char>(0xF0 | (cp >> 18));
+      out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+      out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+  } else {
+    error("Unknown entity &" + ent + ";");
+  }
+}
+
+namespace {
+
+  // Read the attributes and descendants of the current element into values,
+  // keyed by the property tree style path relative to the element, e.g. 
+  // "dim.<xmlattr>.x1" or "property_map.potential.val". Repeated paths keep 
+  // their last value. Only meant for small elements like electrodes.
+  void readFlatElement(ProblemXmlReader &rs, const std::string &path,
+                       std::map<std::string, std::string> &values)
+  {
+    auto join = [&path](const std::string &name) -> std::string
+    {
+      return path.empty() ? name : path + "." + name;
+    };
+    for (auto &attr : rs.attributes())
+      values[join("<xmlattr>." + attr.first)] = attr.second;
+
+    std::string text;
+    while (true) {
+      ProblemXmlReader::Token token = rs.readNext();
+      if (token == ProblemXmlReader::Characters) {
+        text += rs.text();
+      } else if (token == ProblemXmlReader::StartElement) {
+        readFlatElement(rs, join(rs.name()), values);
+      } else if (token == ProblemXmlReader::EndElement) {
+        break;
+      } else {
+        rs.error("Unexpected end of file");
+      }
+    }
+    if (!path.empty())
+      values[path] = text;
+  }
+
+  // Return the value at the given path, throws if it doesn't exist.
+  std::string flatValue(const ProblemXmlReader &rs,
+                        const std::map<std::string, std::string> &values,
+                        const std::string &path)
+  {
+    auto it = values.find(path);
+    if (it == values.end())
+      rs.error("Missing " + path);
+    return it->second;
+  }
+
+}
+
+// parse problem XML, throws if unsuccessful
 void SiQADConnector::readProblem(const std::string &path)
 {
   std::cout << "Reading problem file: " << input_path << std::endl;
 
-  bpt::ptree tree; // create empty property tree object
-  bpt::read_xml(path, tree, bpt::xml_parser::no_comments); // parse the input file into property tree
+  ProblemXmlReader rs(path);
+  if (!rs.readNextStartElement() || rs.name() != "siqad")
+    rs.error("Expected siqad root element");
+
+  // parse XML, collections are filled as the file is scanned
+  bool has_sim_params=false, has_layers=false, has_design=false;
+  while (rs.readNextStartElement()) {
+    if (rs.name() == "program") {
+      // read program properties
+      readProgramProp(rs);
+    } else if (rs.name() == "sim_params") {
+      // read simulation parameters
+      std::cout << "Read simulation parameters" << std::endl;
+      readSimulationParam(rs);
+      has_sim_params = true;
+    } else if (rs.name() == "layers") {
+      // read layer properties
+      std::cout << "Read layer properties" << std::endl;
+      readLayers(rs);
+      has_layers = true;
+    } else if (rs.name() == "design") {
+      // read items
+      std::cout << "Read items tree" << std::endl;
+      readDesign(rs, item_tree);
+      has_design = true;
+    } else {
+      rs.skipCurrentElement();
+    }
+  }
+
+  if (!has_sim_params || !has_layers || !has_design)
+    throw std::runtime_error("Problem file must contain sim_params, layers and design");
+}
 
-  // parse XML
+bool SiQADConnector::readProblemShared(const std::string &name)
+{
+#ifdef _WIN32
+  std::cout << "Shared memory problems are not supported on this platform." << std::endl;
+  return false;
+#else
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    std::cout << "Unable to open shared memory segment " << name << std::endl;
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < 16) {
+    close(fd);
+    return false;
+  }
+  size_t size = st.st_size;
+  void *mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED)
+    return false;
+
+  std::cout << "Reading problem from shared memory segment: " << name << std::endl;
+  try {
+    readBinaryProblem(static_cast<const char*>(mapped), size);
+  } catch (...) {
+    munmap(mapped, size);
+    throw;
+  }
+  munmap(mapped, size);
+  return true;
+#endif
+}
 
-  // read program properties
-  // TODO read program node
+void SiQADConnector::readBinaryProblem(const char *data, size_t size)
+{
+  BinaryProblemReader rb(data, size);
+
+  // string key value pairs of the program and sim_params sections
+  auto readProperties = [](BinaryProblemReader &sec, std::map<std::string, std::string> &props)
+  {
+    uint32_t count = sec.read<uint32_t>();
+    for (uint32_t i=0; i<count; i++) {
+      std::string key = sec.readString();
+      props[key] = sec.readString();
+    }
+  };
+
+  BinaryProblemReader sec = rb.section(BinaryProblemReader::ProgramSection);
+  if (!sec.empty())
+    readProperties(sec, program_props);
+
+  sec = rb.section(BinaryProblemReader::SimParamsSection);
+  if (sec.empty())
+    throw std::runtime_error("Binary problem must contain sim_params");
+  readProperties(sec, sim_params);
+
+  sec = rb.section(BinaryProblemReader::LayersSection);
+  uint32_t layer_count = sec.empty() ? 0 : sec.read<uint32_t>();
+  for (uint32_t i=0; i<layer_count; i++) {
+    Layer lay;
+    lay.name = sec.readString();
+    lay.type = sec.readString();
+    sec.readString();   // role, not used by the connector
+    lay.zoffset = sec.read<float>();
+    lay.zheight = sec.read<float>();
+    layers.push_back(lay);
+  }
 
-  // read simulation parameters
-  std::cout << "Read simulation parameters" << std::endl;
-  readSimulationParam(tree.get_child("siqad.sim_params"));
+  // aggregates come in pre-order so parents always precede their children
+  std::vector<std::shared_ptr<Aggregate>> aggs;
+  sec = rb.section(BinaryProblemReader::AggregatesSection);
+  uint32_t agg_count = sec.empty() ? 0 : sec.read<uint32_t>();
+  if (agg_count > 0)
+    sec.read<uint32_t>();   // reserved
+  for (uint32_t i=0; i<agg_count; i++) {
+    int32_t parent = sec.read<int32_t>();
+    if (parent >= static_cast<int32_t>(i))
+      throw std::runtime_error("Binary problem aggregate precedes its parent");
+    std::shared_ptr<Aggregate> parent_agg = (parent < 0) ? item_tree : aggs[parent];
+    parent_agg->aggs.push_back(std::make_shared<Aggregate>());
+    aggs.push_back(parent_agg->aggs.back());
+  }
+  auto aggregate = [&aggs, this](int32_t ind) -> std::shared_ptr<Aggregate>
+  {
+    if (ind >= static_cast<int32_t>(aggs.size()))
+      throw std::runtime_error("Binary problem item refers to an unknown aggregate");
+    return (ind < 0) ? item_tree : aggs[ind];
+  };
+
+  sec = rb.section(BinaryProblemReader::DBDotsSection);
+  uint64_t db_count = sec.empty() ? 0 : sec.read<uint64_t>();
+  for (uint64_t i=0; i<db_count; i++) {
+    float x = sec.read<float>(), y = sec.read<float>();
+    int32_t n = sec.read<int32_t>(), m = sec.read<int32_t>(), l = sec.read<int32_t>();
+    aggregate(sec.read<int32_t>())->dbs.push_back(std::make_shared<DBDot>(x, y, n, m, l));
+  }
 
-  // read layer properties
-  std::cout << "Read layer properties" << std::endl;
-  readLayers(tree.get_child("siqad.layers"));
+  sec = rb.section(BinaryProblemReader::ElectrodesSection);
+  uint64_t elec_count = sec.empty() ? 0 : sec.read<uint64_t>();
+  for (uint64_t i=0; i<elec_count; i++) {
+    int32_t layer_id = sec.read<int32_t>(), electrode_type = sec.read<int32_t>();
+    int32_t net = sec.read<int32_t>(), agg = sec.read<int32_t>();
+    double x1 = sec.read<double>(), y1 = sec.read<double>();
+    double x2 = sec.read<double>(), y2 = sec.read<double>();
+    double potential = sec.read<double>(), phase = sec.read<double>();
+    double angle = sec.read<double>(), pixel_per_angstrom = sec.read<double>();
+    aggregate(agg)->elecs.push_back(std::make_shared<Electrode>(layer_id, x1, x2,
+          y1, y2, potential, phase, electrode_type, pixel_per_angstrom, net, angle));
+  }
 
-  // read items
-  std::cout << "Read items tree" << std::endl;
-  readDesign(tree.get_child("siqad.design"), item_tree);
+  std::cout << "Read " << db_count << " DBs and " << elec_count 
+    << " electrodes from the binary problem" << std::endl;
 }
 
-void SiQADConnector::readProgramProp(const bpt::ptree &program_prop_tree)
+void SiQADConnector::readProgramProp(ProblemXmlReader &rs)
 {
-  for (bpt::ptree::value_type const &v : program_prop_tree) {
-    program_props.insert(std::map<std::string, std::string>::value_type(v.first, v.second.data()));
-    std::cout << "ProgramProp: Key=" << v.first << ", Value=" << program_props[v.first] << std::endl;
+  while (rs.readNextStartElement()) {
+    std::string key = rs.name();
+    program_props[key] = rs.readElementText();
+    std::cout << "ProgramProp: Key=" << key << ", Value=" << program_props[key] << std::endl;
   }
 }
 
-void SiQADConnector::readLayers(const bpt::ptree &layer_prop_tree)
+void SiQADConnector::readLayers(ProblemXmlReader &rs)
 {
-  // if this were structured the same way as readDesign, then only the first layer_prop subtree would be read.
-  // TODO: make this more general.
-  for (bpt::ptree::value_type const &v : layer_prop_tree)
-    readLayerProp(v.second);
+  while (rs.readNextStartElement()) {
+    if (rs.name() == "layer_prop")
+      readLayerProp(rs);
+    else
+      rs.skipCurrentElement();
+  }
 }
 
-void SiQADConnector::readLayerProp(const bpt::ptree &layer_node)
+void SiQADConnector::readLayerProp(ProblemXmlReader &rs)
 {
+  std::map<std::string, std::string> values;
+  readFlatElement(rs, "", values);
+
   Layer lay;
-  lay.name = layer_node.get<std::string>("name");
-  lay.type = layer_node.get<std::string>("type");
-  lay.zoffset = layer_node.get<float>("zoffset");
-  lay.zheight = layer_node.get<float>("zheight");
+  lay.name = flatValue(rs, values, "name");
+  lay.type = flatValue(rs, values, "type");
+  lay.zoffset = std::stof(flatValue(rs, values, "zoffset"));
+  lay.zheight = std::stof(flatValue(rs, values, "zheight"));
 
   layers.push_back(lay);
   std::cout << "Retrieved layer " << lay.name << " of type " << lay.type << std::endl;
 }
 
 
-void SiQADConnector::readSimulationParam(const bpt::ptree &sim_params_tree)
+void SiQADConnector::readSimulationParam(ProblemXmlReader &rs)
 {
-  for (bpt::ptree::value_type const &v : sim_params_tree) {
-    sim_params.insert(std::map<std::string, std::string>::value_type(v.first, v.second.data()));
-    std::cout << "SimParam: Key=" << v.first << ", Value=" << sim_params[v.first] << std::endl;
+  while (rs.readNextStartElement()) {
+    std::string key = rs.name();
+    sim_params[key] = rs.readElementText();
+    std::cout << "SimParam: Key=" << key << ", Value=" << sim_params[key] << std::endl;
   }
 }
 
-void SiQADConnector::readDesign(const bpt::ptree &subtree, const std::shared_ptr<Aggregate> &agg_parent)
+void SiQADConnector::readDesign(ProblemXmlReader &rs, const std::shared_ptr<Aggregate> &agg_parent)
 {
   std::cout << "Beginning to read design" << std::endl;
-  for (bpt::ptree::value_type const &layer_tree : subtree) {
-    std::string layer_type = layer_tree.second.get<std::string>("<xmlattr>.type");
+  while (rs.readNextStartElement()) {
+    std::string layer_name = rs.name();
+    std::string layer_type = rs.attribute("type");
     if ((!layer_type.compare("DB"))) {
-      std::cout << "Encountered node " << layer_tree.first << " with type " << layer_type << ", entering" << std::endl;
-      readItemTree(layer_tree.second, agg_parent);
+      std::cout << "Encountered node " << layer_name << " with type " << layer_type << ", entering" << std::endl;
+      readItemTree(rs, agg_parent);
     } else if ( (!layer_type.compare("Electrode"))) {
-      std::cout << "Encountered node " << layer_tree.first << " with type " << layer_type << ", entering" << std::endl;
-      readItemTree(layer_tree.second, agg_parent);
+      std::cout << "Encountered node " << layer_name << " with type " << layer_type << ", entering" << std::endl;
+      readItemTree(rs, agg_parent);
     } else {
-      std::cout << "Encountered node " << layer_tree.first << " with type " << layer_type << ", no defined action for this layer. Skipping." << std::endl;
+      std::cout << "Encountered node " << layer_name << " with type " << layer_type << ", no defined action for this layer. Skipping." << std::endl;
+      rs.skipCurrentElement();
     }
   }
 }
 
-void SiQADConnector::readItemTree(const bpt::ptree &subtree, const std::shared_ptr<Aggregate> &agg_parent)
+void SiQADConnector::readItemTree(ProblemXmlReader &rs, const std::shared_ptr<Aggregate> &agg_parent)
 {
-  for (bpt::ptree::value_type const &item_tree : subtree) {
-    std::string item_name = item_tree.first;
-    std::cout << "item_name: " << item_name << std::endl;
+  while (rs.readNextStartElement()) {
+    std::string item_name = rs.name();
+    std::cout << "item_name: " << item_name << '\n';
     if (!item_name.compare("aggregate")) {
       // add aggregate child to tree
       agg_parent->aggs.push_back(std::make_shared<Aggregate>());
-      readItemTree(item_tree.second, agg_parent->aggs.back());
+      readItemTree(rs, agg_parent->aggs.back());
     } else if (!item_name.compare("dbdot")) {
       // add DBDot to tree
-      readDBDot(item_tree.second, agg_parent);
+      readDBDot(rs, agg_parent);
     } else if (!item_name.compare("electrode")) {
       // add Electrode to tree
-      readElectrode(item_tree.second, agg_parent);
+      readElectrode(rs, agg_parent);
     } else if (!item_name.compare("electrode_poly")) {
       // add Electrode to tree
-      readElectrodePoly(item_tree.second, agg_parent);
+      readElectrodePoly(rs, agg_parent);
     } else {
-      std::cout << "Encountered unknown item node: " << item_tree.first << std::endl;
+      std::cout << "Encountered unknown item node: " << item_name << std::endl;
+      rs.skipCurrentElement();
     }
   }
 }
 
-void SiQADConnector::readElectrode(const bpt::ptree &subtree, const std::shared_ptr<Aggregate> &agg_parent)
+void SiQADConnector::readElectrode(ProblemXmlReader &rs, const std::shared_ptr<Aggregate> &agg_parent)
 {
   double x1, x2, y1, y2, pixel_per_angstrom, potential, phase, angle;
   int layer_id, electrode_type=0, net;
+  std::map<std::string, std::string> values;
+  readFlatElement(rs, "", values);
   // read values from XML stream
-  layer_id = subtree.get<int>("layer_id");
-  angle = subtree.get<double>("angle");
-  potential = subtree.get<double>("property_map.potential.val");
-  phase = subtree.get<double>("property_map.phase.val");
-  std::string electrode_type_s = subtree.get<std::string>("property_map.type.val");
+  layer_id = std::stoi(flatValue(rs, values, "layer_id"));
+  angle = std::stod(flatValue(rs, values, "angle"));
+  potential = std::stod(flatValue(rs, values, "property_map.potential.val"));
+  phase = std::stod(flatValue(rs, values, "property_map.phase.val"));
+  std::string electrode_type_s = flatValue(rs, values, "property_map.type.val");
   if (!electrode_type_s.compare("fixed")){
     electrode_type = 0;
   } else if (!electrode_type_s.compare("clocked")) {
     electrode_type = 1;
   }
-  net = subtree.get<int>("property_map.net.val");
-  pixel_per_angstrom = subtree.get<double>("pixel_per_angstrom");
-  x1 = subtree.get<double>("dim.<xmlattr>.x1");
-  x2 = subtree.get<double>("dim.<xmlattr>.x2");
-  y1 = subtree.get<double>("dim.<xmlattr>.y1");
-  y2 = subtree.get<double>("dim.<xmlattr>.y2");
+  net = std::stoi(flatValue(rs, values, "property_map.net.val"));
+  pixel_per_angstrom = std::stod(flatValue(rs, values, "pixel_per_angstrom"));
+  x1 = std::stod(flatValue(rs, values, "dim.<xmlattr>.x1"));
+  x2 = std::stod(flatValue(rs, values, "dim.<xmlattr>.x2"));
+  y1 = std::stod(flatValue(rs, values, "dim.<xmlattr>.y1"));
+  y2 = std::stod(flatValue(rs, values, "dim.<xmlattr>.y2"));
   agg_parent->elecs.push_back(std::make_shared<Electrode>(layer_id,x1,x2,y1,y2,potential,phase,electrode_type,pixel_per_angstrom,net,angle));
 
   std::cout << "Electrode created with x1=" << agg_parent->elecs.back()->x1 << ", y1=" << agg_parent->elecs.back()->y1 <<
@@ -201,227 +938,616 @@ void SiQADConnector::readElectrode(const bpt::ptree &subtree, const std::shared_
     ", potential=" << agg_parent->elecs.back()->potential << std::endl;
 }
 
-void SiQADConnector::readElectrodePoly(const bpt::ptree &subtree, const std::shared_ptr<Aggregate> &agg_parent)
+void SiQADConnector::readElectrodePoly(ProblemXmlReader &rs, const std::shared_ptr<Aggregate> &agg_parent)
 {
   double pixel_per_angstrom, potential, phase;
   std::vector<std::pair<double, double>> vertices;
   int layer_id, electrode_type=0, net;
-  // read values from XML stream
-  layer_id = subtree.get<int>("layer_id");
-  potential = subtree.get<double>("property_map.potential.val");
-  phase = subtree.get<double>("property_map.phase.val");
-  std::string electrode_type_s = subtree.get<std::string>("property_map.type.val");
+  std::map<std::string, std::string> values;
+  // read values from XML stream, cycling through the vertices
+  while (rs.readNextStartElement()) {
+    if (rs.name() == "vertex") {
+      double x = std::stod(rs.attribute("x"));
+      double y = std::stod(rs.attribute("y"));
+      vertices.push_back(std::make_pair(x, y));
+      rs.skipCurrentElement();
+    } else {
+      std::string name = rs.name();
+      readFlatElement(rs, name, values);
+    }
+  }
+  layer_id = std::stoi(flatValue(rs, values, "layer_id"));
+  potential = std::stod(flatValue(rs, values, "property_map.potential.val"));
+  phase = std::stod(flatValue(rs, values, "property_map.phase.val"));
+  std::string electrode_type_s = flatValue(rs, values, "property_map.type.val");
   if (!electrode_type_s.compare("fixed")){
     electrode_type = 0;
   } else if (!electrode_type_s.compare("clocked")) {
     electrode_type = 1;
   }
-  pixel_per_angstrom = subtree.get<double>("pixel_per_angstrom");
-  net = subtree.get<int>("property_map.net.val");
-  //cycle through the vertices
-  std::pair<double, double> point;
-  for (auto val: subtree) {
-    if(val.first == "vertex") {
-      double x = std::stod(val.second.get_child("<xmlattr>.x").data());
-      double y = std::stod(val.second.get_child("<xmlattr>.y").data());
-      point = std::make_pair(x, y);
-      vertices.push_back(point);
-    }
-  }
+  pixel_per_angstrom = std::stod(flatValue(rs, values, "pixel_per_angstrom"));
+  net = std::stoi(flatValue(rs, values, "property_map.net.val"));
   agg_parent->elec_polys.push_back(std::make_shared<ElectrodePoly>(layer_id,vertices,potential,phase,electrode_type,pixel_per_angstrom,net));
 
   std::cout << "ElectrodePoly created with " << agg_parent->elec_polys.back()->vertices.size() <<
     " vertices, potential=" << agg_parent->elec_polys.back()->potential << std::endl;
 }
 
-void SiQADConnector::readDBDot(const bpt::ptree &subtree, const std::shared_ptr<Aggregate> &agg_parent)
+void SiQADConnector::readDBDot(ProblemXmlReader &rs, const std::shared_ptr<Aggregate> &agg_parent)
 {
-  float x, y;
-  int n, m, l;
-
-  // read x and y physical locations
-  x = subtree.get<float>("physloc.<xmlattr>.x");
-  y = subtree.get<float>("physloc.<xmlattr>.y");
-
-  // read n, m and l lattice coordinates
-  n = subtree.get<int>("latcoord.<xmlattr>.n");
-  m = subtree.get<int>("latcoord.<xmlattr>.m");
-  l = subtree.get<int>("latcoord.<xmlattr>.l");
+  float x=0, y=0;
+  int n=0, m=0, l=0;
+  bool has_physloc=false, has_latcoord=false;
+
+  while (rs.readNextStartElement()) {
+    if (rs.name() == "physloc") {
+      // read x and y physical locations
+      x = std::stof(rs.attribute("x"));
+      y = std::stof(rs.attribute("y"));
+      has_physloc = true;
+    } else if (rs.name() == "latcoord") {
+      // read n, m and l lattice coordinates
+      n = std::stoi(rs.attribute("n"));
+      m = std::stoi(rs.attribute("m"));
+      l = std::stoi(rs.attribute("l"));
+      has_latcoord = true;
+    }
+    rs.skipCurrentElement();
+  }
+  if (!has_physloc || !has_latcoord)
+    rs.error("dbdot requires physloc and latcoord");
 
   agg_parent->dbs.push_back(std::make_shared<DBDot>(x, y, n, m, l));
 
+  // not flushed per DB, large designs have many of them
   std::cout << "DBDot created with x=" << agg_parent->dbs.back()->x
             << ", y=" << agg_parent->dbs.back()->y
             << ", n=" << agg_parent->dbs.back()->n
             << ", m=" << agg_parent->dbs.back()->m
             << ", l=" << agg_parent->dbs.back()->l
-            << std::endl;
+            << '\n';
 }
 
 void SiQADConnector::writeResultsXml()
 {
   std::cout << "SiQADConnector::writeResultsXml()" << std::endl;
 
-  boost::property_tree::ptree node_root;
-
   std::cout << "Write results to XML..." << std::endl;
 
-  // eng_info
-  node_root.add_child("eng_info", engInfoPropertyTree());
-
-  // sim_params
-  node_root.add_child("sim_params", simParamsPropertyTree());
+  // sections already written through the result writer by the engine take
+  // precedence over data set through setExport
+  ResultWriter *writer = resultWriter();
+  auto beginSection = [writer](const std::string &name) -> bool
+  {
+    if (writer->sectionWritten(name)) {
+      std::cout << "Section " << name << " was already written, skipping exported data." << std::endl;
+      return false;
+    }
+    writer->beginSection(name);
+    return true;
+  };
 
   // DB locations
-  if (!dbl_data.empty())
-    node_root.add_child("physloc", dbLocPropertyTree());
+  if ((!dbl_data.empty() || !db_xs.empty()) && beginSection("physloc")) {
+    for (auto &loc : dbl_data)
+      writer->writeEmptyElement("dbdot", {{"x", loc.first}, {"y", loc.second}});
+    writer->writeDBLocations(db_xs.data(), db_ys.data(), db_xs.size());
+  }
 
   // DB electron distributions
-  if(!db_charge_data.empty())
-    node_root.add_child("elec_dist", dbChargePropertyTree());
+  if ((!db_charge_data.empty() || !charge_records.empty()) && beginSection("elec_dist")) {
+    for (auto &row : db_charge_data) {
+      std::vector<std::pair<std::string, std::string>> attrs = {{"energy", row[1]}, {"count", row[2]}};
+      if (row.size() > 3)
+        attrs.push_back(std::make_pair("physically_valid", row[3]));
+      if (row.size() > 4)
+        attrs.push_back(std::make_pair("state_count", row[4]));
+      else if (row[0].find_first_of("+-") != std::string::npos)
+        attrs.push_back(std::make_pair("state_count", "3"));
+      writer->writeTextElement("dist", row[0], attrs);
+    }
+    for (size_t i=0; i<charge_records.size(); i++) {
+      const ChargeConfigRecord &rec = charge_records[i];
+      writer->writeChargeConfig(&charge_states[i * charge_db_count], charge_db_count,
+          rec.energy, rec.count, rec.physically_valid);
+    }
+  }
 
   // electrode
-  if (!elec_data.empty())
-    node_root.add_child("electrode", electrodePropertyTree());
+  if (!elec_data.empty() && beginSection("electrode")) {
+    for (auto &elec : elec_data) {
+      writer->writeEmptyElement("dim", {{"x1", elec[0]}, {"y1", elec[1]},
+                                        {"x2", elec[2]}, {"y2", elec[3]}});
+      writer->writeTextElement("potential", elec[4]);
+    }
+  }
 
   //electric potentials
-  if (!pot_data.empty())
-    node_root.add_child("potential_map", potentialPropertyTree());
+  if ((!pot_data.empty() || !pot_xs.empty()) && beginSection("potential_map")) {
+    for (auto &pot : pot_data)
+      writer->writeEmptyElement("potential_val", {{"x", pot[0]}, {"y", pot[1]}, {"val", pot[2]}});
+    writer->writePotentials(pot_xs.data(), pot_ys.data(), pot_vals.data(), pot_xs.size());
+  }
 
   //potentials at db locations
-  if (!db_pot_data.empty())
-    node_root.add_child("dbdots", dbPotentialPropertyTree());
+  // TODO fix up this section, a lot of redundant information
+  if (!db_pot_data.empty() && beginSection("dbdots")) {
+    for (auto &db_pot : db_pot_data) {
+      writer->writeStartElement("dbdot");
+      writer->writeTextElement("step", db_pot[0]);
+      writer->writeEmptyElement("physloc", {{"x", db_pot[1]}, {"y", db_pot[2]}});
+      writer->writeTextElement("potential", db_pot[3]);
+      writer->writeEndElement();
+    }
+  }
 
   // SQCommands
-  if (!export_commands.empty()) {
+  if (!export_commands.empty() && beginSection("sqcommands")) {
     std::cout << "export commands not empty, starting to fill them in." << std::endl;
-    node_root.add_child("sqcommands", sqCommandsPropertyTree());
+    for (unsigned int i = 0; i < export_commands.size(); i++) {
+      std::cout << "command " << i << ": ";
+      std::cout << export_commands.at(i) << std::endl;
+      writer->writeTextElement("sqc", export_commands.at(i));
+    }
   }
 
-  // write full tree to file
-  boost::property_tree::ptree tree;
-  tree.add_child("sim_out", node_root);
-  boost::property_tree::write_xml(output_path, tree, std::locale(), boost::property_tree::xml_writer_make_settings<std::string>(' ',4));
+  // eng_info
+  if (beginSection("eng_info")) {
+    //get timing information
+    end_time = std::chrono::system_clock::now();
+    std::chrono::duration<double> elapsed_seconds = end_time-start_time;
+    std::time_t end = std::chrono::system_clock::to_time_t(end_time);
+    char* end_c_str = std::ctime(&end);
+    *std::remove(end_c_str, end_c_str+strlen(end_c_str), '\n') = '\0'; // removes _all_ new lines from the cstr
+
+    writer->writeTextElement("engine", eng_name);
+    writer->writeTextElement("version", "TBD"); // TODO real version
+    writer->writeTextElement("return_code", std::to_string(return_code));
+    writer->writeTextElement("timestamp", end_c_str);
+    writer->writeTextElement("time_elapsed_s", std::to_string(elapsed_seconds.count()));
+  }
+
+  // sim_params
+  if (beginSection("sim_params")) {
+    for (auto &param : sim_params)
+      writer->writeTextElement(param.first, param.second);
+  }
+
+  writer->close();
 
   std::cout << "Write to XML complete." << std::endl;
 }
 
-bpt::ptree SiQADConnector::engInfoPropertyTree()
+DBSpatialIndex *SiQADConnector::dbSpatialIndex(float cell_size)
+{
+  if (db_spatial_index != nullptr && cell_size > 0
+      && db_index_cell_size != cell_size) {
+    delete db_spatial_index;
+    db_spatial_index = nullptr;
+  }
+  if (db_spatial_index == nullptr) {
+    db_spatial_index = new DBSpatialIndex(*db_arrays, cell_size);
+    db_index_cell_size = cell_size;
+  }
+  return db_spatial_index;
+}
+
+ResultWriter *SiQADConnector::resultWriter()
+{
+  if (result_writer == nullptr)
+    result_writer = new ResultWriter(output_path);
+  return result_writer;
+}
+
+void SiQADConnector::writeResultsBinary()
+{
+  std::cout << "SiQADConnector::writeResultsBinary()" << std::endl;
+
+  if (!elec_data.empty() || !db_pot_data.empty() || !export_commands.empty()) {
+    std::cout << "Results contain exports without a binary representation, "
+      "writing XML instead." << std::endl;
+    writeResultsXml();
+    return;
+  }
+
+  // sections are assembled in memory, each padded to 8 bytes
+  std::vector<std::pair<uint32_t, std::string>> sections;
+  auto append = [](std::string &buf, const void *data, size_t size)
+  {
+    buf.append(static_cast<const char*>(data), size);
+  };
+  auto pad = [](std::string &buf) {buf.append((8 - buf.size() % 8) % 8, '\0');};
+
+  // physloc: quint64 count, count * {float x, float y}
+  if (!dbl_data.empty() || !db_xs.empty()) {
+    std::string sec;
+    uint64_t count = dbl_data.size() + db_xs.size();
+    append(sec, &count, sizeof(count));
+    for (auto &loc : dbl_data) {
+      float xy[2] = {std::stof(loc.first), std::stof(loc.second)};
+      append(sec, xy, sizeof(xy));
+    }
+    for (size_t i=0; i<db_xs.size(); i++) {
+      float xy[2] = {db_xs[i], db_ys[i]};
+      append(sec, xy, sizeof(xy));
+    }
+    pad(sec);
+    sections.push_back(std::make_pair(1u, sec));
+  }
+
+  // elec_dist: header, per-config records, then packed configs
+  // string configs come first, then the typed ones
+  if (!db_charge_data.empty() || !charge_records.empty()) {
+    uint32_t db_count = !db_charge_data.empty() ? db_charge_data[0][0].size() : charge_db_count;
+    if (!charge_records.empty() && charge_db_count != db_count)
+      throw std::invalid_argument("All electron distributions must have the same DB count");
+    uint32_t state_count = charge_records.empty() ? 2 : 3;
+    for (auto &row : db_charge_data) {
+      if ((row.size() > 4 && row[4] == "3")
+          || row[0].find_first_of("+-") != std::string::npos)
+        state_count = 3;
+    }
+    uint32_t bits = (state_count == 3) ? 2 : 1;
+    uint32_t words_per_config = (db_count * bits + 63) / 64;
+    uint32_t header[4] = {static_cast<uint32_t>(db_charge_data.size() + charge_records.size()),
+                          db_count, state_count, words_per_config};
+    std::string sec;
+    append(sec, header, sizeof(header));
+    for (auto &row : db_charge_data) {
+      float energy = std::stof(row[1]);
+      int32_t counts[2] = {std::stoi(row[2]), row.size() > 3 ? std::stoi(row[3]) : -1};
+      append(sec, &energy, sizeof(energy));
+      append(sec, counts, sizeof(counts));
+    }
+    for (auto &rec : charge_records) {
+      float energy = rec.energy;
+      int32_t counts[2] = {rec.count, rec.physically_valid};
+      append(sec, &energy, sizeof(energy));
+      append(sec, counts, sizeof(counts));
+    }
+    pad(sec);
+    std::vector<uint64_t> words(words_per_config);
+    for (auto &row : db_charge_data) {
+      if (row[0].size() != db_count)
+        throw std::invalid_argument("All electron distributions must have the same DB count");
+      std::fill(words.begin(), words.end(), 0);
+      for (uint32_t i=0; i<db_count; i++) {
+        // negative charge + 1 for the 3-state format, negative charge otherwise
+        char c = row[0][i];
+        uint64_t code;
+        if (state_count == 3)
+          code = (c == '+') ? 0 : ((c == '-' || c == '1') ? 2 : 1);
+        else
+          code = (c == '1') ? 1 : 0;
+        words[i * bits / 64] |= code << (i * bits % 64);
+      }
+      append(sec, words.data(), words.size() * sizeof(uint64_t));
+    }
+    for (size_t c=0; c<charge_records.size(); c++) {
+      const int8_t *charges = &charge_states[c * charge_db_count];
+      std::fill(words.begin(), words.end(), 0);
+      for (uint32_t i=0; i<db_count; i++)
+        words[i * bits / 64] |= uint64_t(charges[i] + 1) << (i * bits % 64);
+      append(sec, words.data(), words.size() * sizeof(uint64_t));
+    }
+    sections.push_back(std::make_pair(2u, sec));
+  }
+
+  // potential_map: quint64 count, count * {float x, float y, float val}
+  if (!pot_data.empty() || !pot_xs.empty()) {
+    std::string sec;
+    uint64_t count = pot_data.size() + pot_xs.size();
+    append(sec, &count, sizeof(count));
+    for (auto &pot : pot_data) {
+      float vals[3] = {std::stof(pot[0]), std::stof(pot[1]), std::stof(pot[2])};
+      append(sec, vals, sizeof(vals));
+    }
+    for (size_t i=0; i<pot_xs.size(); i++) {
+      float vals[3] = {pot_xs[i], pot_ys[i], pot_vals[i]};
+      append(sec, vals, sizeof(vals));
+    }
+    pad(sec);
+    sections.push_back(std::make_pair(3u, sec));
+  }
+
+  // header and section table followed by the sections
+  std::string out("SQRB", 4);
+  uint32_t header[3] = {1, static_cast<uint32_t>(sections.size()), 0};
+  append(out, header, sizeof(header));
+  uint64_t offset = 16 + sections.size() * 24;
+  for (auto &sec : sections) {
+    uint32_t type[2] = {sec.first, 0};
+    uint64_t loc[2] = {offset, sec.second.size()};
+    append(out, type, sizeof(type));
+    append(out, loc, sizeof(loc));
+    offset += sec.second.size();
+  }
+  for (auto &sec : sections)
+    out += sec.second;
+
+  if (!result_shm.empty()) {
+    if (writeSharedSegment(result_shm, out)) {
+      std::cout << "Write to shared memory segment " << result_shm << " complete." << std::endl;
+      return;
+    }
+    std::cout << "Failed to write results to shared memory segment " << result_shm
+      << ", writing to " << output_path << " instead." << std::endl;
+  }
+
+  std::ofstream of(output_path, std::ios::binary);
+  of.write(out.data(), out.size());
+  if (!of)
+    throw std::runtime_error("Failed to write binary results to " + output_path);
+
+  std::cout << "Write to binary complete." << std::endl;
+}
+
+// RESULT WRITER
+
+ResultWriter::ResultWriter(const std::string &path)
+  : buf(1 << 16)
+{
+  out.rdbuf()->pubsetbuf(buf.data(), buf.size());
+  out.open(path, std::ios::binary);
+  if (!out)
+    throw std::runtime_error("Unable to open result file " + path);
+  out << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+  writeStartElement("sim_out");
+}
+
+void ResultWriter::beginSection(const std::string &name)
 {
-  boost::property_tree::ptree node_eng_info;
-  node_eng_info.put("engine", eng_name);
-  node_eng_info.put("version", "TBD"); // TODO real version
-  node_eng_info.put("return_code", std::to_string(return_code).c_str());
+  if (sectionWritten(name))
+    throw std::logic_error("Result section " + name + " was already written");
+  endSection();
+  writeStartElement(name);
+  written_sections.push_back(name);
+}
 
-  //get timing information
-  end_time = std::chrono::system_clock::now();
-  std::chrono::duration<double> elapsed_seconds = end_time-start_time;
-  std::time_t end = std::chrono::system_clock::to_time_t(end_time);
-  char* end_c_str = std::ctime(&end);
-  *std::remove(end_c_str, end_c_str+strlen(end_c_str), '\n') = '\0'; // removes _all_ new lines from the cstr
-  node_eng_info.put("timestamp", end_c_str);
-  node_eng_info.put("time_elapsed_s", std::to_string(elapsed_seconds.count()).c_str());
+void ResultWriter::endSection()
+{
+  while (open_elements.size() > 1)
+    writeEndElement();
+}
 
-  return node_eng_info;
+bool ResultWriter::sectionWritten(const std::string &name) const
+{
+  return std::find(written_sections.begin(), written_sections.end(), name)
+    != written_sections.end();
 }
 
-bpt::ptree SiQADConnector::simParamsPropertyTree()
+void ResultWriter::writeDBLocation(double x, double y)
 {
-  bpt::ptree node_sim_params;
-  for (std::pair<std::string, std::string> param : sim_params)
-    node_sim_params.put(param.first, param.second);
-  return node_sim_params;
+  enterSection("physloc");
+  indent();
+  out << "<dbdot x=\"";
+  writeNumber(x);
+  out << "\" y=\"";
+  writeNumber(y);
+  out << "\"/>\n";
 }
 
-bpt::ptree SiQADConnector::dbLocPropertyTree()
+void ResultWriter::writeChargeConfig(const std::string &dist, double energy,
+    int count, int physically_valid, int state_count)
 {
-  bpt::ptree node_physloc;
-  for (unsigned int i = 0; i < dbl_data.size(); i++){
-    bpt::ptree node_dbdot;
-    node_dbdot.put("<xmlattr>.x", dbl_data[i].first.c_str());
-    node_dbdot.put("<xmlattr>.y", dbl_data[i].second.c_str());
-    node_physloc.add_child("dbdot", node_dbdot);
+  enterSection("elec_dist");
+  if (state_count == -1 && dist.find_first_of("+-") != std::string::npos)
+    state_count = 3;
+  indent();
+  out << "<dist energy=\"";
+  writeNumber(energy);
+  out << "\" count=\"" << count << '"';
+  if (physically_valid != -1)
+    out << " physically_valid=\"" << physically_valid << '"';
+  if (state_count != -1)
+    out << " state_count=\"" << state_count << '"';
+  out << '>' << dist << "</dist>\n";
+}
+
+void ResultWriter::writePotential(double x, double y, double val)
+{
+  enterSection("potential_map");
+  indent();
+  out << "<potential_val x=\"";
+  writeNumber(x);
+  out << "\" y=\"";
+  writeNumber(y);
+  out << "\" val=\"";
+  writeNumber(val);
+  out << "\"/>\n";
+}
+
+void ResultWriter::writeDBLocations(const float *x, const float *y, size_t count)
+{
+  if (count == 0)
+    return;
+  enterSection("physloc");
+  std::string prefix(open_elements.size() * 4, ' ');
+  prefix += "<dbdot x=\"";
+  std::string chunk;
+  for (size_t i=0; i<count; i++) {
+    chunk += prefix;
+    appendNumber(chunk, x[i]);
+    chunk += "\" y=\"";
+    appendNumber(chunk, y[i]);
+    chunk += "\"/>\n";
+    writeChunk(chunk);
   }
-  return node_physloc;
+  writeChunk(chunk, true);
+}
+
+void ResultWriter::writeChargeConfig(const int8_t *charges, size_t db_count,
+    double energy, int count, int physically_valid)
+{
+  // extra electrons + 1 to charge string, always in the 3-state format
+  static const char charge_chars[3] = {'+', '0', '-'};
+  std::string dist(db_count, '0');
+  for (size_t i=0; i<db_count; i++)
+    dist[i] = charge_chars[charges[i] + 1];
+  writeChargeConfig(dist, energy, count, physically_valid, 3);
 }
 
-bpt::ptree SiQADConnector::dbChargePropertyTree()
+void ResultWriter::writePotentials(const float *x, const float *y,
+    const float *val, size_t count)
 {
-  bpt::ptree node_elec_dist;
-  for (unsigned int i = 0; i < db_charge_data.size(); i++){
-    bpt::ptree node_dist;
-    node_dist.put("", db_charge_data[i][0]);
-    node_dist.put("<xmlattr>.energy", db_charge_data[i][1]);
-    node_dist.put("<xmlattr>.count", db_charge_data[i][2]);
-    node_elec_dist.add_child("dist", node_dist);
+  if (count == 0)
+    return;
+  enterSection("potential_map");
+  std::string prefix(open_elements.size() * 4, ' ');
+  prefix += "<potential_val x=\"";
+  std::string chunk;
+  for (size_t i=0; i<count; i++) {
+    chunk += prefix;
+    appendNumber(chunk, x[i]);
+    chunk += "\" y=\"";
+    appendNumber(chunk, y[i]);
+    chunk += "\" val=\"";
+    appendNumber(chunk, val[i]);
+    chunk += "\"/>\n";
+    writeChunk(chunk);
   }
-  return node_elec_dist;
+  writeChunk(chunk, true);
 }
 
-bpt::ptree SiQADConnector::electrodePropertyTree()
+void ResultWriter::writeStartElement(const std::string &name,
+    const std::vector<std::pair<std::string, std::string>> &attrs)
 {
-  bpt::ptree node_electrode;
-  for (unsigned int i = 0; i < elec_data.size(); i++){
-    boost::property_tree::ptree node_dim;
-    node_dim.put("<xmlattr>.x1", elec_data[i][0].c_str());
-    node_dim.put("<xmlattr>.y1", elec_data[i][1].c_str());
-    node_dim.put("<xmlattr>.x2", elec_data[i][2].c_str());
-    node_dim.put("<xmlattr>.y2", elec_data[i][3].c_str());
-    node_electrode.add_child("dim", node_dim);
-    boost::property_tree::ptree node_pot;
-    node_pot.put("", elec_data[i][4].c_str());
-    node_electrode.add_child("potential", node_pot);
+  checkOpen();
+  indent();
+  out << '<' << name;
+  writeAttributes(attrs);
+  out << ">\n";
+  open_elements.push_back(name);
+}
+
+void ResultWriter::writeEndElement()
+{
+  checkOpen();
+  std::string name = open_elements.back();
+  open_elements.pop_back();
+  indent();
+  out << "</" << name << ">\n";
+}
+
+void ResultWriter::writeEmptyElement(const std::string &name,
+    const std::vector<std::pair<std::string, std::string>> &attrs)
+{
+  checkOpen();
+  indent();
+  out << '<' << name;
+  writeAttributes(attrs);
+  out << "/>\n";
+}
+
+void ResultWriter::writeTextElement(const std::string &name, const std::string &text,
+    const std::vector<std::pair<std::string, std::string>> &attrs)
+{
+  checkOpen();
+  indent();
+  out << '<' << name;
+  writeAttributes(attrs);
+  out << '>';
+  writeEscaped(text);
+  out << "</" << name << ">\n";
+}
+
+void ResultWriter::flush()
+{
+  checkOpen();
+  out.flush();
+}
+
+void ResultWriter::close()
+{
+  if (closed)
+    return;
+  while (!open_elements.empty())
+    writeEndElement();
+  out.close();
+  closed = true;
+  if (!out)
+    throw std::runtime_error("Failed to write results");
+}
+
+void ResultWriter::enterSection(const std::string &name)
+{
+  if (open_elements.size() > 1 && open_elements[1] == name) {
+    while (open_elements.size() > 2)
+      writeEndElement();
+  } else {
+    beginSection(name);
   }
-  return node_electrode;
 }
 
-bpt::ptree SiQADConnector::potentialPropertyTree()
+void ResultWriter::checkOpen() const
 {
-  bpt::ptree node_potential_map;
-  for (unsigned int i = 0; i < pot_data.size(); i++){
-    boost::property_tree::ptree node_potential_val;
-    node_potential_val.put("<xmlattr>.x", pot_data[i][0].c_str());
-    node_potential_val.put("<xmlattr>.y", pot_data[i][1].c_str());
-    node_potential_val.put("<xmlattr>.val", pot_data[i][2].c_str());
-    node_potential_map.add_child("potential_val", node_potential_val);
+  if (closed)
+    throw std::logic_error("Result writer is already closed");
+}
+
+void ResultWriter::indent()
+{
+  for (size_t i=0; i<open_elements.size(); i++)
+    out << "    ";
+}
+
+void ResultWriter::writeNumber(double val)
+{
+  // SiQAD stores results in single precision, 9 significant digits round 
+  // trip them
+  char str[32];
+  int len = snprintf(str, sizeof(str), "%.9g", val);
+  out.write(str, len);
+}
+
+void ResultWriter::appendNumber(std::string &chunk, double val)
+{
+  // same precision as writeNumber
+  char str[32];
+  int len = snprintf(str, sizeof(str), "%.9g", val);
+  chunk.append(str, len);
+}
+
+void ResultWriter::writeChunk(std::string &chunk, bool force)
+{
+  // records are formatted into chunks which are handed to the stream whole
+  if (chunk.size() >= (1 << 15) || (force && !chunk.empty())) {
+    out.write(chunk.data(), chunk.size());
+    chunk.clear();
   }
-  return node_potential_map;
 }
 
-bpt::ptree SiQADConnector::dbPotentialPropertyTree()
+void ResultWriter::writeEscaped(const std::string &text)
 {
-  bpt::ptree node_dbdots;
-  for (unsigned int i = 0; i < db_pot_data.size(); i++){
-    bpt::ptree node_dbdot;
-    bpt::ptree node_physloc;
-    boost::property_tree::ptree node_db_step;
-    node_db_step.put("", db_pot_data[i][0].c_str());
-    node_dbdot.add_child("step", node_db_step);
-    node_physloc.put("<xmlattr>.x", db_pot_data[i][1].c_str());
-    node_physloc.put("<xmlattr>.y", db_pot_data[i][2].c_str());
-    node_dbdot.add_child("physloc", node_physloc);
-    boost::property_tree::ptree node_db_pot;
-    node_db_pot.put("", db_pot_data[i][3].c_str());
-    node_dbdot.add_child("potential", node_db_pot);
-    node_dbdots.add_child("dbdot", node_dbdot);
+  size_t start = 0;
+  for (size_t i=0; i<text.size(); i++) {
+    const char *ent = nullptr;
+    switch (text[i]) {
+      case '&': ent = "&amp;"; break;
+      case '<': ent = "&lt;"; break;
+      case '>': ent = "&gt;"; break;
+      case '"': ent = "&quot;"; break;
+      default: break;
+    }
+    if (ent != nullptr) {
+      out.write(text.data() + start, i - start);
+      out << ent;
+      start = i + 1;
+    }
   }
-  return node_dbdots;
+  out.write(text.data() + start, text.size() - start);
 }
 
-bpt::ptree SiQADConnector::sqCommandsPropertyTree()
+void ResultWriter::writeAttributes(const std::vector<std::pair<std::string, std::string>> &attrs)
 {
-  bpt::ptree node_sqcommands;
-  for (unsigned int i = 0; i < export_commands.size(); i++) {
-    std::cout << "command " << i << ": ";
-    std::cout << export_commands.at(i) << std::endl;
-    bpt::ptree node_sqc;
-    node_sqc.put("", export_commands.at(i).c_str());
-    //std::cout << export_commands.at(i)->finalCommand() << std::endl;
-    node_sqcommands.add_child("sqc", node_sqc);
+  for (auto &attr : attrs) {
+    out << ' ' << attr.first << "=\"";
+    writeEscaped(attr.second);
+    out << '"';
   }
-  return node_sqcommands;
 }
 
+
 //DB ITERATOR
 
 DBIterator::DBIterator(std::shared_ptr<Aggregate> root, bool begin)
@@ -475,6 +1601,169 @@ void DBIterator::pop()
 }
 
 
+// DB ARRAYS
+DBArrays::DBArrays(const std::shared_ptr<Aggregate> &root)
+{
+  collect(root, -1);
+}
+
+void DBArrays::collect(const std::shared_ptr<Aggregate> &agg, int parent)
+{
+  // same order as DBIterator: an aggregate's DBs, then its child aggregates
+  int agg_ind = agg_parents.size();
+  agg_parents.push_back(parent);
+  for (auto &db : agg->dbs) {
+    xs.push_back(db->x);
+    ys.push_back(db->y);
+    ns.push_back(db->n);
+    ms.push_back(db->m);
+    ls.push_back(db->l);
+    agg_inds.push_back(agg_ind);
+  }
+  for (auto &child : agg->aggs)
+    collect(child, agg_ind);
+}
+
+
+// DB SPATIAL INDEX
+DBSpatialIndex::DBSpatialIndex(const float *x, const float *y, size_t count,
+    float cell_size)
+  : xs(x, x + count), ys(y, y + count)
+{
+  if (count == 0) {
+    cell_start.assign(2, 0);
+    return;
+  }
+
+  float max_x = *std::max_element(xs.begin(), xs.end());
+  float max_y = *std::max_element(ys.begin(), ys.end());
+  min_x = *std::min_element(xs.begin(), xs.end());
+  min_y = *std::min_element(ys.begin(), ys.end());
+  double area = std::max(double(max_x - min_x), 1.) * std::max(double(max_y - min_y), 1.);
+
+  // about one DB per cell unless specified, never many more cells than DBs
+  double min_cell = std::sqrt(area / (4. * count + 16.));
+  cell = (cell_size > 0) ? std::max(double(cell_size), min_cell) : std::sqrt(area / count);
+  nx = static_cast<int>((max_x - min_x) / cell) + 1;
+  ny = static_cast<int>((max_y - min_y) / cell) + 1;
+
+  // counting sort of the DBs by cell
+  std::vector<int> db_cells(count);
+  cell_start.assign(size_t(nx) * ny + 1, 0);
+  for (size_t i=0; i<count; i++) {
+    db_cells[i] = cellY(ys[i]) * nx + cellX(xs[i]);
+    cell_start[db_cells[i] + 1]++;
+  }
+  for (size_t c=1; c<cell_start.size(); c++)
+    cell_start[c] += cell_start[c-1];
+  std::vector<int> fill(cell_start.begin(), cell_start.end() - 1);
+  cell_dbs.resize(count);
+  for (size_t i=0; i<count; i++)
+    cell_dbs[fill[db_cells[i]]++] = i;
+}
+
+int DBSpatialIndex::cellX(float x) const
+{
+  return std::min(std::max(static_cast<int>(std::floor((x - min_x) / cell)), 0), nx - 1);
+}
+
+int DBSpatialIndex::cellY(float y) const
+{
+  return std::min(std::max(static_cast<int>(std::floor((y - min_y) / cell)), 0), ny - 1);
+}
+
+std::vector<int> DBSpatialIndex::neighborsWithin(float x, float y, float r) const
+{
+  std::vector<int> neighbors;
+  if (xs.empty() || r < 0)
+    return neighbors;
+  // cells overlapping the bounding box of the circle
+  int cx0 = cellX(x - r), cx1 = cellX(x + r);
+  int cy0 = cellY(y - r), cy1 = cellY(y + r);
+  float r2 = r * r;
+  for (int cy=cy0; cy<=cy1; cy++) {
+    for (int c=cy*nx+cx0; c<=cy*nx+cx1; c++) {
+      for (int i=cell_start[c]; i<cell_start[c+1]; i++) {
+        int db = cell_dbs[i];
+        float dx = xs[db] - x, dy = ys[db] - y;
+        if (dx * dx + dy * dy <= r2)
+          neighbors.push_back(db);
+      }
+    }
+  }
+  std::sort(neighbors.begin(), neighbors.end());
+  return neighbors;
+}
+
+std::vector<int> DBSpatialIndex::neighborsOfDB(int db_ind, float r) const
+{
+  std::vector<int> neighbors = neighborsWithin(xs.at(db_ind), ys.at(db_ind), r);
+  neighbors.erase(std::remove(neighbors.begin(), neighbors.end(), db_ind), neighbors.end());
+  return neighbors;
+}
+
+std::vector<int> DBSpatialIndex::nearest(float x, float y, int k) const
+{
+  return nearestImpl(x, y, k, -1);
+}
+
+std::vector<int> DBSpatialIndex::nearestToDB(int db_ind, int k) const
+{
+  return nearestImpl(xs.at(db_ind), ys.at(db_ind), k, db_ind);
+}
+
+std::vector<int> DBSpatialIndex::nearestImpl(float x, float y, int k, int exclude_ind) const
+{
+  // search rings of cells around the point until the k-th nearest candidate
+  // is closer than anything outside the searched area
+  std::vector<std::pair<float, int>> cands;  // squared distance and index
+  if (k <= 0 || xs.empty())
+    return std::vector<int>();
+  int cx = cellX(x), cy = cellY(y);
+  for (int ring=0; ; ring++) {
+    for (int gy=cy-ring; gy<=cy+ring; gy++) {
+      if (gy < 0 || gy >= ny)
+        continue;
+      for (int gx=cx-ring; gx<=cx+ring; gx++) {
+        if (gx < 0 || gx >= nx)
+          continue;
+        if (std::abs(gx - cx) != ring && std::abs(gy - cy) != ring)
+          continue;   // inner cells were searched in earlier rings
+        int c = gy * nx + gx;
+        for (int i=cell_start[c]; i<cell_start[c+1]; i++) {
+          int db = cell_dbs[i];
+          if (db == exclude_ind)
+            continue;
+          float dx = xs[db] - x, dy = ys[db] - y;
+          cands.push_back(std::make_pair(dx * dx + dy * dy, db));
+        }
+      }
+    }
+
+    // distance from the point to the edge of the searched area
+    float left = min_x + (cx - ring) * cell, right = min_x + (cx + ring + 1) * cell;
+    float top = min_y + (cy - ring) * cell, bottom = min_y + (cy + ring + 1) * cell;
+    bool covers_grid = cx - ring <= 0 && cy - ring <= 0
+                       && cx + ring >= nx - 1 && cy + ring >= ny - 1;
+    if (covers_grid)
+      break;
+    if (static_cast<int>(cands.size()) >= k) {
+      float margin = std::min(std::min(x - left, right - x), std::min(y - top, bottom - y));
+      std::nth_element(cands.begin(), cands.begin() + k - 1, cands.end());
+      if (margin > 0 && cands[k-1].first <= margin * margin)
+        break;
+    }
+  }
+
+  size_t n = std::min(cands.size(), static_cast<size_t>(k));
+  std::partial_sort(cands.begin(), cands.begin() + n, cands.end());
+  std::vector<int> inds(n);
+  for (size_t i=0; i<n; i++)
+    inds[i] = cands[i].second;
+  return inds;
+}
+
+
 // ELEC ITERATOR
 ElecIterator::ElecIterator(std::shared_ptr<Aggregate> root, bool begin)
 {
@@ -18,23 +18,25 @@
 #include <memory>
 #include <map>
 #include <iostream>
+#include <cstdint>
+#include <algorithm>
 
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/xml_parser.hpp>
 #include <boost/bimap.hpp>
 #include <string>
 #include <vector>
+#include <fstream>
 #include <ctime>
 #include <chrono>
 
 namespace phys{
-  namespace bpt = boost::property_tree;
 
   // forward declaration
   struct Layer;
   struct DBDot;
   class DBIterator;
   class DBCollection;
+  class DBArrays;
+  class DBSpatialIndex;
   struct Electrode;
   class ElecIterator;
   class ElectrodeCollection;
@@ -46,6 +48,10 @@ namespace phys{
   class SQCommand;
   class AggregateCommand;
 
+  class ProblemXmlReader;
+  class BinaryProblemReader;
+  class ResultWriter;
+
   typedef std::vector<std::shared_ptr<DBDot>>::const_iterator DBIter;
   typedef std::vector<std::shared_ptr<Electrode>>::const_iterator ElecIter;
   typedef std::vector<std::shared_ptr<ElectrodePoly>>::const_iterator ElecPolyIter;
@@ -59,14 +65,30 @@ namespace phys{
     SiQADConnector(const std::string &eng_name, const std::string &input_path,
         const std::string &output_path);
     // DESTRUCTOR
-    ~SiQADConnector()
-    {
-      writeResultsXml();
-    }
+    ~SiQADConnector();
 
-    // Write results to the provided output_path
+    // Write results to the provided output_path, finishing the result writer
+    // if the engine has streamed records into it
     void writeResultsXml();
 
+    // Write results to the provided output_path in the binary result format,
+    // which SiQAD loads without parsing. Only DB locations, electron 
+    // distributions and potentials are representable, XML is written instead
+    // if other exports are set. If SiQAD has named a result segment through 
+    // the SIQAD_RESULT_SHM environment variable, the binary results are put 
+    // in that POSIX shared memory segment instead of output_path.
+    void writeResultsBinary();
+
+    // Choose whether results are written in the binary format on destruction.
+    // Ignored once the result writer has been used.
+    void setBinaryResults(bool binary) {binary_results = binary;}
+
+    // Return the writer streaming results to output_path, which is opened on
+    // first use. Engines with large results should write their records 
+    // through it as they are produced instead of using setExport; anything
+    // set through setExport is appended when the connector is destroyed.
+    ResultWriter* resultWriter();
+
 
     // EXPORTING
 
@@ -74,9 +96,38 @@ namespace phys{
     void setExport(std::string type, std::vector< std::pair< std::string, std::string > > &data_in);
     void setExport(std::string type, std::vector< std::vector< std::string > > &data_in);
 
+    // Typed exports, kept in their binary form and only formatted when the
+    // results are written. Charges are given per DB as the number of extra 
+    // electrons (-1 for DB+, 0 for DB0, 1 for DB-) and all configs must have
+    // the same DB count. Each call appends to what was exported before.
+    void exportChargeConfig(const int8_t *charges, size_t db_count, double energy,
+        int count, int physically_valid=-1);
+    void exportChargeConfig(const std::vector<int8_t> &charges, double energy,
+        int count, int physically_valid=-1)
+    {
+      exportChargeConfig(charges.data(), charges.size(), energy, count, physically_valid);
+    }
+    void exportPotentials(const float *x, const float *y, const float *val, size_t count);
+    void exportPotentials(const std::vector<float> &x, const std::vector<float> &y,
+        const std::vector<float> &val);
+    void exportDBLocations(const float *x, const float *y, size_t count);
+    void exportDBLocations(const std::vector<float> &x, const std::vector<float> &y);
+
     // Add SQCommand export
     void addSQCommand(SQCommand *);
 
+    // Stream export data to SiQAD through stdout while the plugin is still
+    // running, one record per line prefixed by stream_marker. SiQAD shows
+    // streamed results live, the result file written at the end supersedes
+    // them. Supported types are "db_loc" (stream before any "db_charge") and
+    // "db_charge" with rows of dist, energy, count and optionally
+    // physically_valid and state_count.
+    void streamExport(std::string type, std::vector< std::pair< std::string, std::string > > &data_in);
+    void streamExport(std::string type, std::vector< std::vector< std::string > > &data_in);
+
+    // Prefix of result stream records in stdout
+    static constexpr const char *stream_marker = "[SQSTREAM] ";
+
 
     // SIMULATION PARAMETERS
 
@@ -96,6 +147,15 @@ namespace phys{
     // across all aggregate levels.
     DBCollection* dbCollection() {return db_col;}
 
+    // Return pointer to the flat arrays of all DBs, in the same order as 
+    // dbCollection(). Prefer this for building interaction matrices.
+    DBArrays* dbArrays() {return db_arrays;}
+
+    // Return pointer to a neighbor index over dbArrays(), built on first use
+    // and rebuilt if a different cell size is requested. The cell size is 
+    // best set to the typical query radius, 0 picks one from the DB density.
+    DBSpatialIndex* dbSpatialIndex(float cell_size=0);
+
     // Return pointer to Electrode collection, which allows iteration through
     // electrodes across all electrode layers.
     ElectrodeCollection* electrodeCollection() {return elec_col;}
@@ -113,45 +173,47 @@ namespace phys{
 
   private:
 
-    // Read the problem file
+    // Read the problem file, streaming it into the collections without 
+    // building a tree of the whole file
     void readProblem(const std::string &path);
 
+    // Read problem from the binary problem in the named POSIX shared memory
+    // segment set up by SiQAD. Returns false if the segment can't be opened,
+    // in which case the problem should be read from the problem file.
+    bool readProblemShared(const std::string &name);
+
+    // Read problem from a binary problem held in memory.
+    void readBinaryProblem(const char *data, size_t size);
+
     // Read program properties
-    void readProgramProp(const bpt::ptree &);
+    void readProgramProp(ProblemXmlReader &);
 
     // Read layer properties
-    void readLayers(const bpt::ptree &);
-    void readLayerProp(const bpt::ptree &);
+    void readLayers(ProblemXmlReader &);
+    void readLayerProp(ProblemXmlReader &);
 
     // Read simulation parameters
-    void readSimulationParam(const bpt::ptree &);
-
-    // Read design
-    void readDesign(const bpt::ptree &, const std::shared_ptr<Aggregate> &);
-    void readItemTree(const bpt::ptree &, const std::shared_ptr<Aggregate> &);
-    void readElectrode(const bpt::ptree &, const std::shared_ptr<Aggregate> &);
-    void readElectrodePoly(const bpt::ptree &, const std::shared_ptr<Aggregate> &);
-    void readDBDot(const bpt::ptree &, const std::shared_ptr<Aggregate> &);
-
-    // Generate property trees for writing
-    bpt::ptree engInfoPropertyTree();
-    bpt::ptree simParamsPropertyTree();
-    bpt::ptree dbLocPropertyTree();
-    bpt::ptree dbChargePropertyTree();
-    bpt::ptree electrodePropertyTree();
-    // bpt::ptree electrodePolyPropertyTree();
-    bpt::ptree potentialPropertyTree();
-    bpt::ptree dbPotentialPropertyTree(); // TODO fix up this function, a lot of redundant information
-    bpt::ptree sqCommandsPropertyTree();
+    void readSimulationParam(ProblemXmlReader &);
+
+    // Read design, each function consumes the element the reader is at
+    void readDesign(ProblemXmlReader &, const std::shared_ptr<Aggregate> &);
+    void readItemTree(ProblemXmlReader &, const std::shared_ptr<Aggregate> &);
+    void readElectrode(ProblemXmlReader &, const std::shared_ptr<Aggregate> &);
+    void readElectrodePoly(ProblemXmlReader &, const std::shared_ptr<Aggregate> &);
+    void readDBDot(ProblemXmlReader &, const std::shared_ptr<Aggregate> &);
 
     // Engine properties
     std::string eng_name;                 // name of simulation engine
     std::string input_path;               // path to problem file
     std::string output_path;              // path to result export
+    std::string result_shm;               // shared memory segment for binary results, empty if none
 
     // Iterable collections
     ElectrodeCollection* elec_col;
     DBCollection* db_col;
+    DBArrays* db_arrays;
+    DBSpatialIndex* db_spatial_index=nullptr;
+    float db_index_cell_size=0;    // cell size requested for db_spatial_index
     ElectrodePolyCollection* elec_poly_col;
 
     // Retrieved items and properties
@@ -169,13 +231,96 @@ namespace phys{
     std::vector<std::vector<std::string>> db_charge_data;       // pair of elec dist and energy
     std::vector<std::string> export_commands;                   // SQCommands to be exported
 
+    // Typed exportable data
+    struct ChargeConfigRecord {
+      double energy;
+      int count;
+      int physically_valid;
+    };
+    std::vector<int8_t> charge_states;              // charges of all typed configs, concatenated
+    std::vector<ChargeConfigRecord> charge_records; // per typed config information
+    size_t charge_db_count=0;                       // DB count of the typed configs
+    std::vector<float> db_xs, db_ys;                // typed DB locations
+    std::vector<float> pot_xs, pot_ys, pot_vals;    // typed potential samples
+
     // Runtime information
+    ResultWriter *result_writer=nullptr;
+    bool binary_results=false;
     int return_code=0;
     std::chrono::time_point<std::chrono::system_clock> start_time;
     std::chrono::time_point<std::chrono::system_clock> end_time;
   };
 
 
+  // Writes the result file incrementally through a buffered stream, with no
+  // tree of the results built in memory. Each top level element of the file 
+  // is a section, opened by its first record and closed when another section
+  // begins; a section can only be written once. Typed records are formatted 
+  // straight into the stream.
+  class ResultWriter
+  {
+  public:
+    explicit ResultWriter(const std::string &path);
+    ~ResultWriter() {if (!closed) close();}
+
+    // Begin a new section, closing the current one.
+    void beginSection(const std::string &name);
+
+    // Close the current section.
+    void endSection();
+
+    // Return whether the given section has been written.
+    bool sectionWritten(const std::string &name) const;
+
+    // Typed records, each goes into its section ("physloc", "elec_dist" and
+    // "potential_map" respectively). state_count is inferred from dist if not
+    // given, physically_valid is omitted if -1.
+    void writeDBLocation(double x, double y);
+    void writeChargeConfig(const std::string &dist, double energy, int count,
+        int physically_valid=-1, int state_count=-1);
+    void writePotential(double x, double y, double val);
+
+    // Batches of typed records, formatted in chunks. Charges follow the 
+    // convention of SiQADConnector::exportChargeConfig.
+    void writeDBLocations(const float *x, const float *y, size_t count);
+    void writeChargeConfig(const int8_t *charges, size_t db_count, double energy,
+        int count, int physically_valid=-1);
+    void writePotentials(const float *x, const float *y, const float *val, size_t count);
+
+    // Generic elements within the current section.
+    void writeStartElement(const std::string &name,
+        const std::vector<std::pair<std::string, std::string>> &attrs={});
+    void writeEndElement();
+    void writeEmptyElement(const std::string &name,
+        const std::vector<std::pair<std::string, std::string>> &attrs={});
+    void writeTextElement(const std::string &name, const std::string &text,
+        const std::vector<std::pair<std::string, std::string>> &attrs={});
+
+    // Flush buffered records to the file, e.g. so partial results survive a
+    // crash. The file is only well-formed after close().
+    void flush();
+
+    // Close all open elements and the file.
+    void close();
+
+  private:
+    void enterSection(const std::string &name);
+    void checkOpen() const;
+    void indent();
+    void writeNumber(double val);
+    static void appendNumber(std::string &chunk, double val);
+    void writeChunk(std::string &chunk, bool force=false);
+    void writeEscaped(const std::string &text);
+    void writeAttributes(const std::vector<std::pair<std::string, std::string>> &attrs);
+
+    std::vector<char> buf;                  // stream buffer
+    std::ofstream out;
+    std::vector<std::string> open_elements; // root element first
+    std::vector<std::string> written_sections;
+    bool closed=false;
+  };
+
+
   // layer struct
   struct Layer {
     Layer(std::string name, std::string type, float zoffset, float zheight)
@@ -231,6 +376,101 @@ namespace phys{
     std::shared_ptr<Aggregate> db_tree_inner;
   };
 
+  // Structure-of-arrays view of all dangling bonds in the problem, in the 
+  // same order as DBCollection iterates them. Built once after the problem is
+  // read, the accessors return pointers into contiguous arrays of size().
+  class DBArrays
+  {
+  public:
+    explicit DBArrays(const std::shared_ptr<Aggregate> &root);
+
+    // number of DBs
+    size_t size() const {return xs.size();}
+
+    // physical locations in angstroms
+    const float *x() const {return xs.data();}
+    const float *y() const {return ys.data();}
+
+    // lattice coordinates
+    const int *n() const {return ns.data();}
+    const int *m() const {return ms.data();}
+    const int *l() const {return ls.data();}
+
+    // index of the innermost aggregate containing each DB, aggregates are 
+    // numbered in iteration order with 0 being the top level of the design
+    const int *aggregate() const {return agg_inds.data();}
+
+    // number of aggregates including the top level
+    size_t aggregateCount() const {return agg_parents.size();}
+
+    // parent of each aggregate, -1 for the top level
+    const int *aggregateParent() const {return agg_parents.data();}
+
+  private:
+    // append the DBs of agg and its children
+    void collect(const std::shared_ptr<Aggregate> &agg, int parent);
+
+    std::vector<float> xs, ys;
+    std::vector<int> ns, ms, ls;
+    std::vector<int> agg_inds;
+    std::vector<int> agg_parents;
+  };
+
+  // Uniform grid (cell list) over DB locations answering neighbor queries 
+  // without computing all pairwise distances. DBs are sorted by cell so each
+  // cell is a contiguous range; queries return indices into the arrays the 
+  // index was built from.
+  class DBSpatialIndex
+  {
+  public:
+    // Build from DB locations. A cell_size of 0 picks one giving about one DB
+    // per cell, the cell size is also enlarged if the grid would otherwise 
+    // have many more cells than DBs.
+    DBSpatialIndex(const float *x, const float *y, size_t count, float cell_size=0);
+    DBSpatialIndex(const std::vector<float> &x, const std::vector<float> &y,
+        float cell_size=0)
+      : DBSpatialIndex(x.data(), y.data(), std::min(x.size(), y.size()), cell_size) {};
+    explicit DBSpatialIndex(const DBArrays &dbs, float cell_size=0)
+      : DBSpatialIndex(dbs.x(), dbs.y(), dbs.size(), cell_size) {};
+
+    // Return the indices of DBs within radius r of the point, in ascending 
+    // order.
+    std::vector<int> neighborsWithin(float x, float y, float r) const;
+
+    // Return the indices of DBs within radius r of the given DB excluding
+    // itself, in ascending order.
+    std::vector<int> neighborsOfDB(int db_ind, float r) const;
+
+    // Return the indices of the k DBs nearest to the point, nearest first.
+    std::vector<int> nearest(float x, float y, int k) const;
+
+    // Return the indices of the k DBs nearest to the given DB excluding 
+    // itself, nearest first.
+    std::vector<int> nearestToDB(int db_ind, int k) const;
+
+    // Number of indexed DBs.
+    size_t size() const {return xs.size();}
+
+    // Side length of the cells.
+    float cellSize() const {return cell;}
+
+  private:
+    // Return the cell column / row containing the coordinate, clamped to the
+    // grid.
+    int cellX(float x) const;
+    int cellY(float y) const;
+
+    // Return the k nearest DBs to the point, skipping exclude_ind.
+    std::vector<int> nearestImpl(float x, float y, int k, int exclude_ind) const;
+
+    std::vector<float> xs, ys;      // DB locations in original order
+    std::vector<int> cell_dbs;      // DB indices sorted by cell
+    std::vector<int> cell_start;    // start of each cell in cell_dbs, one extra at the end
+    float min_x=0, min_y=0;         // grid origin
+    float cell=1;                   // cell side length
+    int nx=1, ny=1;                 // grid dimensions
+  };
+
 
   // electrode_poly
   struct ElectrodePoly {
@@ -12,11 +12,35 @@
 %include <std_string.i>
 %include <std_map.i>
 %include <exception.i>
+%include <stdint.i>
 
 %{
 #include "siqadconn.h"
 %}
 
+// pointer overloads of the typed exports, Python uses the vector ones
+%ignore phys::SiQADConnector::exportChargeConfig(const int8_t *, size_t, double, int, int);
+%ignore phys::SiQADConnector::exportChargeConfig(const int8_t *, size_t, double, int);
+%ignore phys::SiQADConnector::exportPotentials(const float *, const float *, const float *, size_t);
+%ignore phys::SiQADConnector::exportDBLocations(const float *, const float *, size_t);
+%ignore phys::ResultWriter::writeDBLocations;
+%ignore phys::ResultWriter::writeChargeConfig(const int8_t *, size_t, double, int, int);
+%ignore phys::ResultWriter::writeChargeConfig(const int8_t *, size_t, double, int);
+%ignore phys::ResultWriter::writePotentials;
+
+// raw pointers to the DB arrays are exposed as numpy arrays below instead
+%ignore phys::DBArrays::x;
+%ignore phys::DBArrays::y;
+%ignore phys::DBArrays::n;
+%ignore phys::DBArrays::m;
+%ignore phys::DBArrays::l;
+%ignore phys::DBArrays::aggregate;
+%ignore phys::DBArrays::aggregateParent;
+
+// the spatial index is built from Python sequences through the vector constructor
+%ignore phys::DBSpatialIndex::DBSpatialIndex(const float *, const float *, size_t, float);
+%ignore phys::DBSpatialIndex::DBSpatialIndex(const float *, const float *, size_t);
+
 %include "siqadconn.h"
 
 namespace std {
@@ -25,6 +49,8 @@ namespace std {
     %template(FloatPair) pair<float, float>;
     %template(FloatPairVector) vector< pair <float, float> >;
     %template(IntVector) vector<int>;
+    %template(Int8Vector) vector<int8_t>;
+    %template(FloatVector) vector<float>;
     %template(StringPair) pair<string, string>;
     %template(StringPairVector) vector< pair<string, string> >;
     %template(StringVector) vector<string>;
@@ -75,6 +101,14 @@ namespace std {
         else:
             self.setExport(key, StringVector2D(self.tuplify(kwargs[key])))
   }
+  %pythoncode{
+    def stream(self, *args, **kwargs):
+      for key in kwargs:
+        if key == 'db_loc':
+            self.streamExport(key, StringPairVector(self.tuplify(kwargs[key])))
+        else:
+            self.streamExport(key, StringVector2D(self.tuplify(kwargs[key])))
+  }
   %pythoncode{
     def addCommand(self, *args, **kwargs):
       command_action = args[0]  # e.g. add, remove
@@ -91,6 +125,42 @@ namespace std {
   }
 }
 
+%extend phys::DBArrays {
+  // Read-only memoryview over one of the arrays, numpy wraps it without 
+  // copying. Only valid while the connector is alive.
+  PyObject *_view(const std::string &field) {
+    const char *data = nullptr;
+    size_t count = $self->size();
+    size_t width = (field == "x" || field == "y") ? sizeof(float) : sizeof(int);
+    if (field == "x") data = reinterpret_cast<const char*>($self->x());
+    else if (field == "y") data = reinterpret_cast<const char*>($self->y());
+    else if (field == "n") data = reinterpret_cast<const char*>($self->n());
+    else if (field == "m") data = reinterpret_cast<const char*>($self->m());
+    else if (field == "l") data = reinterpret_cast<const char*>($self->l());
+    else if (field == "aggregate") data = reinterpret_cast<const char*>($self->aggregate());
+    else if (field == "aggregate_parent") {
+      data = reinterpret_cast<const char*>($self->aggregateParent());
+      count = $self->aggregateCount();
+    } else {
+      PyErr_SetString(PyExc_KeyError, field.c_str());
+      return NULL;
+    }
+    return PyMemoryView_FromMemory(const_cast<char*>(data), count * width, PyBUF_READ);
+  }
+  %pythoncode{
+    def _array(self, field, dtype):
+      import numpy as np
+      return np.frombuffer(self._view(field), dtype=dtype)
+    x = property(lambda self: self._array('x', 'float32'))
+    y = property(lambda self: self._array('y', 'float32'))
+    n = property(lambda self: self._array('n', 'intc'))
+    m = property(lambda self: self._array('m', 'intc'))
+    l = property(lambda self: self._array('l', 'intc'))
+    aggregate = property(lambda self: self._array('aggregate', 'intc'))
+    aggregate_parent = property(lambda self: self._array('aggregate_parent', 'intc'))
+  }
+}
+
 %extend phys::DBCollection {
   phys::DBIterator __iter__() {
     phys::DBIterator iter = $self->begin();
@@ -206,7 +206,8 @@ void gui::ApplicationGUI::initGUI()
   connect(job_manager, &gui::JobManager::sig_exportJobProblem,
           [this](comp::JobStep *js, gui::DesignInclusionArea inclusion_area)
           {
-            saveToFile(SaveSimulationProblem, js->problemPath(), inclusion_area, js);
+            if (!js->usesSharedExchange() || !exportSharedProblem(js, inclusion_area))
+              saveToFile(SaveSimulationProblem, js->problemPath(), inclusion_area, js);
           });
   connect(settings_dialog, &settings::SettingsDialog::sig_resetSettings,
           [this](){reset_settings = true;});
@@ -1192,6 +1193,22 @@ void gui::ApplicationGUI::newFile()
 
 
 // save/load:
+bool gui::ApplicationGUI::exportSharedProblem(comp::JobStep *job_step,
+                                              gui::DesignInclusionArea inclusion_area)
+{
+  // same content as the problem file written by saveToFile
+  comp::BinaryProblem problem;
+  problem.setProgramProperty("file_purpose", "simulation");
+  problem.setProgramProperty("version", QCoreApplication::applicationVersion());
+  problem.setProgramProperty("date", QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"));
+  problem.setSimParams(job_step->jobParameters());
+  design_pan->writeToBinaryProblem(&problem, inclusion_area);
+
+  qDebug() << tr("Export: %1 DBs written to the shared problem of job step %2")
+    .arg(problem.dbCount()).arg(job_step->jobStepPlacement());
+  return job_step->setSharedProblem(problem);
+}
+
 bool gui::ApplicationGUI::saveToFile(gui::ApplicationGUI::SaveFlag flag,
                                      const QString &path,
                                      gui::DesignInclusionArea inclusion_area,
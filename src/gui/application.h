@@ -126,6 +126,12 @@ namespace gui{
                     gui::DesignInclusionArea inclusion_area=gui::IncludeEntireDesign,
                     comp::JobStep *job_step=nullptr);
 
+    //! Export the simulation problem of a job step to its shared memory
+    //! problem segment. Returns false if the job step has to fall back to the
+    //! problem file.
+    bool exportSharedProblem(comp::JobStep *job_step,
+                             gui::DesignInclusionArea inclusion_area);
+
     //! Perform autosave.
     void autoSave();
 
@@ -0,0 +1,147 @@
+// @file:     binary_problem.cc
+// @author:   agent
+// @created:  2026.10.17
+// @license:  GNU LGPL v3
+//
+// @desc:     BinaryProblem implementation.
+
+#include "binary_problem.h"
+
+using namespace comp;
+
+static const char binary_problem_magic[4] = {'S', 'Q', 'P', 'B'};
+static const quint32 binary_problem_version = 1;
+
+static_assert(sizeof(BinaryProblem::DBDotRecord) == 24, "Unexpected DBDotRecord padding");
+static_assert(sizeof(BinaryProblem::ElectrodeRecord) == 80, "Unexpected ElectrodeRecord padding");
+
+namespace {
+
+  void appendString(QByteArray &buf, const QString &str)
+  {
+    QByteArray utf8 = str.toUtf8();
+    quint32 len = utf8.size();
+    buf.append(reinterpret_cast<const char*>(&len), sizeof(len));
+    buf.append(utf8);
+  }
+
+  template<typename T>
+  void appendValue(QByteArray &buf, T val)
+  {
+    buf.append(reinterpret_cast<const char*>(&val), sizeof(T));
+  }
+
+  quint64 padded(quint64 size)
+  {
+    return (size + 7) / 8 * 8;
+  }
+
+}
+
+QList<QPair<BinaryProblem::SectionType, QByteArray>> BinaryProblem::serializeSections() const
+{
+  QList<QPair<SectionType, QByteArray>> sections;
+
+  auto properties = [](const QMap<QString, QString> &props)
+  {
+    QByteArray sec;
+    appendValue<quint32>(sec, props.size());
+    for (auto it = props.cbegin(); it != props.cend(); ++it) {
+      appendString(sec, it.key());
+      appendString(sec, it.value());
+    }
+    return sec;
+  };
+  sections.append(qMakePair(ProgramSection, properties(program_props)));
+  sections.append(qMakePair(SimParamsSection, properties(sim_params)));
+
+  QByteArray layers_sec;
+  appendValue<quint32>(layers_sec, layers.size());
+  for (const LayerEntry &layer : layers) {
+    appendString(layers_sec, layer.name);
+    appendString(layers_sec, layer.type);
+    appendString(layers_sec, layer.role);
+    appendValue<float>(layers_sec, layer.zoffset);
+    appendValue<float>(layers_sec, layer.zheight);
+  }
+  sections.append(qMakePair(LayersSection, layers_sec));
+
+  QByteArray aggs_sec;
+  appendValue<quint32>(aggs_sec, aggregates.size());
+  appendValue<quint32>(aggs_sec, 0);
+  aggs_sec.append(reinterpret_cast<const char*>(aggregates.constData()),
+                  aggregates.size() * sizeof(qint32));
+  sections.append(qMakePair(AggregatesSection, aggs_sec));
+
+  return sections;
+}
+
+quint64 BinaryProblem::serializedSize() const
+{
+  // header, section table with the DB and electrode sections, then sections
+  QList<QPair<SectionType, QByteArray>> sections = serializeSections();
+  quint64 size = 16 + (sections.size() + 2) * 24;
+  for (const QPair<SectionType, QByteArray> &sec : sections)
+    size += padded(sec.second.size());
+  size += padded(8 + quint64(dbs.size()) * sizeof(DBDotRecord));
+  size += padded(8 + quint64(electrodes.size()) * sizeof(ElectrodeRecord));
+  return size;
+}
+
+void BinaryProblem::serialize(uchar *dest) const
+{
+  QList<QPair<SectionType, QByteArray>> sections = serializeSections();
+  quint32 section_count = sections.size() + 2;
+
+  memcpy(dest, binary_problem_magic, 4);
+  quint32 header[3] = {binary_problem_version, section_count, 0};
+  memcpy(dest + 4, header, sizeof(header));
+
+  uchar *entry = dest + 16;
+  quint64 offset = 16 + quint64(section_count) * 24;
+  auto addEntry = [&entry, &offset, dest](SectionType type, quint64 size)
+  {
+    quint32 type_field[2] = {static_cast<quint32>(type), 0};
+    quint64 loc[2] = {offset, size};
+    memcpy(entry, type_field, sizeof(type_field));
+    memcpy(entry + 8, loc, sizeof(loc));
+    entry += 24;
+    uchar *sec = dest + offset;
+    memset(sec + size, 0, padded(size) - size);
+    offset += padded(size);
+    return sec;
+  };
+
+  for (const QPair<SectionType, QByteArray> &sec : sections) {
+    uchar *sec_data = addEntry(sec.first, sec.second.size());
+    memcpy(sec_data, sec.second.constData(), sec.second.size());
+  }
+
+  // DBs and electrodes go straight to the destination
+  quint64 db_count = dbs.size();
+  uchar *db_sec = addEntry(DBDotsSection, 8 + db_count * sizeof(DBDotRecord));
+  memcpy(db_sec, &db_count, 8);
+  memcpy(db_sec + 8, dbs.constData(), db_count * sizeof(DBDotRecord));
+
+  quint64 elec_count = electrodes.size();
+  uchar *elec_sec = addEntry(ElectrodesSection, 8 + elec_count * sizeof(ElectrodeRecord));
+  memcpy(elec_sec, &elec_count, 8);
+  memcpy(elec_sec + 8, electrodes.constData(), elec_count * sizeof(ElectrodeRecord));
+}
+
+void BinaryProblem::addContentToHash(QCryptographicHash &hash) const
+{
+  for (const QPair<SectionType, QByteArray> &sec : serializeSections())
+    if (sec.first != ProgramSection)
+      hash.addData(sec.second);
+
+  // the counts prefix the records so section boundaries stay unambiguous
+  quint64 db_count = dbs.size();
+  hash.addData(reinterpret_cast<const char*>(&db_count), sizeof(db_count));
+  hash.addData(reinterpret_cast<const char*>(dbs.constData()), 
+               db_count * sizeof(DBDotRecord));
+  quint64 elec_count = electrodes.size();
+  hash.addData(reinterpret_cast<const char*>(&elec_count), sizeof(elec_count));
+  hash.addData(reinterpret_cast<const char*>(electrodes.constData()), 
+               elec_count * sizeof(ElectrodeRecord));
+}
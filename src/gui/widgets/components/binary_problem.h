@@ -0,0 +1,124 @@
+// @file:     binary_problem.h
+// @author:   agent
+// @created:  2026.10.17
+// @license:  GNU LGPL v3
+//
+// @desc:     Flat binary simulation problem handed to plugins through shared
+//            memory as an alternative to the XML problem file.
+
+#ifndef _COMP_BINARY_PROBLEM_H_
+#define _COMP_BINARY_PROBLEM_H_
+
+#include <QtCore>
+
+namespace comp{
+
+  //! Flat binary representation of a simulation problem which plugins read
+  //! in place (through SiQADConnector) instead of parsing the XML problem
+  //! file. Items are collected with the add functions and serialized into a
+  //! single buffer, usually a shared memory segment.
+  //!
+  //! The layout follows the binary result file: all values are little-endian,
+  //! a 16 byte header (char magic[4] = "SQPB", quint32 version, quint32
+  //! section count, quint32 reserved) is followed by the section table (one
+  //! {quint32 type, quint32 reserved, quint64 offset, quint64 size} entry per
+  //! section) and the 8 byte aligned sections:
+  //!   program, sim_params: quint32 count, count * {string key, string value}
+  //!   layers:     quint32 count, count * {string name, string type, string
+  //!               role, float zoffset, float zheight}
+  //!   aggregates: quint32 count, quint32 reserved, count * {qint32 parent} in
+  //!               pre-order, -1 for the top level
+  //!   dbdots:     quint64 count, count * DBDotRecord
+  //!   electrodes: quint64 count, count * ElectrodeRecord
+  //! Strings are a quint32 byte count followed by the UTF-8 bytes.
+  class BinaryProblem
+  {
+  public:
+
+    //! Section types.
+    enum SectionType{ProgramSection=1, SimParamsSection=2, LayersSection=3,
+      AggregatesSection=4, DBDotsSection=5, ElectrodesSection=6};
+
+    //! DB record in the dbdots section.
+    struct DBDotRecord
+    {
+      float x;
+      float y;
+      qint32 n;
+      qint32 m;
+      qint32 l;
+      qint32 aggregate;   // containing aggregate index, -1 for the top level
+    };
+
+    //! Electrode record in the electrodes section.
+    struct ElectrodeRecord
+    {
+      qint32 layer_id;
+      qint32 electrode_type;  // 0 for fixed, 1 for clocked
+      qint32 net;
+      qint32 aggregate;       // containing aggregate index, -1 for the top level
+      double x1, y1, x2, y2;  // in angstroms
+      double potential;
+      double phase;
+      double angle;
+      double pixel_per_angstrom;
+    };
+
+    //! Layer entry in the layers section.
+    struct LayerEntry
+    {
+      QString name;
+      QString type;
+      QString role;
+      float zoffset;
+      float zheight;
+    };
+
+    //! Set a program property.
+    void setProgramProperty(const QString &key, const QString &val) {program_props.insert(key, val);}
+
+    //! Replace all simulation parameters.
+    void setSimParams(const QMap<QString, QString> &params) {sim_params = params;}
+
+    //! Append a layer, layer IDs are intrinsic to the layer order.
+    void addLayer(const LayerEntry &layer) {layers.append(layer);}
+
+    //! Append an aggregate contained in the given parent aggregate (-1 for
+    //! the top level) and return its index.
+    int addAggregate(int parent) {aggregates.append(parent); return aggregates.size() - 1;}
+
+    //! Append a DB.
+    void addDBDot(const DBDotRecord &db) {dbs.append(db);}
+
+    //! Append an electrode.
+    void addElectrode(const ElectrodeRecord &elec) {electrodes.append(elec);}
+
+    //! Return the number of DBs.
+    int dbCount() const {return dbs.size();}
+
+    //! Return the serialized size in bytes.
+    quint64 serializedSize() const;
+
+    //! Serialize the problem into dest, which must hold serializedSize() bytes.
+    void serialize(uchar *dest) const;
+
+    //! Add the serialized sections other than the program section, which 
+    //! holds the export date, to the hash.
+    void addContentToHash(QCryptographicHash &hash) const;
+
+  private:
+
+    //! Return the serialized sections in section table order.
+    QList<QPair<SectionType, QByteArray>> serializeSections() const;
+
+    QMap<QString, QString> program_props;   // program properties
+    QMap<QString, QString> sim_params;      // simulation parameters
+    QList<LayerEntry> layers;               // layers in layer ID order
+    QVector<qint32> aggregates;             // parent of each aggregate
+    QVector<DBDotRecord> dbs;               // DBs
+    QVector<ElectrodeRecord> electrodes;    // electrodes
+  };
+
+} // end of comp namespace
+
+#endif
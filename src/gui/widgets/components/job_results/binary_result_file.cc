@@ -0,0 +1,152 @@
+/** @file:     binary_result_file.cc
+ *  @author:   agent
+ *  @created:  2026.10.17
+ *  @license:  GNU LGPL v3
+ *
+ *  @desc:     Memory-mapped access to binary plugin result files and shared
+ *             memory result segments.
+ */
+
+#include "binary_result_file.h"
+
+using namespace comp;
+
+typedef comp::BinaryResultFile BRF;
+
+static const char binary_result_magic[4] = {'S', 'Q', 'R', 'B'};
+static const quint32 binary_result_version = 1;
+
+BRF::BinaryResultFile(const QString &path)
+  : source(path), file(path)
+{
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+  qWarning() << "Binary result files are only supported on little-endian hosts.";
+  return;
+#endif
+
+  if (!file.open(QFile::ReadOnly)) {
+    qWarning() << QObject::tr("Error when opening binary result file %1: %2")
+      .arg(path).arg(file.errorString());
+    return;
+  }
+
+  quint64 file_size = file.size();
+  if (file_size < 16) {
+    qWarning() << QObject::tr("Binary result file %1 is truncated.").arg(path);
+    return;
+  }
+
+  uchar *mapped = file.map(0, file_size);
+  if (mapped == nullptr) {
+    qWarning() << QObject::tr("Failed to map binary result file %1: %2")
+      .arg(path).arg(file.errorString());
+    return;
+  }
+
+  if (!readSectionTable(mapped, file_size)) {
+    file.unmap(mapped);
+    return;
+  }
+  data = mapped;
+}
+
+BRF::BinaryResultFile(SharedMemorySegment *segment)
+  : source(segment->name()), segment(segment)
+{
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+  qWarning() << "Binary result segments are only supported on little-endian hosts.";
+  return;
+#endif
+
+  if (segment->size() < 16) {
+    qWarning() << QObject::tr("Binary result segment %1 is truncated.").arg(source);
+    return;
+  }
+
+  if (readSectionTable(segment->data(), segment->size()))
+    data = segment->data();
+}
+
+BRF::~BinaryResultFile()
+{
+  if (segment != nullptr)
+    delete segment;
+  else if (data != nullptr)
+    file.unmap(data);
+}
+
+bool BRF::readSectionTable(const uchar *mapped, quint64 size)
+{
+  const quint32 *header = reinterpret_cast<const quint32*>(mapped);
+  if (memcmp(mapped, binary_result_magic, 4) != 0
+      || header[1] != binary_result_version) {
+    qWarning() << QObject::tr("Unsupported binary result file %1.").arg(source);
+    return false;
+  }
+
+  // read the section table and make sure every section lies within the file
+  quint32 section_count = header[2];
+  if (16 + quint64(section_count) * 24 > size) {
+    qWarning() << QObject::tr("Binary result file %1 is truncated.").arg(source);
+    return false;
+  }
+  for (quint32 i=0; i<section_count; i++) {
+    const uchar *entry = mapped + 16 + i * 24;
+    quint32 type = *reinterpret_cast<const quint32*>(entry);
+    quint64 offset = *reinterpret_cast<const quint64*>(entry + 8);
+    quint64 sec_size = *reinterpret_cast<const quint64*>(entry + 16);
+    if (offset % 8 != 0 || offset > size || sec_size > size - offset) {
+      qWarning() << QObject::tr("Invalid section %1 in binary result file %2.")
+        .arg(type).arg(source);
+      sections.clear();
+      return false;
+    }
+    sections.insert(type, qMakePair(offset, sec_size));
+  }
+  return true;
+}
+
+bool BRF::isBinaryResultFile(const QString &path)
+{
+  QFile f(path);
+  if (!f.open(QFile::ReadOnly))
+    return false;
+  QByteArray magic = f.read(4);
+  return magic == QByteArray(binary_result_magic, 4);
+}
+
+const uchar *BRF::section(SectionType type, quint64 *size) const
+{
+  if (data == nullptr || !sections.contains(type))
+    return nullptr;
+  QPair<quint64, quint64> sec = sections.value(type);
+  if (size != nullptr)
+    *size = sec.second;
+  return data + sec.first;
+}
+
+const BRF::ElecDistHeader *BRF::elecDist(const ElecDistRecord **records,
+                                         const quint64 **words) const
+{
+  quint64 size;
+  const uchar *sec = section(ElecDistSection, &size);
+  if (sec == nullptr || size < sizeof(ElecDistHeader))
+    return nullptr;
+
+  const ElecDistHeader *header = reinterpret_cast<const ElecDistHeader*>(sec);
+  int bits = (header->state_count == 3) ? 2 : 1;
+  quint64 records_size = quint64(header->config_count) * sizeof(ElecDistRecord);
+  quint64 words_offset = (sizeof(ElecDistHeader) + records_size + 7) / 8 * 8;
+  quint64 words_size = quint64(header->config_count) * header->words_per_config * 8;
+  if ((header->state_count != 2 && header->state_count != 3)
+      || quint64(header->words_per_config) * 64 < quint64(header->db_count) * bits
+      || words_offset + words_size > size) {
+    qWarning() << QObject::tr("Malformed elec_dist section in binary result file %1.")
+      .arg(source);
+    return nullptr;
+  }
+
+  *records = reinterpret_cast<const ElecDistRecord*>(sec + sizeof(ElecDistHeader));
+  *words = reinterpret_cast<const quint64*>(sec + words_offset);
+  return header;
+}
@@ -0,0 +1,116 @@
+/** @file:     binary_result_file.h
+ *  @author:   agent
+ *  @created:  2026.10.17
+ *  @license:  GNU LGPL v3
+ *
+ *  @desc:     Memory-mapped access to binary plugin result files and shared
+ *             memory result segments.
+ */
+
+#ifndef _COMP_BINARY_RESULT_FILE_H_
+#define _COMP_BINARY_RESULT_FILE_H_
+
+#include <QtCore>
+#include "../shared_segment.h"
+
+namespace comp{
+
+  //! Memory-mapped binary result file, an optional alternative to the XML 
+  //! result format for results with many charge configurations or potential
+  //! samples. Job results built from the file refer to the mapped sections 
+  //! directly and hold a shared pointer to the file to keep the mapping alive.
+  //!
+  //! All values are little-endian. The file starts with a 16 byte header
+  //! (char magic[4] = "SQRB", quint32 version, quint32 section count, quint32
+  //! reserved) followed by the section table, one entry per section (quint32 
+  //! type, quint32 reserved, quint64 offset, quint64 size). Sections start at
+  //! 8 byte aligned offsets and contain:
+  //!   physloc:       quint64 count, count * {float x, float y}
+  //!   elec_dist:     quint32 config count, quint32 DB count, quint32 state 
+  //!                  count, quint32 words per config, config count * {float
+  //!                  energy, qint32 count, qint32 physically_valid}, padding
+  //!                  to 8 bytes, then the configs packed into quint64 words
+  //!                  the same way as in ChargeConfigSet (unused bits zero)
+  //!   potential_map: quint64 count, count * {float x, float y, float val}
+  class BinaryResultFile
+  {
+  public:
+
+    //! Section types.
+    enum SectionType{PhysLocSection=1, ElecDistSection=2, PotentialMapSection=3};
+
+    //! Section header of the elec_dist section.
+    struct ElecDistHeader
+    {
+      quint32 config_count;
+      quint32 db_count;
+      quint32 state_count;
+      quint32 words_per_config;
+    };
+
+    //! Per-config record in the elec_dist section.
+    struct ElecDistRecord
+    {
+      float energy;
+      qint32 count;
+      qint32 physically_valid;
+    };
+
+    //! Sample record in the potential_map section.
+    struct PotentialRecord
+    {
+      float x;
+      float y;
+      float val;
+    };
+
+    //! Constructor, opens and maps the file at the given path. Check isValid()
+    //! before use.
+    BinaryResultFile(const QString &path);
+
+    //! Constructor reading the same format from a shared memory segment
+    //! written by the plugin. Takes ownership of the segment. Check isValid()
+    //! before use.
+    BinaryResultFile(SharedMemorySegment *segment);
+
+    //! Destructor, unmaps the file or segment.
+    ~BinaryResultFile();
+
+    //! Return whether the file at the given path starts with the binary 
+    //! result file magic number.
+    static bool isBinaryResultFile(const QString &path);
+
+    //! Return whether the file has been mapped and its section table is sane.
+    bool isValid() const {return data != nullptr;}
+
+    //! Return whether the file contains a section of the given type.
+    bool hasSection(SectionType type) const {return sections.contains(type);}
+
+    //! Return a pointer to the start of the section of the given type and 
+    //! write its size in bytes to size, or nullptr if there is no such section.
+    const uchar *section(SectionType type, quint64 *size=nullptr) const;
+
+    //! Return the elec_dist section header, or nullptr if the section is 
+    //! absent or malformed. Record and config word pointers are written to
+    //! records and words.
+    const ElecDistHeader *elecDist(const ElecDistRecord **records,
+                                   const quint64 **words) const;
+
+  private:
+
+    Q_DISABLE_COPY(BinaryResultFile)
+
+    //! Check the header and read the section table of the mapped contents,
+    //! returns whether they are valid.
+    bool readSectionTable(const uchar *mapped, quint64 size);
+
+    QString source;                 // file path or segment name for messages
+    QFile file;                     // the result file
+    SharedMemorySegment *segment=nullptr; // the result segment if not from a file
+    uchar *data=nullptr;            // mapped file contents
+    QMap<int, QPair<quint64, quint64>> sections;  // offset and size of each section type
+  };
+
+} // end of comp namespace
+
+#endif
@@ -31,3 +31,22 @@ DBLocations::DBLocations(QXmlStreamReader *rs)
     }
   }
 }
+
+DBLocations::DBLocations(const QSharedPointer<const BinaryResultFile> &file)
+  : JobResult(DBLocationsResult)
+{
+  // DB locations are few compared to the other results, copy them out
+  quint64 size;
+  const uchar *sec = file->section(BinaryResultFile::PhysLocSection, &size);
+  if (sec == nullptr || size < sizeof(quint64))
+    return;
+  quint64 count = *reinterpret_cast<const quint64*>(sec);
+  if (count > (size - sizeof(quint64)) / (2 * sizeof(float))) {
+    qWarning() << tr("Malformed physloc section in binary result file.");
+    return;
+  }
+  const float *locs = reinterpret_cast<const float*>(sec + sizeof(quint64));
+  db_locs.reserve(count);
+  for (quint64 i=0; i<count; i++)
+    db_locs.append(QPointF(locs[2*i], locs[2*i+1]));
+}
@@ -12,6 +12,7 @@
 #include <QtWidgets>
 
 #include "job_result.h"
+#include "binary_result_file.h"
 
 namespace comp{
 
@@ -26,6 +27,9 @@ namespace comp{
     //! results are internally sorted in ascending order of electron count.
     DBLocations(QXmlStreamReader *rs);
 
+    //! Constructor taking a mapped binary result file.
+    DBLocations(const QSharedPointer<const BinaryResultFile> &file);
+
     // TODO alternative constructor taking relevant information
     
     //! Destructor.
@@ -6,6 +6,8 @@
  *  @desc:     Stores electron configurations of DB layouts.
  */
 
+#include <algorithm>
+
 #include "electron_config_set.h"
 
 using namespace comp;
@@ -18,6 +20,53 @@ ECS::ChargeConfigSet(QXmlStreamReader *rs)
   readFromXMLStream(rs);
 }
 
+ECS::ChargeConfigSet(const QSharedPointer<const BinaryResultFile> &file)
+  : JobResult(ChargeConfigsResult)
+{
+  const BinaryResultFile::ElecDistRecord *records;
+  const quint64 *words;
+  const BinaryResultFile::ElecDistHeader *header = file->elecDist(&records, &words);
+  if (header == nullptr)
+    return;
+
+  mapped_file = file;
+  arena_data = words;
+  arena_word_count = header->config_count * header->words_per_config;
+
+  // derive per-config information, charge counts are taken straight from the
+  // packed words
+  const quint64 dbm_mask = (header->state_count == 3) ? 0xAAAAAAAAAAAAAAAAull : ~0ull;
+  const quint64 db0_mask = 0x5555555555555555ull;
+  config_infos.resize(header->config_count);
+  for (int i=0; i<config_infos.size(); i++) {
+    ConfigInfo &info = config_infos[i];
+    info.energy = records[i].energy;
+    info.config_occ = records[i].count;
+    info.is_valid = records[i].physically_valid;
+    info.state_count = header->state_count;
+    info.db_count = header->db_count;
+    info.offset = i * header->words_per_config;
+    for (quint32 w=0; w<header->words_per_config; w++) {
+      quint64 word = arena_data[info.offset + w];
+      info.dbm_count += qPopulationCount(word & dbm_mask);
+      if (header->state_count == 3)
+        info.db0_count += qPopulationCount(word & db0_mask);
+    }
+    if (header->state_count == 3)
+      info.dbp_count = info.db_count - info.dbm_count - info.db0_count;
+    else
+      info.db0_count = info.db_count - info.dbm_count;
+
+    // stats bookkeeping
+    net_charge_occ[info.netNegCharge()] += info.config_occ;
+    total_config_count += info.config_occ;
+  }
+
+  valid_configs.resize(config_infos.size());
+  for (int i=0; i<config_infos.size(); i++)
+    valid_configs.setBit(i, config_infos.at(i).is_valid == 1);
+}
+
 void ECS::readFromXMLStream(QXmlStreamReader *rs)
 {
   auto unrecognizedXMLElement = [](QXmlStreamReader &rs)
@@ -27,103 +76,333 @@ void ECS::readFromXMLStream(QXmlStreamReader *rs)
     rs.skipCurrentElement();
   };
 
-  // read from stream
+  // read from stream, packing configs in batches so the unpacked form of 
+  // the whole set never has to be held in memory
+  const int batch_size = 4096;
   QList<ChargeConfig> charge_configs_read;  // read charge configs
   while (rs->readNextStartElement()) {
     if (rs->name() == "dist") {
       ChargeConfig charge_config;
-
-      for (QXmlStreamAttribute &attr : rs->attributes()) {
-        if (attr.name().toString() == QLatin1String("energy")) {
-          charge_config.energy = attr.value().toFloat();
-        } else if (attr.name().toString() == QLatin1String("count")) {
-          charge_config.config_occ = attr.value().toInt();
-        } else if (attr.name().toString() == QLatin1String("physically_valid")) {
-          charge_config.is_valid = attr.value().toInt();
-        } else if (attr.name().toString() == QLatin1String("state_count")) {
-          charge_config.state_count = attr.value().toInt();
-        }
-      }
-      if (charge_config.state_count != 2 && charge_config.state_count != 3) {
-        qCritical() << "Unrecognized state count " << charge_config.state_count;
+      if (!readChargeConfig(rs, charge_config))
         throw;
+      charge_configs_read.append(charge_config);
+      if (charge_configs_read.size() >= batch_size) {
+        addChargeConfigs(charge_configs_read);
+        charge_configs_read.clear();
       }
+    } else {
+      unrecognizedXMLElement(*rs);
+    }
+  }
+
+  addChargeConfigs(charge_configs_read);
+}
 
-      QString dist = rs->readElementText();
-
-      // convert string distribution to array of int
-      int neg_charge;
-      for (QString charge_str : dist) {
-        if (charge_config.state_count == 2) {
-          // legacy format where 1=DB- and 0=DB0
-          neg_charge = charge_str.toInt();
-          if (neg_charge == 1) {
-            charge_config.dbm_count++;
-          }
-        } else {
-          // preferred new format
-          if (charge_str == "+") {
-            neg_charge = -1;
-            charge_config.dbp_count++;
-          } else if (charge_str == "0") {
-            neg_charge = 0;
-            charge_config.db0_count++;
-          } else if (charge_str == "-") {
-            neg_charge = 1;
-            charge_config.dbm_count++;
-          } else {
-            qCritical() << "Unrecognized charge string " << charge_str;
-            throw;
-          }
-        }
-        charge_config.config.append(neg_charge);
+bool ECS::readChargeConfig(QXmlStreamReader *rs, ChargeConfig &charge_config)
+{
+  for (QXmlStreamAttribute &attr : rs->attributes()) {
+    if (attr.name().toString() == QLatin1String("energy")) {
+      charge_config.energy = attr.value().toFloat();
+    } else if (attr.name().toString() == QLatin1String("count")) {
+      charge_config.config_occ = attr.value().toInt();
+    } else if (attr.name().toString() == QLatin1String("physically_valid")) {
+      charge_config.is_valid = attr.value().toInt();
+    } else if (attr.name().toString() == QLatin1String("state_count")) {
+      charge_config.state_count = attr.value().toInt();
+    }
+  }
+  if (charge_config.state_count != 2 && charge_config.state_count != 3) {
+    qCritical() << "Unrecognized state count " << charge_config.state_count;
+    return false;
+  }
+
+  QString dist = rs->readElementText();
+
+  // convert string distribution to array of int
+  int neg_charge;
+  for (QString charge_str : dist) {
+    if (charge_config.state_count == 2) {
+      // legacy format where 1=DB- and 0=DB0
+      neg_charge = charge_str.toInt();
+      if (neg_charge == 1) {
+        charge_config.dbm_count++;
+      }
+    } else {
+      // preferred new format
+      if (charge_str == "+") {
+        neg_charge = -1;
+        charge_config.dbp_count++;
+      } else if (charge_str == "0") {
+        neg_charge = 0;
+        charge_config.db0_count++;
+      } else if (charge_str == "-") {
+        neg_charge = 1;
+        charge_config.dbm_count++;
+      } else {
+        qCritical() << "Unrecognized charge string " << charge_str;
+        return false;
       }
+    }
+    charge_config.config.append(neg_charge);
+  }
+  return true;
+}
 
-      charge_configs_read.append(charge_config);
+void ECS::addChargeConfigs(QList<ChargeConfig> configs)
+{
+  // configs that didn't come through here (e.g. mapped from a binary result 
+  // file) have to be hashed before new configs can be merged into them
+  for (; hashed_count<config_infos.size(); hashed_count++)
+    config_lookup.insert(packedHash(config_infos.at(hashed_count)), hashed_count);
 
-      // stats bookkeeping
-      net_charge_occ[charge_config.netNegCharge()] += charge_config.config_occ;
-      total_config_count += charge_config.config_occ;
-      //qDebug() << tr("Distribution: %1, Energy: %2, Count: %3").arg(dist).arg(read_dist.energy).arg(config_count);
+  // pack configs into the arena, merging duplicates into the stored config
+  int first_ind = config_infos.size();
+  for (const ChargeConfig &charge_config : configs) {
+    ConfigInfo info = packChargeConfig(charge_config);
+    uint hash = packedHash(info);
+    int dup_ind = findPackedConfig(info, hash);
+    if (dup_ind != -1) {
+      arena_word_count = info.offset;
+      config_arena.resize(arena_word_count);
+      arena_data = config_arena.constData();
+      config_infos[dup_ind].config_occ += info.config_occ;
+      config_infos[dup_ind].record_count++;
     } else {
-      unrecognizedXMLElement(*rs);
+      config_lookup.insert(hash, config_infos.size());
+      config_infos.append(info);
     }
+
+    // stats bookkeeping
+    net_charge_occ[charge_config.netNegCharge()] += charge_config.config_occ;
+    total_config_count += charge_config.config_occ;
   }
 
-  // sort by energy
-  std::sort(charge_configs_read.begin(), charge_configs_read.end(),
-            [](const ChargeConfig &a, const ChargeConfig &b) -> bool
-            {
-              return a.energy > b.energy;
-            });
+  hashed_count = config_infos.size();
+
+  valid_configs.resize(config_infos.size());
+  for (int i=first_ind; i<config_infos.size(); i++)
+    valid_configs.setBit(i, config_infos.at(i).is_valid == 1);
+}
+
+ECS::ChargeConfig ECS::chargeConfig(int ind) const
+{
+  const ConfigInfo &info = config_infos.at(ind);
+  ChargeConfig charge_config;
+  charge_config.energy = info.energy;
+  charge_config.config_occ = info.config_occ;
+  charge_config.dbm_count = info.dbm_count;
+  charge_config.db0_count = info.db0_count;
+  charge_config.dbp_count = info.dbp_count;
+  charge_config.is_valid = info.is_valid;
+  charge_config.state_count = info.state_count;
+  charge_config.config.reserve(info.db_count);
+  for (int i=0; i<info.db_count; i++)
+    charge_config.config.append(chargeAt(ind, i));
+  return charge_config;
+}
 
-  // insert sorted list to multimap so configs are "binned" by net charge
-  for (ChargeConfig charge_config : charge_configs_read) {
-    charge_configs.insert(charge_config.netNegCharge(), charge_config);
+ECS::IndexRange ECS::configIndices(bool phys_valid_filter, bool all_configs,
+                                   const int &net_charge) const
+{
+  ensureIndices();
+  IndexRange range;
+  const QMap<int, QPair<int, int>> &ranges = phys_valid_filter ? valid_charge_ranges : charge_ranges;
+  range.order = phys_valid_filter ? valid_charge_order : charge_order;
+  if (!phys_valid_filter)
+    range.valid_prefix = charge_valid_prefix;
+  if (all_configs) {
+    range.stop = range.order.size();
+  } else if (ranges.contains(net_charge)) {
+    range.start = ranges.value(net_charge).first;
+    range.stop = ranges.value(net_charge).second;
   }
+  return range;
+}
+
+ECS::IndexRange ECS::energyOrderedIndices(bool phys_valid_filter) const
+{
+  ensureIndices();
+  IndexRange range;
+  range.order = phys_valid_filter ? valid_energy_order : energy_order;
+  if (!phys_valid_filter)
+    range.valid_prefix = energy_valid_prefix;
+  range.stop = range.order.size();
+  return range;
+}
 
-  // TODO the above sorting solution is a short term one, in the future when 
-  // there are more ways to visualize electron config sets (e.g. scatter plot
-  // or histogram) the pre-processing have to be optimized accordingly.
+ECS::IndexRange ECS::degenerateConfigs(int ind) const
+{
+  // configs of equal energy are adjacent in the energy ordering
+  IndexRange range = energyOrderedIndices();
+  float t_energy = config_infos.at(ind).energy;
+  auto lower = std::lower_bound(range.begin(), range.end(), t_energy,
+      [this](int a, float energy) -> bool
+      {
+        return config_infos.at(a).energy < energy;
+      });
+  auto upper = std::upper_bound(lower, range.end(), t_energy,
+      [this](float energy, int b) -> bool
+      {
+        return energy < config_infos.at(b).energy;
+      });
+  range.start = lower - range.order.constData();
+  range.stop = upper - range.order.constData();
+  return range;
+}
 
-  // TODO consider adding deduplication support to SiQADConn
+bool ECS::groundStateEnergy(float &energy, bool phys_valid_filter) const
+{
+  IndexRange range = energyOrderedIndices(phys_valid_filter);
+  if (range.isEmpty())
+    return false;
+  energy = config_infos.at(range.first()).energy;
+  return true;
 }
 
-QList<ECS::ChargeConfig> ECS::degenerateConfigs(const ECS::ChargeConfig &t_config) const
+int ECS::lowestPhysicallyValidInd(const IndexRange &range)
 {
-  QList<ECS::ChargeConfig> degen_configs;
-  for (ECS::ChargeConfig config : charge_configs)
-    if (config.energy == t_config.energy)
-      degen_configs.append(config);
-  return degen_configs;
+  if (range.isEmpty())
+    return -1;
+  if (range.valid_prefix.isEmpty())
+    return 0;   // the ordering only contains valid configs
+
+  // the first valid position is where the valid count starts to exceed the 
+  // count at the start of the range
+  const int *prefix = range.valid_prefix.constData();
+  const int *it = std::upper_bound(prefix + range.start + 1, prefix + range.stop + 1,
+                                   prefix[range.start]);
+  if (it == prefix + range.stop + 1)
+    return -1;
+  return (it - prefix) - 1 - range.start;
 }
 
-int ECS::lowestPhysicallyValidInd(const QList<ChargeConfig> &charge_configs)
+void ECS::ensureIndices() const
 {
-  for (int i=0; i<charge_configs.size(); i++) {
-    if (charge_configs.at(i).is_valid == 1) {
-      return i;
+  if (indexed_count == config_infos.size())
+    return;
+
+  auto energyLess = [this](int a, int b) -> bool
+  {
+    return config_infos.at(a).energy < config_infos.at(b).energy;
+  };
+  auto chargeLess = [this](int a, int b) -> bool
+  {
+    int charge_a = config_infos.at(a).netNegCharge();
+    int charge_b = config_infos.at(b).netNegCharge();
+    if (charge_a != charge_b)
+      return charge_a < charge_b;
+    return config_infos.at(a).energy < config_infos.at(b).energy;
+  };
+
+  // sort the new configs and merge them into the main orderings
+  QVector<int> new_inds;
+  new_inds.reserve(config_infos.size() - indexed_count);
+  for (int i=indexed_count; i<config_infos.size(); i++)
+    new_inds.append(i);
+  int mid = energy_order.size();
+  std::stable_sort(new_inds.begin(), new_inds.end(), energyLess);
+  energy_order.append(new_inds);
+  std::inplace_merge(energy_order.begin(), energy_order.begin() + mid,
+                     energy_order.end(), energyLess);
+  std::stable_sort(new_inds.begin(), new_inds.end(), chargeLess);
+  charge_order.append(new_inds);
+  std::inplace_merge(charge_order.begin(), charge_order.begin() + mid,
+                     charge_order.end(), chargeLess);
+  indexed_count = config_infos.size();
+
+  // derive the valid-only orderings, valid prefix counts and net charge bins
+  auto derive = [this](const QVector<int> &order, QVector<int> &valid_order,
+                       QVector<int> &valid_prefix)
+  {
+    valid_order.clear();
+    valid_prefix.resize(order.size() + 1);
+    valid_prefix[0] = 0;
+    for (int i=0; i<order.size(); i++) {
+      bool valid = valid_configs.testBit(order.at(i));
+      if (valid)
+        valid_order.append(order.at(i));
+      valid_prefix[i+1] = valid_prefix.at(i) + (valid ? 1 : 0);
     }
+  };
+  derive(energy_order, valid_energy_order, energy_valid_prefix);
+  derive(charge_order, valid_charge_order, charge_valid_prefix);
+
+  auto binRanges = [this](const QVector<int> &order, QMap<int, QPair<int, int>> &ranges)
+  {
+    // the ordering is sorted by net charge so each bin is contiguous
+    ranges.clear();
+    int bin_start = 0;
+    for (int i=1; i<=order.size(); i++) {
+      int net_charge = config_infos.at(order.at(i-1)).netNegCharge();
+      if (i == order.size() || config_infos.at(order.at(i)).netNegCharge() != net_charge) {
+        ranges.insert(net_charge, qMakePair(bin_start, i));
+        bin_start = i;
+      }
+    }
+  };
+  binRanges(charge_order, charge_ranges);
+  binRanges(valid_charge_order, valid_charge_ranges);
+}
+
+void ECS::detachArena()
+{
+  if (mapped_file.isNull())
+    return;
+  config_arena.resize(arena_word_count);
+  memcpy(config_arena.data(), arena_data, arena_word_count * sizeof(quint64));
+  arena_data = config_arena.constData();
+  mapped_file.clear();
+}
+
+uint ECS::packedHash(const ConfigInfo &info) const
+{
+  int bits = (info.state_count == 3) ? 2 : 1;
+  int word_count = (info.db_count * bits + 63) / 64;
+  return qHashBits(arena_data + info.offset, word_count * sizeof(quint64),
+                   qHash(info.db_count, info.state_count));
+}
+
+int ECS::findPackedConfig(const ConfigInfo &info, uint hash) const
+{
+  int bits = (info.state_count == 3) ? 2 : 1;
+  int word_count = (info.db_count * bits + 63) / 64;
+  auto it = config_lookup.constFind(hash);
+  for (; it != config_lookup.constEnd() && it.key() == hash; ++it) {
+    const ConfigInfo &other = config_infos.at(it.value());
+    if (other.db_count == info.db_count && other.state_count == info.state_count
+        && memcmp(arena_data + other.offset, arena_data + info.offset,
+                  word_count * sizeof(quint64)) == 0)
+      return it.value();
   }
   return -1;
 }
+
+ECS::ConfigInfo ECS::packChargeConfig(const ChargeConfig &charge_config)
+{
+  detachArena();
+
+  ConfigInfo info;
+  info.energy = charge_config.energy;
+  info.config_occ = charge_config.config_occ;
+  info.dbm_count = charge_config.dbm_count;
+  info.db0_count = charge_config.db0_count;
+  info.dbp_count = charge_config.dbp_count;
+  info.is_valid = charge_config.is_valid;
+  info.state_count = charge_config.state_count;
+  info.db_count = charge_config.config.length();
+  info.offset = arena_word_count;
+
+  // 2 bits per DB storing the negative charge + 1 for the 3-state format, 
+  // 1 bit per DB for the legacy format; bit widths divide 64 so no DB 
+  // straddles two words
+  int bits = (info.state_count == 3) ? 2 : 1;
+  arena_word_count += (info.db_count * bits + 63) / 64;
+  config_arena.resize(arena_word_count);
+  for (int i=0; i<info.db_count; i++) {
+    int code = charge_config.config.at(i) + ((info.state_count == 3) ? 1 : 0);
+    int bit = i * bits;
+    config_arena[info.offset + bit / 64] |= quint64(code) << (bit % 64);
+  }
+  arena_data = config_arena.constData();
+  return info;
+}
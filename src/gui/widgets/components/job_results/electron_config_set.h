@@ -12,6 +12,7 @@
 #include <QtWidgets>
 
 #include "job_result.h"
+#include "binary_result_file.h"
 
 namespace comp{
 
@@ -23,7 +24,9 @@ namespace comp{
   public:
 
 
-    //! Charge configurations (-1 for DB-, 0 for DB0, +1 for DB+)
+    //! Charge configurations (-1 for DB+, 0 for DB0, +1 for DB-) in unpacked
+    //! form, used for reading and for handing out single configurations. The
+    //! set itself stores configurations packed, see ConfigInfo.
     struct ChargeConfig
     {
       QList<int> config;
@@ -35,7 +38,7 @@ namespace comp{
       int state_count=2;    // number of supported states, if 2 then 0=DB0 and 1=DB-; if 3 then {+,0,-} = {DB+, DB0, DB0}
       int config_occ=0;     // number of occurances of this config
 
-      int netNegCharge() {return dbm_count - dbp_count;}
+      int netNegCharge() const {return dbm_count - dbp_count;}
 
       bool operator == (const ChargeConfig &other) const {
         if (config.length() != other.config.length()
@@ -48,6 +51,45 @@ namespace comp{
       }
     };
 
+    //! Everything about a stored configuration except for the charge states,
+    //! which are packed into the configuration arena at offset (2 bits per DB
+    //! for the 3-state format, 1 bit per DB for the legacy format).
+    struct ConfigInfo
+    {
+      float energy=0;       // energy of this configuration
+      int config_occ=0;     // number of occurances of this config
+      int dbm_count=0;      // number of DB- sites in this config
+      int db0_count=0;      // number of DB0 sites in this config
+      int dbp_count=0;      // number of DB+ sites in this config
+      int offset=0;         // word offset of the packed config in the arena
+      int db_count=0;       // number of DBs in this config
+      int record_count=1;   // number of result records merged into this config
+      qint8 is_valid=-1;    // is physically valid, -1 for unknown (not provided)
+      qint8 state_count=2;  // number of supported states
+
+      int netNegCharge() const {return dbm_count - dbp_count;}
+    };
+
+    //! A range of config indices within one of the set's orderings. Holds a
+    //! shared reference to the ordering, so no indices are copied and the 
+    //! range stays usable after the set has been extended.
+    struct IndexRange
+    {
+      QVector<int> order;         // the ordering this range is part of
+      QVector<int> valid_prefix;  // valid configs before each position of order, empty if order only holds valid configs
+      int start=0;                // first position of the range in order
+      int stop=0;                 // one past the last position of the range in order
+
+      int size() const {return stop - start;}
+      int length() const {return size();}
+      bool isEmpty() const {return start == stop;}
+      int at(int i) const {return order.at(start + i);}
+      int first() const {return order.at(start);}
+      int last() const {return order.at(stop - 1);}
+      const int *begin() const {return order.constData() + start;}
+      const int *end() const {return order.constData() + stop;}
+    };
+
     //! Empty constructor.
     ChargeConfigSet() : JobResult(ChargeConfigsResult) {};
 
@@ -55,6 +97,10 @@ namespace comp{
     //! results are internally sorted in ascending order of charge count.
     ChargeConfigSet(QXmlStreamReader *rs);
 
+    //! Constructor taking a mapped binary result file. The packed configs 
+    //! are used in place, only per-config information is built at load time.
+    ChargeConfigSet(const QSharedPointer<const BinaryResultFile> &file);
+
     // TODO alternative constructor taking relevant information
     
     //! Destructor.
@@ -63,8 +109,21 @@ namespace comp{
     //! Read charge config sets from XML stream.
     void readFromXMLStream(QXmlStreamReader *rs);
 
+    //! Read a single charge config from the dist element the stream reader is
+    //! currently at. Returns false if the element is malformed.
+    static bool readChargeConfig(QXmlStreamReader *rs, ChargeConfig &charge_config);
+
+    //! Add charge configurations to this set, keeping each net charge bin 
+    //! sorted by energy. Used for the initial read as well as for results 
+    //! streamed in while the plugin is still running. Configs with the same
+    //! charges as a stored config are merged into it by summing config_occ.
+    void addChargeConfigs(QList<ChargeConfig> configs);
+
     //! Return whether this config set is empty.
-    bool isEmpty() {return charge_configs.isEmpty();}
+    bool isEmpty() const {return config_infos.isEmpty();}
+
+    //! Return the number of stored charge configurations.
+    int configCount() const {return config_infos.size();}
 
     //! Return the order of DB physical locations. TODO what unit does SiQADConn return?
     QList<QPointF> dbPhysicalLocations() {return phys_locs;}
@@ -93,48 +152,102 @@ namespace comp{
     }
 
     //! Return all available net charges.
-    QList<int> netCharges() const {return charge_configs.uniqueKeys();}
-
-    //! Return charge configurations with the specified net charge.
-    //! If all_configs is set to true, charge_count is ignored and all configs
-    //! are returned. Otherwise, only configs with the specified charge_count
-    //! are returned.
-    QList<ChargeConfig> chargeConfigs(bool phys_valid_filter=false,
-                                      bool all_configs=true,
-                                      const int &net_charge=-1) const
-    {
-      QList<ChargeConfig> configs = all_configs ? charge_configs.values() : charge_configs.values(net_charge);
-      if (configs.size() > 0 && phys_valid_filter)
-        physicallyValidFilter(configs);
-      return configs;
-    }
+    QList<int> netCharges() const {return net_charge_occ.keys();}
+
+
+    // INDEX-BASED ACCESS
+
+    //! Return the information of the config at the given index.
+    const ConfigInfo &configInfo(int ind) const {return config_infos.at(ind);}
+
+    //! Return the energy of the config at the given index.
+    float energy(int ind) const {return config_infos.at(ind).energy;}
 
-    //! Filter out physically invalid states in the provided list reference.
-    void physicallyValidFilter(QList<ChargeConfig> &configs) const
+    //! Return whether the config at the given index is physically valid.
+    bool isPhysicallyValid(int ind) const {return valid_configs.testBit(ind);}
+
+    //! Return the negative charge (-1 for DB+, 0 for DB0, +1 for DB-) of the
+    //! given DB in the config at the given index.
+    int chargeAt(int ind, int db_ind) const
     {
-      QList<ChargeConfig>::iterator it = configs.begin();
-      while (it != configs.end()) {
-        if ((*it).is_valid != 1)
-          it = configs.erase(it);
-        else
-          ++it;
-      }
+      const ConfigInfo &info = config_infos.at(ind);
+      int bits = (info.state_count == 3) ? 2 : 1;
+      int bit = db_ind * bits;
+      int code = (arena_data[info.offset + bit / 64] >> (bit % 64)) & ((1 << bits) - 1);
+      return (info.state_count == 3) ? code - 1 : code;
     }
 
-    //! Return degenerate states of the given charge configuration including
-    //! the given config.
-    QList<ChargeConfig> degenerateConfigs(const ChargeConfig &config) const;
+    //! Return the unpacked config at the given index.
+    ChargeConfig chargeConfig(int ind) const;
+
+    //! Return indices of charge configurations, ordered by ascending net 
+    //! charge and then by ascending energy. If all_configs is set to true, 
+    //! net_charge is ignored and all configs are returned. Otherwise, only 
+    //! configs with the specified net_charge are returned.
+    IndexRange configIndices(bool phys_valid_filter=false,
+                             bool all_configs=true,
+                             const int &net_charge=-1) const;
+
+    //! Return indices of all charge configurations ordered by ascending 
+    //! energy.
+    IndexRange energyOrderedIndices(bool phys_valid_filter=false) const;
 
-    //! Return the index to the lowest energy state which is physically valid 
-    //! in the given list of charge configs. If there is no physically valid
-    //! index, return -1.
-    static int lowestPhysicallyValidInd(const QList<ChargeConfig> &charge_configs);
+    //! Return indices of degenerate states of the config at the given index,
+    //! including the given config.
+    IndexRange degenerateConfigs(int ind) const;
+
+    //! Write the lowest energy among the stored charge configurations to 
+    //! energy, only considering physically valid configurations if 
+    //! phys_valid_filter is set. Returns false if no such config exists.
+    bool groundStateEnergy(float &energy, bool phys_valid_filter=true) const;
+
+    //! Return the position of the first physically valid state in the given
+    //! range, which is the lowest energy one if the range has a single net 
+    //! charge or is energy ordered. If there is no physically valid config,
+    //! return -1.
+    static int lowestPhysicallyValidInd(const IndexRange &range);
 
   private:
 
-    //QList<ChargeConfig> charge_configs;   // charge configurations
+    //! Pack the given config into the arena and return its information.
+    ConfigInfo packChargeConfig(const ChargeConfig &charge_config);
+
+    //! Merge configs added since the last query into the orderings and 
+    //! rebuild the derived orderings. Indices are built lazily so configs
+    //! added in batches are only sorted once.
+    void ensureIndices() const;
+
+    //! Copy configs referring to a mapped file into the owned arena so more
+    //! configs can be added.
+    void detachArena();
+
+    //! Return the hash of the packed charges of the given config.
+    uint packedHash(const ConfigInfo &info) const;
+
+    //! Return the index of a stored config with the same charges as the given
+    //! packed config of the given hash, or -1 if there is none.
+    int findPackedConfig(const ConfigInfo &info, uint hash) const;
+
     QList<QPointF> phys_locs;                     // physical location of DBs
-    QMultiMap<int, ChargeConfig> charge_configs;  // charge configurations with net charge as key
+    QVector<ConfigInfo> config_infos;             // per-config information
+    QVector<quint64> config_arena;                // packed charge states of all configs
+    const quint64 *arena_data=nullptr;            // config_arena or the mapped file's configs
+    int arena_word_count=0;                       // number of words at arena_data
+    QSharedPointer<const BinaryResultFile> mapped_file; // keeps mapped configs alive
+    QBitArray valid_configs;                      // physically valid configs
+    QMultiHash<uint, int> config_lookup;          // packed charge hash to config indices
+    int hashed_count=0;                           // number of configs in config_lookup
+
+    // indices of the configs, built by ensureIndices()
+    mutable int indexed_count=0;                  // number of configs covered by the indices
+    mutable QVector<int> energy_order;            // all configs by ascending energy
+    mutable QVector<int> charge_order;            // all configs by net charge, then energy
+    mutable QVector<int> valid_energy_order;      // physically valid configs by ascending energy
+    mutable QVector<int> valid_charge_order;      // physically valid configs by net charge, then energy
+    mutable QVector<int> energy_valid_prefix;     // valid configs before each position of energy_order
+    mutable QVector<int> charge_valid_prefix;     // valid configs before each position of charge_order
+    mutable QMap<int, QPair<int, int>> charge_ranges;       // net charge bins in charge_order
+    mutable QMap<int, QPair<int, int>> valid_charge_ranges; // net charge bins in valid_charge_order
     QMap<int, int> net_charge_occ;                // the accumulated occurances of each net charge
     int total_config_count=0;                     // total number of charge configurations (duplicates counted)
   };
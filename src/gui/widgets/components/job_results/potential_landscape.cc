@@ -6,10 +6,39 @@
  *  @desc:     Stores DB locations.
  */
 
+#include <algorithm>
+#include <numeric>
+#include <QtConcurrent>
+
 #include "potential_landscape.h"
 
 using namespace comp;
 
+// coarsest pyramid level that is still worth keeping
+static const int raster_min_size = 64;
+
+// diverging colormap, blue for negative, white for zero and red for positive
+// potentials, saturating at max_abs
+static QRgb potentialColor(float val, float max_abs)
+{
+  float t = (max_abs > 0) ? qBound(-1.f, val / max_abs, 1.f) : 0.f;
+  int fade = 255 - qRound(255 * qAbs(t));
+  return (t < 0) ? qRgb(fade, fade, 255) : qRgb(255, fade, fade);
+}
+
+// whether sorted distinct coordinates are evenly spaced, allowing for the
+// rounding of coordinates written as text
+static bool evenlySpaced(const QVector<float> &coords)
+{
+  if (coords.size() < 3)
+    return true;
+  float step = (coords.last() - coords.first()) / (coords.size() - 1);
+  for (int i=1; i<coords.size(); i++)
+    if (qAbs(coords[i] - coords[i-1] - step) > 1e-3f * step)
+      return false;
+  return true;
+}
+
 PotentialLandscape::PotentialLandscape(QXmlStreamReader *rs, const QString &result_dir_path)
   : JobResult(PotentialLandscapeResult)
 {
@@ -22,18 +51,44 @@ PotentialLandscape::PotentialLandscape(QXmlStreamReader *rs, const QString &resu
 
   while (rs->readNextStartElement()) {
     if (rs->name() == "potential_val") {
-      QVector<float> potentials_vec;
-      float x = rs->attributes().value("x").toFloat();
-      float y = rs->attributes().value("y").toFloat();
-      float pot_val = rs->attributes().value("val").toFloat();
-      potentials_vec.append({x, y, pot_val});
-      potential_vals.append(potentials_vec);
+      PotentialSample sample;
+      sample.x = rs->attributes().value("x").toFloat();
+      sample.y = rs->attributes().value("y").toFloat();
+      sample.val = rs->attributes().value("val").toFloat();
+      owned_samples.append(sample);
       rs->skipCurrentElement();
     } else {
       unrecognizedXMLElement(*rs);
     }
   }
+  samples = owned_samples.constData();
+  sample_count = owned_samples.size();
+
+  findPlotFiles(result_dir_path);
+}
+
+PotentialLandscape::PotentialLandscape(const QSharedPointer<const BinaryResultFile> &file,
+                                       const QString &result_dir_path)
+  : JobResult(PotentialLandscapeResult)
+{
+  quint64 size;
+  const uchar *sec = file->section(BinaryResultFile::PotentialMapSection, &size);
+  if (sec != nullptr && size >= sizeof(quint64)) {
+    quint64 count = *reinterpret_cast<const quint64*>(sec);
+    if (count <= (size - sizeof(quint64)) / sizeof(PotentialSample)) {
+      mapped_file = file;
+      samples = reinterpret_cast<const PotentialSample*>(sec + sizeof(quint64));
+      sample_count = count;
+    } else {
+      qWarning() << tr("Malformed potential_map section in binary result file.");
+    }
+  }
+
+  findPlotFiles(result_dir_path);
+}
 
+void PotentialLandscape::findPlotFiles(const QString &result_dir_path)
+{
   // hacky way to get image/animation paths
   // TODO future proper implementation should have PoisSolver pass paths through
   // SiQADConn
@@ -48,3 +103,87 @@ PotentialLandscape::PotentialLandscape(QXmlStreamReader *rs, const QString &resu
   if (result_dir.exists(plot_legend_file_name))
     plot_legend_path = result_dir.absoluteFilePath(plot_legend_file_name);
 }
+
+QVector<QImage> PotentialLandscape::rasterPyramid() const
+{
+  buildRaster();
+  return raster_pyramid;
+}
+
+QRectF PotentialLandscape::rasterBounds() const
+{
+  buildRaster();
+  return raster_bounds;
+}
+
+void PotentialLandscape::buildRaster() const
+{
+  if (raster_built)
+    return;
+  raster_built = true;
+  if (sample_count == 0)
+    return;
+
+  // the grid lines are the distinct sample coordinates
+  QVector<float> xs(sample_count), ys(sample_count);
+  for (int i=0; i<sample_count; i++) {
+    xs[i] = samples[i].x;
+    ys[i] = samples[i].y;
+  }
+  std::sort(xs.begin(), xs.end());
+  xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+  std::sort(ys.begin(), ys.end());
+  ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+  if (qint64(xs.size()) * ys.size() != sample_count
+      || !evenlySpaced(xs) || !evenlySpaced(ys)) {
+    qWarning() << tr("Potential samples don't form a regular grid, not rasterizing.");
+    return;
+  }
+  const int nx = xs.size();
+  const int ny = ys.size();
+
+  // place the samples on the grid, scattered samples whose coordinate counts
+  // happen to multiply up leave some grid points empty
+  QVector<float> grid(sample_count);
+  QBitArray filled(sample_count);
+  float max_abs = 0;
+  for (int i=0; i<sample_count; i++) {
+    int ix = std::lower_bound(xs.constBegin(), xs.constEnd(), samples[i].x) - xs.constBegin();
+    int iy = std::lower_bound(ys.constBegin(), ys.constEnd(), samples[i].y) - ys.constBegin();
+    if (filled.testBit(iy * nx + ix)) {
+      qWarning() << tr("Potential samples don't form a regular grid, not rasterizing.");
+      return;
+    }
+    filled.setBit(iy * nx + ix);
+    grid[iy * nx + ix] = samples[i].val;
+    max_abs = qMax(max_abs, qAbs(samples[i].val));
+  }
+
+  // colormap the rows in parallel, scan lines are taken from bits() up front
+  // as scanLine() isn't safe to call concurrently
+  QImage image(nx, ny, QImage::Format_RGB32);
+  uchar *bits = image.bits();
+  const int bytes_per_line = image.bytesPerLine();
+  QVector<int> rows(ny);
+  std::iota(rows.begin(), rows.end(), 0);
+  QtConcurrent::blockingMap(rows, [&](const int &row)
+  {
+    QRgb *line = reinterpret_cast<QRgb*>(bits + row * bytes_per_line);
+    const float *vals = grid.constData() + row * nx;
+    for (int ix=0; ix<nx; ix++)
+      line[ix] = potentialColor(vals[ix], max_abs);
+  });
+
+  // halve the resolution down to the coarsest level worth keeping
+  raster_pyramid.append(image);
+  while (qMax(image.width(), image.height()) > raster_min_size) {
+    image = image.scaled(qMax(1, image.width() / 2), qMax(1, image.height() / 2),
+                         Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    raster_pyramid.append(image);
+  }
+
+  // extend the bounds by half a grid spacing so pixels center on samples
+  qreal dx = (nx > 1) ? (xs.last() - xs.first()) / (nx - 1) : 1;
+  qreal dy = (ny > 1) ? (ys.last() - ys.first()) / (ny - 1) : 1;
+  raster_bounds = QRectF(xs.first() - dx / 2, ys.first() - dy / 2, nx * dx, ny * dy);
+}
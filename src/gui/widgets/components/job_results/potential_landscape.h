@@ -12,6 +12,7 @@
 #include <QtWidgets>
 
 #include "job_result.h"
+#include "binary_result_file.h"
 
 namespace comp{
 
@@ -25,20 +26,45 @@ namespace comp{
     //! Empty constructor.
     PotentialLandscape() : JobResult(PotentialLandscapeResult) {};
 
+    //! A potential sample at a physical location.
+    typedef BinaryResultFile::PotentialRecord PotentialSample;
+
     //! Constructor taking a QXmlStreamReader to read the results directly.
     PotentialLandscape(QXmlStreamReader *rs, const QString &result_dir_path);
 
+    //! Constructor taking a mapped binary result file, the samples are used
+    //! in place.
+    PotentialLandscape(const QSharedPointer<const BinaryResultFile> &file,
+                       const QString &result_dir_path);
+
     // TODO alternative constructor taking relevant information
     
     //! Destructor.
     ~PotentialLandscape() {};
 
-    //! Return a list of vector of potentials (TODO change to struct).
+    //! Return the number of potential samples.
     //! TODO add z-height specification
-    QList<QVector<float>> potentials() const {return potential_vals;}
+    int sampleCount() const {return sample_count;}
+
+    //! Return the potential sample at the given index.
+    const PotentialSample &sample(int ind) const {return samples[ind];}
+
+    //! Return a pointer to all potential samples.
+    const PotentialSample *sampleData() const {return samples;}
 
     // TODO in the future, store 3D result and let users choose which slice to show
 
+    //! Return the colormapped raster of the potential samples as a pyramid,
+    //! the first image holding one pixel per sample and each following one
+    //! half the resolution of the previous. The pyramid is built on the first
+    //! call and cached. Returns an empty list if the samples don't form a
+    //! rectangular grid.
+    QVector<QImage> rasterPyramid() const;
+
+    //! Return the physical area covered by the raster in angstrom, each pixel
+    //! being centered on its sample.
+    QRectF rasterBounds() const;
+
     //! Return the path to the static image plot.
     QString staticPlotPath() {return static_plot_path;}
 
@@ -51,7 +77,20 @@ namespace comp{
 
   private:
 
-    QList<QVector<float>> potential_vals; //!< potentials[result_ind][0] is x, ...[1] is y, ...[2] is potential value
+    //! Find the plot files written by the plugin in the result directory.
+    void findPlotFiles(const QString &result_dir_path);
+
+    //! Build the raster pyramid from the samples if not yet built.
+    void buildRaster() const;
+
+    QVector<PotentialSample> owned_samples; //!< samples read from XML
+    const PotentialSample *samples=nullptr; //!< owned_samples or the mapped file's samples
+    int sample_count=0;                     //!< number of samples
+    QSharedPointer<const BinaryResultFile> mapped_file; //!< keeps mapped samples alive
+
+    mutable bool raster_built=false;        //!< whether buildRaster has run
+    mutable QVector<QImage> raster_pyramid; //!< colormapped samples at decreasing resolution
+    mutable QRectF raster_bounds;           //!< physical area covered by the raster
 
     QString static_plot_path;     //!< Path to static 2D slice plot
     QString animation_path;       //!< Path to 2D slice potential animation gif
@@ -0,0 +1,73 @@
+// @file:     output_log.cc
+// @author:   agent
+// @created:  2026.10.17
+// @license:  GNU LGPL v3
+//
+// @desc:     OutputLog implementation.
+
+#include "output_log.h"
+
+using namespace comp;
+
+OutputLog::OutputLog(const QString &spill_path, int capacity)
+  : capacity(qMax(capacity, 1)), spill_file(spill_path)
+{}
+
+OutputLog::~OutputLog()
+{
+  spill_file.close();
+}
+
+void OutputLog::append(const QByteArray &data)
+{
+  if (data.isEmpty())
+    return;
+
+  QMutexLocker locker(&mutex);
+
+  // the full output goes to the spill file
+  if (!spill_file.isOpen() && !spill_failed && !spill_file.fileName().isEmpty()) {
+    if (!spill_file.open(QFile::WriteOnly | QFile::Append)) {
+      qWarning() << QObject::tr("Failed to open terminal output log %1: %2")
+        .arg(spill_file.fileName()).arg(spill_file.errorString());
+      spill_failed = true;
+    }
+  }
+  if (spill_file.isOpen()) {
+    spill_file.write(data);
+    spill_file.flush();
+  }
+
+  // only the last capacity bytes are kept in the ring
+  if (ring.isEmpty())
+    ring.resize(capacity);
+  int skip = qMax(0, data.size() - capacity);
+  const char *src = data.constData() + skip;
+  int len = data.size() - skip;
+  int first = qMin(len, capacity - head);
+  memcpy(ring.data() + head, src, first);
+  memcpy(ring.data(), src + first, len - first);
+  head = (head + len) % capacity;
+  total += data.size();
+}
+
+QString OutputLog::text() const
+{
+  QMutexLocker locker(&mutex);
+  if (total <= capacity)
+    return QString::fromUtf8(ring.constData(), total);
+
+  // unwrap the ring and drop the partial first line
+  QByteArray kept = ring.mid(head) + ring.left(head);
+  int first_newline = kept.indexOf('\n');
+  kept.remove(0, first_newline + 1);
+  QString note = QObject::tr("[%1 bytes of earlier output omitted, see %2 for the full output]\n")
+    .arg(total - kept.size()).arg(spill_file.fileName());
+  return note + QString::fromUtf8(kept);
+}
+
+qint64 OutputLog::totalBytes() const
+{
+  QMutexLocker locker(&mutex);
+  return total;
+}
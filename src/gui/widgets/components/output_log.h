@@ -0,0 +1,59 @@
+// @file:     output_log.h
+// @author:   agent
+// @created:  2026.10.17
+// @license:  GNU LGPL v3
+//
+// @desc:     Bounded terminal output of plugin processes with the full output
+//            spilled to a log file.
+
+#ifndef _COMP_OUTPUT_LOG_H_
+#define _COMP_OUTPUT_LOG_H_
+
+#include <QtCore>
+
+namespace comp{
+
+  //! Terminal output of a plugin process channel. Only the most recent output
+  //! is kept in memory in a ring buffer of fixed capacity, everything is
+  //! written to the spill file so chatty plugins can't exhaust memory.
+  //! Appending is thread-safe so output can be captured off the GUI thread.
+  class OutputLog
+  {
+  public:
+
+    //! Constructor taking the spill file path, which is only created once
+    //! output arrives, and the ring buffer capacity in bytes.
+    OutputLog(const QString &spill_path, int capacity);
+
+    //! Destructor, closes the spill file.
+    ~OutputLog();
+
+    //! Append output.
+    void append(const QByteArray &data);
+
+    //! Return the output kept in memory. If older output has been dropped, a
+    //! note pointing to the spill file replaces the first incomplete line.
+    QString text() const;
+
+    //! Return the number of bytes appended in total.
+    qint64 totalBytes() const;
+
+    //! Return the spill file path.
+    QString spillPath() const {return spill_file.fileName();}
+
+  private:
+
+    Q_DISABLE_COPY(OutputLog)
+
+    mutable QMutex mutex;   // guards everything below
+    QByteArray ring;        // ring buffer, allocated on first append
+    int capacity;           // ring buffer capacity
+    int head=0;             // position of the next write in the ring
+    qint64 total=0;         // bytes appended in total
+    QFile spill_file;       // full output
+    bool spill_failed=false;// the spill file couldn't be opened
+  };
+
+} // end of comp namespace
+
+#endif
@@ -0,0 +1,175 @@
+// @file:     plugin_daemon.cc
+// @author:   agent
+// @created:  2026.10.17
+// @license:  GNU LGPL v3
+//
+// @desc:     PluginDaemon implementation.
+
+#include "plugin_daemon.h"
+
+using namespace comp;
+
+// prefix of daemon control lines in plugin stdout
+static const QByteArray daemon_marker = "[SQDAEMON] ";
+
+// time given to a daemon to exit after its stdin is closed
+static const int shutdown_grace_ms = 5000;
+
+PluginDaemon::PluginDaemon(const QStringList &command, QObject *parent)
+  : QObject(parent)
+{
+  QStringList args = command;
+  process = new QProcess(this);
+  process->setProgram(args.takeFirst());
+  process->setArguments(args);
+
+  connect(process, &QProcess::readyReadStandardOutput,
+          [this]()
+          {
+            out_buf.append(process->readAllStandardOutput());
+            processStandardOutput();
+          });
+  connect(process, &QProcess::readyReadStandardError,
+          [this]()
+          {
+            QByteArray err = process->readAllStandardError();
+            if (busy)
+              emit sig_standardError(err);
+          });
+  connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+          this, &PluginDaemon::processExit);
+  connect(process, &QProcess::errorOccurred,
+          [this](QProcess::ProcessError error)
+          {
+            // processes which never started don't emit finished
+            if (error == QProcess::FailedToStart) {
+              qWarning() << tr("Plugin daemon %1 failed to start.").arg(process->program());
+              processExit(-1, QProcess::CrashExit);
+            }
+          });
+
+  idle_timer.setSingleShot(true);
+  connect(&idle_timer, &QTimer::timeout, this, &PluginDaemon::shutDown);
+}
+
+PluginDaemon::~PluginDaemon()
+{
+  if (process->state() != QProcess::NotRunning) {
+    process->disconnect(this);
+    process->kill();
+    process->waitForFinished(1000);
+  }
+}
+
+void PluginDaemon::start()
+{
+  qDebug() << tr("Starting plugin daemon: %1 %2").arg(process->program())
+    .arg(process->arguments().join(" "));
+  alive = true;
+  process->start();
+  if (idle_timeout_ms > 0)
+    idle_timer.start(idle_timeout_ms);
+}
+
+bool PluginDaemon::submitRequest(const QString &problem_path,
+                                 const QString &result_path,
+                                 const QString &step_tmp_path,
+                                 const QString &problem_shm,
+                                 const QString &result_shm)
+{
+  if (busy || !alive)
+    return false;
+
+  QByteArray request = "run " + QUrl::toPercentEncoding(problem_path)
+    + " " + QUrl::toPercentEncoding(result_path)
+    + " " + QUrl::toPercentEncoding(step_tmp_path);
+  if (!problem_shm.isEmpty() && !result_shm.isEmpty())
+    request += " " + QUrl::toPercentEncoding(problem_shm)
+      + " " + QUrl::toPercentEncoding(result_shm);
+  request += "\n";
+  if (process->write(request) != request.size()) {
+    qWarning() << tr("Failed to submit request to plugin daemon %1.").arg(process->program());
+    return false;
+  }
+  idle_timer.stop();
+  busy = true;
+  return true;
+}
+
+void PluginDaemon::terminateRequest()
+{
+  if (!busy)
+    return;
+  alive = false;
+  process->kill();
+}
+
+void PluginDaemon::shutDown()
+{
+  if (!alive)
+    return;
+  alive = false;
+  idle_timer.stop();
+  process->closeWriteChannel();
+  QTimer::singleShot(shutdown_grace_ms, process, [this]()
+      {
+        if (process->state() != QProcess::NotRunning)
+          process->kill();
+      });
+}
+
+void PluginDaemon::processStandardOutput(bool flush)
+{
+  QByteArray relay;
+  int line_start = 0;
+  int line_end;
+  while ((line_end = out_buf.indexOf('\n', line_start)) != -1
+      || (flush && line_start < out_buf.size())) {
+    if (line_end == -1)
+      line_end = out_buf.size() - 1;
+    QByteArray line = out_buf.mid(line_start, line_end - line_start + 1);
+    line_start = line_end + 1;
+
+    if (line.startsWith(daemon_marker)) {
+      QList<QByteArray> fields = line.mid(daemon_marker.size()).simplified().split(' ');
+      if (fields.first() == "done") {
+        // output belonging to the finished request goes out before the finish
+        if (!relay.isEmpty())
+          emit sig_standardOutput(relay);
+        relay.clear();
+        bool ok = fields.size() > 1;
+        int exit_code = ok ? fields.at(1).toInt(&ok) : -1;
+        finishRequest(ok ? exit_code : -1, QProcess::NormalExit);
+      }
+    } else if (busy) {
+      relay.append(line);
+    }
+  }
+  out_buf.remove(0, line_start);
+  if (!relay.isEmpty())
+    emit sig_standardOutput(relay);
+}
+
+void PluginDaemon::processExit(int exit_code, QProcess::ExitStatus exit_status)
+{
+  Q_UNUSED(exit_status);
+  out_buf.append(process->readAllStandardOutput());
+  processStandardOutput(true);
+  alive = false;
+  idle_timer.stop();
+  qDebug() << tr("Plugin daemon %1 exited with exit code %2.")
+    .arg(process->program()).arg(exit_code);
+
+  // a daemon exiting in the middle of a request is always a failure
+  if (busy)
+    finishRequest(exit_code != 0 ? exit_code : -1, QProcess::CrashExit);
+  emit sig_daemonExited(this);
+}
+
+void PluginDaemon::finishRequest(int exit_code, QProcess::ExitStatus exit_status)
+{
+  busy = false;
+  if (alive && idle_timeout_ms > 0)
+    idle_timer.start(idle_timeout_ms);
+  emit sig_requestFinished(exit_code, exit_status);
+}
@@ -0,0 +1,115 @@
+// @file:     plugin_daemon.h
+// @author:   agent
+// @created:  2026.10.17
+// @license:  GNU LGPL v3
+//
+// @desc:     Long-lived plugin worker process which serves job steps over its
+//            standard input and output, avoiding the plugin start-up cost
+//            (e.g. interpreter start and imports) for every job step.
+
+#ifndef _COMP_PLUGIN_DAEMON_H_
+#define _COMP_PLUGIN_DAEMON_H_
+
+#include <QtCore>
+
+namespace comp{
+
+  //! A warm plugin process serving one job step at a time. Each request is
+  //! written to the plugin's stdin as a single line
+  //!
+  //!   run <problem path> <result path> <step tmp path> [<problem segment>
+  //!       <result segment>]
+  //!
+  //! with each field percent-encoded. The shared memory segment names are only
+  //! present for steps exchanging problems and results through shared memory. Everything the plugin prints to stdout is
+  //! relayed to the job step being served until the plugin prints the line
+  //!
+  //!   [SQDAEMON] done <exit code>
+  //!
+  //! The plugin is expected to exit once its stdin is closed.
+  class PluginDaemon : public QObject
+  {
+    Q_OBJECT
+
+  public:
+
+    //! Constructor taking the daemon invocation command with keywords already
+    //! replaced. The process is started with start().
+    PluginDaemon(const QStringList &command, QObject *parent=nullptr);
+
+    //! Destructor, kills the process if it is still running.
+    ~PluginDaemon();
+
+    //! Start the daemon process without waiting for it to come up, requests
+    //! submitted in the meantime are buffered.
+    void start();
+
+    //! Submit a job step request. Returns false if the daemon is busy or has
+    //! exited.
+    bool submitRequest(const QString &problem_path, const QString &result_path,
+                       const QString &step_tmp_path,
+                       const QString &problem_shm=QString(),
+                       const QString &result_shm=QString());
+
+    //! Kill the daemon to abort the request being served. The request finishes
+    //! with a crash exit status and the daemon exits.
+    void terminateRequest();
+
+    //! Close the daemon's stdin to let it exit, killing it if it doesn't do so
+    //! in time.
+    void shutDown();
+
+    //! Return whether a request is being served.
+    bool isBusy() const {return busy;}
+
+    //! Return whether the daemon process is starting or running and hasn't
+    //! been asked to shut down.
+    bool isAlive() const {return alive;}
+
+    //! Return the PID of the daemon process, 0 if it isn't running.
+    qint64 processId() const {return process->processId();}
+
+    //! Set the idle time after which the daemon shuts itself down, 0 to keep
+    //! it alive until shutDown() is called.
+    void setIdleTimeout(int msec) {idle_timeout_ms = msec;}
+
+  signals:
+
+    //! Emitted with plugin stdout belonging to the request being served.
+    void sig_standardOutput(const QByteArray &out);
+
+    //! Emitted with plugin stderr belonging to the request being served.
+    void sig_standardError(const QByteArray &err);
+
+    //! Emitted when the request being served has finished. Crash exit status
+    //! is reported if the daemon exited while serving the request.
+    void sig_requestFinished(int exit_code, QProcess::ExitStatus exit_status);
+
+    //! Emitted when the daemon process has exited, the daemon should be
+    //! removed from its pool.
+    void sig_daemonExited(PluginDaemon *daemon);
+
+  private:
+
+    //! Split buffered stdout into lines, relaying complete lines and handling
+    //! daemon control lines. An incomplete last line is relayed if flush is
+    //! set.
+    void processStandardOutput(bool flush=false);
+
+    //! Handle the exit of the daemon process.
+    void processExit(int exit_code, QProcess::ExitStatus exit_status);
+
+    //! Mark the request being served as finished and start the idle timer.
+    void finishRequest(int exit_code, QProcess::ExitStatus exit_status);
+
+    QProcess *process=nullptr;  // the daemon process
+    QTimer idle_timer;          // shuts down the daemon once idle for long enough
+    QByteArray out_buf;         // stdout not yet split into lines
+    bool busy=false;            // a request is being served
+    bool alive=false;           // process started and not shutting down
+    int idle_timeout_ms=0;      // idle time before shutting down, 0 to disable
+  };
+
+} // end of comp namespace
+
+#endif
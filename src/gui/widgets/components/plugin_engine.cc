@@ -77,6 +77,8 @@ PluginEngine::PluginEngine(const QString &desc_file_path, QWidget *parent)
       while (rs.readNextStartElement()) {
         if (rs.name() == "command") {
           QString cmd_label = rs.attributes().value("label").toString();
+          if (rs.attributes().value("daemon") == "1")
+            daemon_command_index = command_formats.length();
           QStringList cmd_list;
           while (rs.readNextStartElement()) {
             if (rs.name() == "program" || rs.name() == "arg") {
@@ -90,6 +92,20 @@ PluginEngine::PluginEngine(const QString &desc_file_path, QWidget *parent)
           unrecognizedXMLElement(rs);
         }
       }
+    } else if (rs.name() == "daemon") {
+      // introduced in SiQAD v0.2.3
+      if (rs.attributes().hasAttribute("max_workers"))
+        daemon_max_workers = qMax(1, rs.attributes().value("max_workers").toInt());
+      while (rs.readNextStartElement()) {
+        if (rs.name() == "program" || rs.name() == "arg") {
+          daemon_command_format.append(rs.readElementText());
+        } else {
+          unrecognizedXMLElement(rs);
+        }
+      }
+    } else if (rs.name() == "shm_exchange") {
+      // introduced in SiQAD v0.2.3
+      shm_exchange = rs.readElementText() == "1";
     } else if (rs.name() == "requested_datasets") {
       // TODO remove or implement
       rs.skipCurrentElement();
@@ -124,6 +140,13 @@ PluginEngine::PluginEngine(const QString &desc_file_path, QWidget *parent)
   }
 }
 
+PluginEngine::~PluginEngine()
+{
+  for (PluginDaemon *daemon : daemons)
+    daemon->disconnect(this);
+  qDeleteAll(daemons);
+}
+
 void PluginEngine::prepareVirtualenv()
 {
   if (!py_use_virtualenv) {
@@ -227,6 +250,48 @@ void PluginEngine::prepareVirtualenv()
   term_out(venv_process);
 }
 
+bool PluginEngine::daemonServesCommand(const QStringList &command_format) const
+{
+  if (!hasDaemonMode() || daemon_command_index >= command_formats.length())
+    return false;
+  return command_formats.at(daemon_command_index).second == command_format;
+}
+
+PluginDaemon *PluginEngine::acquireDaemon()
+{
+  if (!hasDaemonMode())
+    return nullptr;
+
+  for (PluginDaemon *daemon : daemons)
+    if (daemon->isAlive() && !daemon->isBusy())
+      return daemon;
+
+  // count daemons which are shutting down as well, they still hold resources
+  if (daemons.length() >= daemon_max_workers)
+    return nullptr;
+
+  QStringList command;
+  for (QString arg : daemon_command_format) {
+    arg.replace("@PYTHON@", pythonBin());
+    arg.replace("@BINPATH@", binaryPath());
+    arg.replace("@PHYSENGPATH@", pluginRootPath());
+    arg.replace("@PLUGINPATH@", pluginRootPath());
+    command.append(arg);
+  }
+
+  PluginDaemon *daemon = new PluginDaemon(command);
+  daemon->setIdleTimeout(1000 * settings::AppSettings::instance()->get<int>("plugs/daemon_idle_timeout_s"));
+  connect(daemon, &PluginDaemon::sig_daemonExited,
+          [this](PluginDaemon *exited)
+          {
+            daemons.removeOne(exited);
+            exited->deleteLater();
+          });
+  daemons.append(daemon);
+  daemon->start();
+  return daemon;
+}
+
 QString PluginEngine::pluginStatusStr()
 {
   if (py_use_virtualenv && !venv_init_success) {
@@ -15,6 +15,7 @@
 
 #include "global.h"
 #include "gui/property_map.h"
+#include "plugin_daemon.h"
 
 namespace comp{
 
@@ -58,8 +59,8 @@ namespace comp{
     //! Constructor taking in the description file path to this public.
     PluginEngine(const QString &desc_file_path, QWidget *parent=nullptr);
 
-    //! Destructor.
-    ~PluginEngine() {};
+    //! Destructor, shuts down the plugin daemons.
+    ~PluginEngine();
 
     //! Initialize virtualenv and install requirements if needed.
     void prepareVirtualenv();
@@ -92,6 +93,25 @@ namespace comp{
                        command_formats.at(i).second.join(delim));
     }
 
+    //! Return whether this plugin declares a daemon mode in its description 
+    //! file, which lets job steps be served by warm plugin processes.
+    bool hasDaemonMode() const {return !daemon_command_format.isEmpty();}
+
+    //! Return whether job steps invoked with the given command format may be 
+    //! served by a daemon. Daemon requests only carry the problem and result
+    //! paths, so only the preset the daemon stands in for qualifies: the one
+    //! marked with daemon="1" in the description file, else the first one.
+    bool daemonServesCommand(const QStringList &command_format) const;
+
+    //! Return an idle daemon from the pool, starting a new one if all are 
+    //! busy and the pool isn't full. Returns nullptr if no daemon is 
+    //! available, in which case the job step should start its own process.
+    PluginDaemon *acquireDaemon();
+
+    //! Return whether this plugin can read problems from and write results to
+    //! shared memory segments instead of files (through SiQADConnector).
+    bool supportsSharedExchange() const {return shm_exchange;}
+
     //! Return a QStringList of services provided by this plugin.
     //! TODO figure out a way to standardize services.
     QStringList services() const {return plugin_services;}
@@ -158,6 +178,14 @@ namespace comp{
     // datasets that can be returned by this plugin engine
     QSet<ReturnableDataset> returnable_datasets;
 
+    // daemon mode
+    QStringList daemon_command_format;  // daemon invocation command, empty if not supported
+    int daemon_max_workers=1;           // max daemons running at once
+    int daemon_command_index=0;         // preset command format served by daemons
+    QList<PluginDaemon*> daemons;       // daemon pool
+
+    bool shm_exchange=false;            // problems and results may go through shared memory
+
     uint unique_identifier;       // a unique identifier for this engine
     bool py_use_virtualenv;       // use virtualenv for python scripts
     bool venv_use_system_site;    // use system site packages for venv
@@ -0,0 +1,241 @@
+// @file:     process_runner.cc
+// @author:   agent
+// @created:  2026.10.17
+// @license:  GNU LGPL v3
+//
+// @desc:     ProcessRunner implementation.
+
+#include "process_runner.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+#ifdef Q_OS_LINUX
+#include <sched.h>
+#endif
+
+using namespace comp;
+
+// interval between resource usage samples of running plugin processes
+static const int usage_sample_interval_ms = 500;
+
+namespace {
+
+  //! QProcess applying the scheduling and memory limits in the child before 
+  //! the plugin is executed.
+  class LimitedProcess : public QProcess
+  {
+  public:
+    LimitedProcess(const ResourceLimits &limits, QObject *parent)
+      : QProcess(parent), nice(limits.nice)
+    {
+      // prepared up front, only system calls are allowed after the fork
+#ifdef Q_OS_UNIX
+      mem_limit.rlim_cur = mem_limit.rlim_max = 
+        rlim_t(qMax(limits.max_memory_mb, 0)) * 1024 * 1024;
+#endif
+#ifdef Q_OS_LINUX
+      CPU_ZERO(&cpu_set);
+      for (int cpu : limits.cpu_affinity)
+        if (cpu < CPU_SETSIZE)
+          CPU_SET(cpu, &cpu_set);
+      set_affinity = CPU_COUNT(&cpu_set) > 0;
+#endif
+    }
+
+  protected:
+    void setupChildProcess() override
+    {
+#ifdef Q_OS_UNIX
+      if (nice != 0)
+        setpriority(PRIO_PROCESS, 0, getpriority(PRIO_PROCESS, 0) + nice);
+      // the address space limit makes allocations beyond it fail in the 
+      // plugin itself, the sampled RSS check remains as a backup
+      if (mem_limit.rlim_max > 0)
+        setrlimit(RLIMIT_AS, &mem_limit);
+#endif
+#ifdef Q_OS_LINUX
+      if (set_affinity)
+        sched_setaffinity(0, sizeof(cpu_set), &cpu_set);
+#endif
+    }
+
+  private:
+    int nice;
+#ifdef Q_OS_UNIX
+    struct rlimit mem_limit;
+#endif
+#ifdef Q_OS_LINUX
+    cpu_set_t cpu_set;
+    bool set_affinity;
+#endif
+  };
+
+}
+
+// prefix of result stream records in plugin stdout, see SiQADConnector::streamExport
+static const QByteArray stream_marker = "[SQSTREAM] ";
+
+QByteArrayList comp::takeStreamRecords(QByteArray &buf, OutputLog *log, bool flush)
+{
+  QByteArrayList records;
+  int plain_start = 0;      // start of consecutive plain lines
+  int line_start = 0;
+  int line_end;
+  while ((line_end = buf.indexOf('\n', line_start)) != -1
+      || (flush && line_start < buf.size())) {
+    if (line_end == -1)
+      line_end = buf.size();
+    if (line_end - line_start >= stream_marker.size()
+        && memcmp(buf.constData() + line_start, stream_marker.constData(),
+                  stream_marker.size()) == 0) {
+      // plain lines before the record go out in one piece
+      log->append(buf.mid(plain_start, line_start - plain_start));
+      records.append(buf.mid(line_start + stream_marker.size(),
+                             line_end - line_start - stream_marker.size()).trimmed());
+      plain_start = line_end + 1;
+    }
+    line_start = line_end + 1;
+  }
+  log->append(buf.mid(plain_start, line_start - plain_start));
+  buf.remove(0, qMin(line_start, buf.size()));
+  return records;
+}
+
+static QThread *pluginProcessThread()
+{
+  static QThread *thread = nullptr;
+  if (thread == nullptr) {
+    qRegisterMetaType<QProcess::ExitStatus>("QProcess::ExitStatus");
+    qRegisterMetaType<comp::ResourceUsage>();
+    thread = new QThread();
+    thread->setObjectName("Plugin processes");
+    thread->start();
+  }
+  return thread;
+}
+
+ProcessRunner::ProcessRunner(QSharedPointer<OutputLog> out_log,
+                             QSharedPointer<OutputLog> err_log,
+                             const ResourceLimits &limits)
+  : out_log(out_log), err_log(err_log), limits(limits)
+{}
+
+void ProcessRunner::moveToWorkerThread()
+{
+  moveToThread(pluginProcessThread());
+}
+
+void ProcessRunner::destroy()
+{
+  if (thread() != QThread::currentThread() && thread()->isRunning())
+    QMetaObject::invokeMethod(this, "killAndWait", Qt::BlockingQueuedConnection);
+  else
+    killAndWait();
+  deleteLater();
+}
+
+void ProcessRunner::start(const QString &program, const QStringList &args,
+                          const QStringList &env)
+{
+  process = new LimitedProcess(limits, this);
+  process->setProcessChannelMode(QProcess::MergedChannels); // TODO doesn't seem to be working now, check
+  process->setProgram(program);
+  process->setArguments(args);
+  if (!env.isEmpty())
+    process->setEnvironment(env);
+
+  connect(process, &QProcess::started, this,
+          [this]()
+          {
+            sample_timer->start(usage_sample_interval_ms);
+            if (limits.max_wall_time_s > 0) {
+              QTimer::singleShot(limits.max_wall_time_s * 1000, this, [this]()
+                  {
+                    killForLimit(tr("wall time limit of %1 s").arg(limits.max_wall_time_s));
+                  });
+            }
+            emit sig_started(process->processId());
+          });
+  // the output pipes close when the process exits but before it is reaped,
+  // which is the last chance to sample its final CPU time
+  connect(process, &QProcess::readChannelFinished, this, &ProcessRunner::sampleUsage);
+  connect(process, &QProcess::readyReadStandardOutput, this,
+          [this](){readStandardOutput();});
+  connect(process, &QProcess::readyReadStandardError, this,
+          [this](){err_log->append(process->readAllStandardError());});
+  connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+          [this](int exit_code, QProcess::ExitStatus exit_status)
+          {
+            sample_timer->stop();
+            readStandardOutput(true);
+            err_log->append(process->readAllStandardError());
+            finished = true;
+            emit sig_resourceUsage(usage, exceeded_limit);
+            emit sig_finished(exit_code, exit_status);
+          });
+  connect(process, &QProcess::errorOccurred, this,
+          [this](QProcess::ProcessError error)
+          {
+            // processes which never started don't emit finished
+            if (error == QProcess::FailedToStart && !finished) {
+              err_log->append(tr("Failed to start plugin process: %1\n")
+                  .arg(process->errorString()).toUtf8());
+              finished = true;
+              emit sig_resourceUsage(usage, exceeded_limit);
+              emit sig_finished(-1, QProcess::CrashExit);
+            }
+          });
+
+  sample_timer = new QTimer(this);
+  connect(sample_timer, &QTimer::timeout, this, &ProcessRunner::sampleUsage);
+
+  process->start();
+}
+
+void ProcessRunner::terminate()
+{
+  if (process == nullptr)
+    return;
+#ifdef _WIN32
+  process->kill();
+#else
+  process->terminate();
+#endif
+}
+
+void ProcessRunner::killAndWait()
+{
+  if (process == nullptr || process->state() == QProcess::NotRunning)
+    return;
+  process->disconnect(this);
+  process->kill();
+  process->waitForFinished(1000);
+}
+
+void ProcessRunner::sampleUsage()
+{
+  if (process == nullptr || process->state() == QProcess::NotRunning)
+    return;
+  ResourceUsage sample = ResourceUsage::sample(process->processId());
+  usage.merge(sample);
+  if (limits.max_memory_mb > 0 && sample.rss_kb > qint64(limits.max_memory_mb) * 1024)
+    killForLimit(tr("memory limit of %1 MB").arg(limits.max_memory_mb));
+}
+
+void ProcessRunner::killForLimit(const QString &limit)
+{
+  if (!exceeded_limit.isEmpty() || process->state() == QProcess::NotRunning)
+    return;
+  exceeded_limit = limit;
+  err_log->append(tr("Plugin process killed for exceeding the %1.\n").arg(limit).toUtf8());
+  process->kill();
+}
+
+void ProcessRunner::readStandardOutput(bool flush)
+{
+  out_buf.append(process->readAllStandardOutput());
+  QByteArrayList records = takeStreamRecords(out_buf, out_log.data(), flush);
+  if (!records.isEmpty())
+    emit sig_streamRecords(records);
+}
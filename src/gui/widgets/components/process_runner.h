@@ -0,0 +1,110 @@
+// @file:     process_runner.h
+// @author:   agent
+// @created:  2026.10.17
+// @license:  GNU LGPL v3
+//
+// @desc:     Plugin process management off the GUI thread.
+
+#ifndef _COMP_PROCESS_RUNNER_H_
+#define _COMP_PROCESS_RUNNER_H_
+
+#include <QtCore>
+#include <QProcess>
+#include "output_log.h"
+#include "resource_usage.h"
+
+namespace comp{
+
+  //! Split buffered plugin stdout into lines. Result stream records (lines
+  //! starting with the stream marker, see SiQADConnector::streamExport) are
+  //! returned without the marker, all other lines go to the log. An
+  //! incomplete last line is kept in the buffer unless flush is set.
+  QByteArrayList takeStreamRecords(QByteArray &buf, OutputLog *log, bool flush);
+
+  //! Runs a single plugin process on the shared plugin process thread so
+  //! that starting the process and capturing its output never block the GUI
+  //! thread. Output is written to the output logs directly, result stream
+  //! records are forwarded through sig_streamRecords.
+  //!
+  //! The process is started under the given resource limits and its resource
+  //! usage is sampled while it runs.
+  //!
+  //! Create the runner on the GUI thread and call moveToWorkerThread(), then
+  //! control it through queued invocations of its slots. Delete it with
+  //! destroy().
+  class ProcessRunner : public QObject
+  {
+    Q_OBJECT
+
+  public:
+
+    //! Constructor.
+    ProcessRunner(QSharedPointer<OutputLog> out_log,
+                  QSharedPointer<OutputLog> err_log,
+                  const ResourceLimits &limits=ResourceLimits());
+
+    //! Move the runner to the plugin process thread, which is started on
+    //! first use and shared by all runners.
+    void moveToWorkerThread();
+
+    //! Kill the process if it is still running, wait for it to exit and
+    //! delete the runner. Blocks until the process is gone.
+    void destroy();
+
+  public slots:
+
+    //! Start the process, emits sig_started or sig_finished once the outcome
+    //! is known.
+    void start(const QString &program, const QStringList &args,
+               const QStringList &env);
+
+    //! Ask the process to terminate, killing it on Windows where that isn't
+    //! supported for console applications.
+    void terminate();
+
+  signals:
+
+    //! Emitted once the process has started.
+    void sig_started(qint64 pid);
+
+    //! Emitted with result stream records read from stdout.
+    void sig_streamRecords(const QByteArrayList &records);
+
+    //! Emitted right before sig_finished with the resource usage of the 
+    //! process and the limit it was killed for exceeding, if any.
+    void sig_resourceUsage(const comp::ResourceUsage &usage, const QString &exceeded_limit);
+
+    //! Emitted once the process has exited or failed to start, after all of
+    //! its output has been processed.
+    void sig_finished(int exit_code, QProcess::ExitStatus exit_status);
+
+  private slots:
+
+    //! Kill the process and wait for it to exit.
+    void killAndWait();
+
+  private:
+
+    //! Read out and process all available stdout.
+    void readStandardOutput(bool flush=false);
+
+    //! Sample the resource usage of the process and enforce the memory limit.
+    void sampleUsage();
+
+    //! Kill the process for exceeding the described limit.
+    void killForLimit(const QString &limit);
+
+    QProcess *process=nullptr;            // the plugin process
+    QByteArray out_buf;                   // stdout not yet split into lines
+    QSharedPointer<OutputLog> out_log;    // stdout log
+    QSharedPointer<OutputLog> err_log;    // stderr log
+    bool finished=false;                  // sig_finished has been emitted
+    ResourceLimits limits;                // limits imposed on the process
+    ResourceUsage usage;                  // usage sampled so far
+    QString exceeded_limit;               // limit the process was killed for
+    QTimer *sample_timer=nullptr;         // resource usage sampling
+  };
+
+} // end of comp namespace
+
+#endif
@@ -0,0 +1,180 @@
+// @file:     resource_usage.cc
+// @author:   agent
+// @created:  2026.10.17
+// @license:  GNU LGPL v3
+//
+// @desc:     ResourceUsage and ResourceLimits implementations.
+
+#include "resource_usage.h"
+#include "settings/settings.h"
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#include <sched.h>
+#endif
+
+using namespace comp;
+
+// CPU indices at or beyond this can't be put in an affinity mask
+#ifdef Q_OS_LINUX
+static const int cpu_index_limit = CPU_SETSIZE;
+#else
+static const int cpu_index_limit = 1024;
+#endif
+
+namespace {
+
+  //! Return the value of the "key: value" or "key value" line starting with
+  //! key, or -1 if there is no such line.
+  qint64 procValue(const QByteArray &contents, const QByteArray &key)
+  {
+    int pos = contents.startsWith(key) ? 0 : contents.indexOf("\n" + key);
+    if (pos < 0)
+      return -1;
+    if (pos > 0)
+      pos++;
+    int end = contents.indexOf('\n', pos);
+    QByteArray line = contents.mid(pos + key.size(), end < 0 ? -1 : end - pos - key.size());
+    bool ok;
+    qint64 val = line.simplified().split(' ').first().toLongLong(&ok);
+    return ok ? val : -1;
+  }
+
+  QByteArray readProcFile(qint64 pid, const char *name)
+  {
+    QFile file(QString("/proc/%1/%2").arg(pid).arg(name));
+    if (!file.open(QFile::ReadOnly))
+      return QByteArray();
+    // proc files report a size of 0, read until the end
+    return file.readAll();
+  }
+
+}
+
+bool ResourceUsage::isSupported()
+{
+#ifdef Q_OS_LINUX
+  return true;
+#else
+  return false;
+#endif
+}
+
+ResourceUsage ResourceUsage::sample(qint64 pid)
+{
+  ResourceUsage usage;
+#ifdef Q_OS_LINUX
+  if (pid <= 0)
+    return usage;
+
+  // utime and stime are the 14th and 15th fields, counted after the command
+  // name which may contain spaces
+  QByteArray stat = readProcFile(pid, "stat");
+  int comm_end = stat.lastIndexOf(')');
+  if (comm_end < 0)
+    return usage;
+  QList<QByteArray> fields = stat.mid(comm_end + 2).split(' ');
+  if (fields.size() < 13)
+    return usage;
+  static const double ticks_per_s = sysconf(_SC_CLK_TCK);
+  usage.user_s = fields.at(11).toLongLong() / ticks_per_s;
+  usage.sys_s = fields.at(12).toLongLong() / ticks_per_s;
+
+  // zombies have no memory lines left
+  QByteArray status = readProcFile(pid, "status");
+  usage.rss_kb = procValue(status, "VmRSS:");
+  usage.peak_rss_kb = procValue(status, "VmHWM:");
+
+  QByteArray io = readProcFile(pid, "io");
+  usage.read_bytes = procValue(io, "read_bytes:");
+  usage.write_bytes = procValue(io, "write_bytes:");
+#else
+  Q_UNUSED(pid);
+#endif
+  return usage;
+}
+
+void ResourceUsage::merge(const ResourceUsage &later)
+{
+  if (later.user_s >= 0) {
+    user_s = later.user_s;
+    sys_s = later.sys_s;
+  }
+  if (later.rss_kb >= 0)
+    rss_kb = later.rss_kb;
+  peak_rss_kb = qMax(peak_rss_kb, later.peak_rss_kb);
+  if (later.read_bytes >= 0)
+    read_bytes = later.read_bytes;
+  if (later.write_bytes >= 0)
+    write_bytes = later.write_bytes;
+}
+
+ResourceUsage ResourceUsage::since(const ResourceUsage &earlier) const
+{
+  ResourceUsage delta = *this;
+  if (!isValid() || !earlier.isValid())
+    return delta;
+  delta.user_s -= earlier.user_s;
+  delta.sys_s -= earlier.sys_s;
+  if (read_bytes >= 0 && earlier.read_bytes >= 0)
+    delta.read_bytes -= earlier.read_bytes;
+  if (write_bytes >= 0 && earlier.write_bytes >= 0)
+    delta.write_bytes -= earlier.write_bytes;
+  return delta;
+}
+
+QString ResourceUsage::summary() const
+{
+  if (!isValid())
+    return QObject::tr("resource usage unavailable");
+  auto mib = [](qint64 bytes)
+  {
+    return QString::number(bytes / (1024. * 1024.), 'f', 1);
+  };
+  QStringList parts;
+  parts.append(QObject::tr("%1 s CPU (%2 s user, %3 s sys)")
+      .arg(user_s + sys_s, 0, 'f', 2).arg(user_s, 0, 'f', 2).arg(sys_s, 0, 'f', 2));
+  if (peak_rss_kb >= 0)
+    parts.append(QObject::tr("%1 MiB peak RSS").arg(mib(peak_rss_kb * 1024)));
+  if (read_bytes >= 0 && write_bytes >= 0)
+    parts.append(QObject::tr("%1 MiB read, %2 MiB written")
+        .arg(mib(read_bytes)).arg(mib(write_bytes)));
+  return parts.join(", ");
+}
+
+ResourceLimits ResourceLimits::fromSettings()
+{
+  settings::AppSettings *app_settings = settings::AppSettings::instance();
+  ResourceLimits limits;
+  limits.max_memory_mb = app_settings->get<int>("plugs/limit_memory_mb");
+  limits.max_wall_time_s = app_settings->get<int>("plugs/limit_wall_time_s");
+  limits.nice = app_settings->get<int>("plugs/process_nice");
+  QString affinity = app_settings->get<QString>("plugs/cpu_affinity");
+  if (!parseCpuList(affinity, limits.cpu_affinity)) {
+    qWarning() << QObject::tr("Ignoring malformed CPU affinity list '%1'.").arg(affinity);
+    limits.cpu_affinity.clear();
+  }
+  return limits;
+}
+
+bool ResourceLimits::parseCpuList(const QString &spec, QList<int> &cpus)
+{
+  cpus.clear();
+  QSet<int> listed;
+  for (const QString &range : spec.split(",", QString::SkipEmptyParts)) {
+    QStringList bounds = range.trimmed().split("-");
+    bool ok_first, ok_last;
+    int first = bounds.first().toInt(&ok_first);
+    int last = bounds.last().toInt(&ok_last);
+    if (bounds.size() > 2 || !ok_first || !ok_last || first < 0 || last < first
+        || last >= cpu_index_limit)
+      return false;
+    for (int cpu=first; cpu<=last; cpu++) {
+      if (!listed.contains(cpu)) {
+        listed.insert(cpu);
+        cpus.append(cpu);
+      }
+    }
+  }
+  return true;
+}
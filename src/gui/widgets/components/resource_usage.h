@@ -0,0 +1,76 @@
+// @file:     resource_usage.h
+// @author:   agent
+// @created:  2026.10.17
+// @license:  GNU LGPL v3
+//
+// @desc:     Resource accounting and limits for plugin processes.
+
+#ifndef _COMP_RESOURCE_USAGE_H_
+#define _COMP_RESOURCE_USAGE_H_
+
+#include <QtCore>
+
+namespace comp{
+
+  //! Resources used by a plugin process. Values are sampled from /proc and
+  //! are -1 where unavailable, e.g. on platforms other than Linux.
+  struct ResourceUsage
+  {
+    double user_s=-1;         // CPU time spent in user mode
+    double sys_s=-1;          // CPU time spent in kernel mode
+    qint64 rss_kb=-1;         // resident set size when sampled
+    qint64 peak_rss_kb=-1;    // peak resident set size
+    qint64 read_bytes=-1;     // bytes read from storage
+    qint64 write_bytes=-1;    // bytes written to storage
+
+    //! Return whether any usage has been recorded.
+    bool isValid() const {return user_s >= 0;}
+
+    //! Return whether processes can be sampled on this platform.
+    static bool isSupported();
+
+    //! Sample the usage of the running process with the given PID. Exited
+    //! but unreaped processes still report their final CPU time.
+    static ResourceUsage sample(qint64 pid);
+
+    //! Fold a later sample of the same process into this one, counters are
+    //! taken from whichever sample has them and the peak RSS is the maximum.
+    void merge(const ResourceUsage &later);
+
+    //! Return the usage accumulated since an earlier sample of the same
+    //! process. The peak RSS remains that of the whole process lifetime.
+    ResourceUsage since(const ResourceUsage &earlier) const;
+
+    //! Return a one-line human readable summary.
+    QString summary() const;
+  };
+
+  //! Limits imposed on plugin processes, configured in the application
+  //! settings. Zero or empty values mean no limit.
+  struct ResourceLimits
+  {
+    int max_memory_mb=0;      // address space limit, also killed once its RSS exceeds this
+    int max_wall_time_s=0;    // the process is killed once it ran this long
+    int nice=0;               // scheduling niceness increment
+    QList<int> cpu_affinity;  // CPUs the process may run on
+
+    //! Return whether no limit is set.
+    bool isEmpty() const
+    {
+      return max_memory_mb <= 0 && max_wall_time_s <= 0 && nice == 0
+        && cpu_affinity.isEmpty();
+    }
+
+    //! Read the limits from the application settings.
+    static ResourceLimits fromSettings();
+
+    //! Parse a CPU list such as "0-3,6" into cpus. Returns false if the list
+    //! is malformed or names CPUs beyond what an affinity mask can hold.
+    static bool parseCpuList(const QString &spec, QList<int> &cpus);
+  };
+
+} // end of comp namespace
+
+Q_DECLARE_METATYPE(comp::ResourceUsage)
+
+#endif
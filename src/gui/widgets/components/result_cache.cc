@@ -0,0 +1,196 @@
+// @file:     result_cache.cc
+// @author:   agent
+// @created:  2026.10.17
+// @license:  GNU LGPL v3
+//
+// @desc:     ResultCache implementation.
+
+#include "result_cache.h"
+#include "binary_problem.h"
+#include "settings/settings.h"
+
+using namespace comp;
+
+// extension of cache entries, which may hold XML or binary results
+static const QString entry_suffix = ".result";
+
+// extension of cache entries still being written
+static const QString writing_suffix = ".writing";
+
+// age after which an entry still being written is considered abandoned
+static const qint64 stale_writing_s = 3600;
+
+bool ResultCache::enabled()
+{
+  return settings::AppSettings::instance()->get<bool>("plugs/result_cache_enabled");
+}
+
+QString ResultCache::cacheDirPath()
+{
+  QString cache_path = settings::AppSettings::instance()->getPath("plugs/result_cache_path");
+  QDir(cache_path).mkpath(".");
+  return cache_path;
+}
+
+QString ResultCache::cacheKey(const QString &problem_path, PluginEngine *engine,
+                              const QStringList &command_format,
+                              const QMap<QString, QString> &job_params,
+                              const QStringList &dep_result_paths)
+{
+  QFile problem_file(problem_path);
+  if (!problem_file.open(QFile::ReadOnly)) {
+    qWarning() << QObject::tr("Result cache unable to read problem file %1: %2")
+      .arg(problem_path).arg(problem_file.errorString());
+    return QString();
+  }
+  QByteArray problem = problem_file.readAll();
+  problem_file.close();
+
+  // the program block contains the export date and the gui block the view 
+  // state, neither of which affect the results
+  for (const QByteArray &tag : {QByteArray("program"), QByteArray("gui")}) {
+    int block_start = problem.indexOf("<" + tag + ">");
+    int block_end = problem.indexOf("</" + tag + ">");
+    if (block_start != -1 && block_end != -1)
+      problem.remove(block_start, block_end + tag.length() + 3 - block_start);
+  }
+
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  hash.addData("xml\n");
+  hash.addData(problem);
+  return finishKey(hash, engine, command_format, job_params, dep_result_paths);
+}
+
+QString ResultCache::cacheKey(const BinaryProblem &problem, PluginEngine *engine,
+                              const QStringList &command_format,
+                              const QMap<QString, QString> &job_params,
+                              const QStringList &dep_result_paths)
+{
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  hash.addData("binary\n");
+  problem.addContentToHash(hash);
+  return finishKey(hash, engine, command_format, job_params, dep_result_paths);
+}
+
+QString ResultCache::finishKey(QCryptographicHash &hash, PluginEngine *engine,
+                               const QStringList &command_format,
+                               const QMap<QString, QString> &job_params,
+                               const QStringList &dep_result_paths)
+{
+  hash.addData("\n");
+  hash.addData(engine->name().toUtf8());
+  hash.addData("\n");
+  hash.addData(engine->version().toUtf8());
+  hash.addData("\n");
+  hash.addData(command_format.join("\n").toUtf8());
+  hash.addData("\n");
+  for (const QString &key : job_params.keys()) {
+    hash.addData(key.toUtf8());
+    hash.addData("=");
+    hash.addData(job_params.value(key).toUtf8());
+    hash.addData("\n");
+  }
+
+  // results of upstream steps read by this step change whenever those steps
+  // are rerun with different outcomes
+  for (const QString &dep_result_path : dep_result_paths) {
+    QFile dep_result_file(dep_result_path);
+    if (!dep_result_file.open(QFile::ReadOnly)) {
+      qWarning() << QObject::tr("Result cache unable to read dependency result %1: %2")
+        .arg(dep_result_path).arg(dep_result_file.errorString());
+      return QString();
+    }
+    hash.addData("\n");
+    hash.addData(&dep_result_file);
+  }
+  return QString::fromLatin1(hash.result().toHex());
+}
+
+bool ResultCache::fetch(const QString &key, const QString &result_path)
+{
+  if (key.isEmpty())
+    return false;
+
+  QString entry_path = entryPath(key);
+  if (!QFileInfo(entry_path).exists())
+    return false;
+
+  QFile::remove(result_path);
+  if (!QFile::copy(entry_path, result_path)) {
+    qWarning() << QObject::tr("Result cache failed to copy %1 to %2")
+      .arg(entry_path).arg(result_path);
+    return false;
+  }
+
+  // mark as most recently used
+  QFile entry_file(entry_path);
+  if (entry_file.open(QFile::ReadWrite)) {
+    entry_file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    entry_file.close();
+  }
+  return true;
+}
+
+bool ResultCache::store(const QString &key, const QString &result_path)
+{
+  if (key.isEmpty())
+    return false;
+
+  QString entry_path = entryPath(key);
+  QString tmp_path = entry_path + writing_suffix;
+  QFile::remove(tmp_path);
+  if (!QFile::copy(result_path, tmp_path)) {
+    qWarning() << QObject::tr("Result cache failed to store %1").arg(result_path);
+    return false;
+  }
+  // rename to the final name only after the copy completes so a partially 
+  // written entry is never fetched
+  QFile::remove(entry_path);
+  if (!QFile::rename(tmp_path, entry_path)) {
+    qWarning() << QObject::tr("Result cache failed to move %1 to %2")
+      .arg(tmp_path).arg(entry_path);
+    QFile::remove(tmp_path);
+    return false;
+  }
+
+  // copies retain the source modification time on some platforms
+  QFile entry_file(entry_path);
+  if (entry_file.open(QFile::ReadWrite)) {
+    entry_file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    entry_file.close();
+  }
+
+  enforceSizeCap();
+  return true;
+}
+
+void ResultCache::enforceSizeCap()
+{
+  qint64 max_bytes = settings::AppSettings::instance()->get<qint64>("plugs/result_cache_max_mb") 
+    * 1024 * 1024;
+
+  QDir cache_dir(cacheDirPath());
+
+  // stores interrupted before their rename leave their temporary copy behind
+  QDateTime stale_before = QDateTime::currentDateTime().addSecs(-stale_writing_s);
+  for (const QFileInfo &writing : cache_dir.entryInfoList(
+        QStringList({"*" + writing_suffix}), QDir::Files)) {
+    if (writing.lastModified() < stale_before)
+      QFile::remove(writing.absoluteFilePath());
+  }
+
+  // most recently used entries first
+  QFileInfoList entries = cache_dir.entryInfoList(QStringList({"*" + entry_suffix}), 
+      QDir::Files, QDir::Time);
+  qint64 total_bytes = 0;
+  for (const QFileInfo &entry : entries) {
+    total_bytes += entry.size();
+    if (total_bytes > max_bytes)
+      QFile::remove(entry.absoluteFilePath());
+  }
+}
+
+QString ResultCache::entryPath(const QString &key)
+{
+  return QDir(cacheDirPath()).filePath(key + entry_suffix);
+}
@@ -0,0 +1,81 @@
+// @file:     result_cache.h
+// @author:   agent
+// @created:  2026.10.17
+// @license:  GNU LGPL v3
+//
+// @desc:     Content-addressed on-disk cache of job step result files, keyed
+//            by the exported problem, the plugin engine and its parameters.
+
+#ifndef _COMP_RESULT_CACHE_H_
+#define _COMP_RESULT_CACHE_H_
+
+#include <QtCore>
+
+#include "plugin_engine.h"
+
+namespace comp{
+
+  class BinaryProblem;
+
+  //! Content-addressed cache of job step result files. Cached results are 
+  //! stored in a flat directory named by their cache key with a format
+  //! neutral extension, as entries may be XML or binary results, and evicted
+  //! in least
+  //! recently used order (by file modification time) once the cache exceeds
+  //! its size cap. All settings are read from the application settings.
+  class ResultCache
+  {
+  public:
+
+    //! Return whether result caching is enabled in the application settings.
+    static bool enabled();
+
+    //! Return the cache directory path, creating it if it doesn't exist.
+    static QString cacheDirPath();
+
+    //! Return the cache key of a job step. The key is a hash of the problem
+    //! file content (excluding the program and gui blocks which hold the 
+    //! export timestamp and the view state), the engine name and version, the
+    //! command format, the job parameters and the content of the dependency 
+    //! result files the step reads. Returns an empty string if any of the 
+    //! files can't be read.
+    static QString cacheKey(const QString &problem_path, PluginEngine *engine,
+                            const QStringList &command_format,
+                            const QMap<QString, QString> &job_params,
+                            const QStringList &dep_result_paths=QStringList());
+
+    //! Return the cache key of a job step handing its problem to the plugin
+    //! in shared memory, hashing the binary problem content (excluding the 
+    //! program section) in place of the problem file.
+    static QString cacheKey(const BinaryProblem &problem, PluginEngine *engine,
+                            const QStringList &command_format,
+                            const QMap<QString, QString> &job_params,
+                            const QStringList &dep_result_paths=QStringList());
+
+    //! Copy the cached result with the given key to result_path. Returns 
+    //! false on cache miss. A hit marks the entry as most recently used.
+    static bool fetch(const QString &key, const QString &result_path);
+
+    //! Store the result file at result_path under the given key and evict
+    //! least recently used entries if the cache exceeds its size cap.
+    static bool store(const QString &key, const QString &result_path);
+
+    //! Evict least recently used entries until the cache fits its size cap
+    //! and remove leftovers of interrupted stores.
+    static void enforceSizeCap();
+
+  private:
+
+    //! Add the inputs other than the problem to the hash and return the key.
+    static QString finishKey(QCryptographicHash &hash, PluginEngine *engine,
+                             const QStringList &command_format,
+                             const QMap<QString, QString> &job_params,
+                             const QStringList &dep_result_paths);
+
+    //! Return the path of the cache entry with the given key.
+    static QString entryPath(const QString &key);
+  };
+
+} // end of comp namespace
+
+#endif
@@ -0,0 +1,110 @@
+// @file:     shared_segment.cc
+// @author:   agent
+// @created:  2026.10.17
+// @license:  GNU LGPL v3
+//
+// @desc:     SharedMemorySegment implementation.
+
+#include "shared_segment.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+using namespace comp;
+
+bool SharedMemorySegment::isSupported()
+{
+#ifdef Q_OS_UNIX
+  return true;
+#else
+  return false;
+#endif
+}
+
+QString SharedMemorySegment::uniqueName(const QString &suffix)
+{
+  static QAtomicInt counter;
+  return QString("/sqd%1_%2%3").arg(QCoreApplication::applicationPid())
+    .arg(counter.fetchAndAddRelaxed(1)).arg(suffix);
+}
+
+SharedMemorySegment *SharedMemorySegment::create(const QString &name, quint64 size)
+{
+#ifdef Q_OS_UNIX
+  QByteArray native_name = name.toLocal8Bit();
+  int fd = shm_open(native_name.constData(), O_CREAT | O_TRUNC | O_RDWR, 0600);
+  if (fd < 0) {
+    qWarning() << QObject::tr("Failed to create shared memory segment %1: %2")
+      .arg(name).arg(strerror(errno));
+    return nullptr;
+  }
+  if (ftruncate(fd, size) != 0) {
+    qWarning() << QObject::tr("Failed to size shared memory segment %1: %2")
+      .arg(name).arg(strerror(errno));
+    close(fd);
+    shm_unlink(native_name.constData());
+    return nullptr;
+  }
+  void *mapped = mmap(nullptr, qMax<quint64>(size, 1), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    qWarning() << QObject::tr("Failed to map shared memory segment %1: %2")
+      .arg(name).arg(strerror(errno));
+    shm_unlink(native_name.constData());
+    return nullptr;
+  }
+  return new SharedMemorySegment(name, static_cast<uchar*>(mapped), size);
+#else
+  Q_UNUSED(name);
+  Q_UNUSED(size);
+  return nullptr;
+#endif
+}
+
+SharedMemorySegment *SharedMemorySegment::attach(const QString &name)
+{
+#ifdef Q_OS_UNIX
+  int fd = shm_open(name.toLocal8Bit().constData(), O_RDONLY, 0);
+  if (fd < 0)
+    return nullptr;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    close(fd);
+    return nullptr;
+  }
+  void *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    qWarning() << QObject::tr("Failed to map shared memory segment %1: %2")
+      .arg(name).arg(strerror(errno));
+    return nullptr;
+  }
+  return new SharedMemorySegment(name, static_cast<uchar*>(mapped), st.st_size);
+#else
+  Q_UNUSED(name);
+  return nullptr;
+#endif
+}
+
+void SharedMemorySegment::unlink(const QString &name)
+{
+#ifdef Q_OS_UNIX
+  shm_unlink(name.toLocal8Bit().constData());
+#else
+  Q_UNUSED(name);
+#endif
+}
+
+SharedMemorySegment::~SharedMemorySegment()
+{
+#ifdef Q_OS_UNIX
+  munmap(seg_data, qMax<quint64>(seg_size, 1));
+#endif
+}
@@ -0,0 +1,70 @@
+// @file:     shared_segment.h
+// @author:   agent
+// @created:  2026.10.17
+// @license:  GNU LGPL v3
+//
+// @desc:     POSIX shared memory segments for exchanging problems and results
+//            with plugins without going through the disk.
+
+#ifndef _COMP_SHARED_SEGMENT_H_
+#define _COMP_SHARED_SEGMENT_H_
+
+#include <QtCore>
+
+namespace comp{
+
+  //! A mapped POSIX shared memory segment. Segments are created by SiQAD for
+  //! problems handed to plugins and by plugins (through SiQADConnector) for
+  //! the results handed back. The mapping stays valid after the segment name
+  //! has been unlinked and is released when the object is destroyed.
+  class SharedMemorySegment
+  {
+  public:
+
+    //! Return whether shared memory segments are supported on this platform.
+    static bool isSupported();
+
+    //! Return a segment name unique to this SiQAD instance. Names are kept
+    //! short since some platforms limit them to 31 characters.
+    static QString uniqueName(const QString &suffix);
+
+    //! Create a segment of the given size mapped for writing, replacing any
+    //! segment of the same name. Returns nullptr on failure.
+    static SharedMemorySegment *create(const QString &name, quint64 size);
+
+    //! Map an existing segment for reading. Returns nullptr if the segment
+    //! doesn't exist or can't be mapped.
+    static SharedMemorySegment *attach(const QString &name);
+
+    //! Remove the segment name so no one else can attach to it, existing
+    //! mappings stay valid.
+    static void unlink(const QString &name);
+
+    //! Destructor, unmaps the segment.
+    ~SharedMemorySegment();
+
+    //! Return the segment name.
+    QString name() const {return seg_name;}
+
+    //! Return a pointer to the mapped segment.
+    uchar *data() const {return seg_data;}
+
+    //! Return the segment size in bytes.
+    quint64 size() const {return seg_size;}
+
+  private:
+
+    //! Constructor taking an established mapping.
+    SharedMemorySegment(const QString &name, uchar *data, quint64 size)
+      : seg_name(name), seg_data(data), seg_size(size) {}
+
+    Q_DISABLE_COPY(SharedMemorySegment)
+
+    QString seg_name;   // segment name
+    uchar *seg_data;    // mapped segment
+    quint64 seg_size;   // segment size in bytes
+  };
+
+} // end of comp namespace
+
+#endif
@@ -10,11 +10,18 @@
 #include <QProcess>
 #include <iostream>
 #include <algorithm>
+#include <cmath>
+#include <functional>
 #include "sim_job.h"
+#include "result_cache.h"
+#include "process_runner.h"
 #include "../../../global.h"
 
 using namespace comp;
 
+// most job steps a parameter sweep may expand into
+static const int max_sweep_points = 10000;
+
 // JobStep implementation
 JobStep::JobStep(PluginEngine *t_engine, QStringList t_command_format,
                  gui::PropertyMap t_job_prop_map)
@@ -27,8 +34,15 @@ JobStep::JobStep(PluginEngine *t_engine, QStringList t_command_format,
 
 JobStep::~JobStep()
 {
-  if (process != nullptr)
-    delete process;
+  if (runner != nullptr) {
+    runner->disconnect(this);
+    runner->destroy();
+  }
+  if (daemon != nullptr) {
+    daemon->disconnect(this);
+    daemon->terminateRequest();
+  }
+  releaseSharedSegments();
 }
 
 void JobStep::prepareJobStep(const int &t_placement, 
@@ -48,6 +62,13 @@ void JobStep::prepareJobStep(const int &t_placement,
     : job_tmp_dir.absoluteFilePath(tr("step_%1").arg(placement));
   QDir(js_tmp_dir_path).mkpath(".");
 
+  // terminal output is kept in memory up to the buffer size, the full output
+  // is spilled to log files in the job step directory
+  int term_buf_size = settings::AppSettings::instance()->get<int>("plugs/terminal_buffer_kb") * 1024;
+  QDir log_dir(js_tmp_dir_path);
+  out_log.reset(new OutputLog(log_dir.absoluteFilePath("stdout.log"), term_buf_size));
+  err_log.reset(new OutputLog(log_dir.absoluteFilePath("stderr.log"), term_buf_size));
+
   // set the problem and result file paths
   QDir js_tmp_dir(js_tmp_dir_path);
   problem_path = !t_problem_path.isEmpty()  ? t_problem_path
@@ -55,6 +76,18 @@ void JobStep::prepareJobStep(const int &t_placement,
   result_path = !t_result_path.isEmpty()    ? t_result_path
     : js_tmp_dir.absoluteFilePath(tr("sim_result_%1.xml").arg(placement));
 
+  // exchange the problem and results through shared memory if possible, the
+  // binary formats are only defined for little-endian hosts
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+  use_shared_exchange = engine->supportsSharedExchange()
+    && SharedMemorySegment::isSupported()
+    && settings::AppSettings::instance()->get<bool>("plugs/shm_exchange_enabled");
+#endif
+  if (use_shared_exchange) {
+    problem_shm = SharedMemorySegment::uniqueName("p");
+    result_shm = SharedMemorySegment::uniqueName("r");
+  }
+
   // other pre-invocation settings
   if (command_format.isEmpty()) {
     // default command format
@@ -68,65 +101,153 @@ bool JobStep::invokeBinary()
   if (placement == -1) {
     qWarning() << "Job step execution order placement not initialized, stopping \
       invocation.";
+    job_step_state = FinishedWithError;
     return false;
   }
 
   // check if problem file exists
-  if (!QFileInfo(problem_path).exists()) {
+  if (problem_segment == nullptr && !QFileInfo(problem_path).exists()) {
     qDebug() << tr("SimJob: problem file '%1' doesn't exist.").arg(problem_path);
+    job_step_state = FinishedWithError;
     return false;
   }
 
   // check if binary path of simulation engine exists
   if (!QFileInfo(engine->binaryPath()).exists()) {
     qDebug() << tr("SimJob: engine binary/script '%1' doesn't exist.").arg(engine->binaryPath());
+    job_step_state = FinishedWithError;
+    return false;
+  }
+
+  if (!command_error.isEmpty()) {
+    err_log->append(tr("Invalid job step command: %1\n").arg(command_error).toUtf8());
+    job_step_state = FinishedWithError;
     return false;
   }
 
   job_step_state = Running;
 
+  // reuse previous results of an identical job step if available, steps 
+  // exchanging through shared memory are keyed by their binary problem
+  if (use_result_cache && ResultCache::enabled()) {
+    QStringList read_result_paths;
+    for (int dep : dep_result_paths.keys())
+      if (usesResultFileOf(dep))
+        read_result_paths.append(dep_result_paths.value(dep));
+    result_cache_key = (problem_segment != nullptr)
+      ? ResultCache::cacheKey(shared_problem, engine, command_format,
+                              job_params, read_result_paths)
+      : ResultCache::cacheKey(problem_path, engine, command_format,
+                              job_params, read_result_paths);
+    if (ResultCache::fetch(result_cache_key, result_path)) {
+      qDebug() << tr("Job step %1 reusing cached result %2.")
+        .arg(placement).arg(result_cache_key);
+      result_from_cache = true;
+      start_time = QDateTime::currentDateTime();
+      out_log->append(tr("Result reused from the result cache (key %1), plugin not invoked.\n")
+        .arg(result_cache_key).toUtf8());
+      // complete from the event loop so callers see the same flow as a process
+      QTimer::singleShot(0, this, [this](){processJobStepCompletion(0, QProcess::NormalExit);});
+      return true;
+    }
+  }
+
+  // warm plugin daemons skip the process start-up entirely
+  if (invokeDaemon())
+    return true;
+
   qDebug() << tr("Job step %1 about to execute command: %2")
     .arg(placement).arg(command.join(" "));
 
-  // set up process
-  process = new QProcess();
-  process->setProcessChannelMode(QProcess::MergedChannels); // TODO doesn't seem to be working now, check
-  process->setProgram(command.takeFirst());
-  process->setArguments(command);
+  // the process is started and its output captured on the plugin process
+  // thread, a failure to start is reported through sig_finished
+  QStringList env;
+  if (problem_segment != nullptr) {
+    // SiQADConnector picks the segments up from the environment
+    QProcessEnvironment proc_env = QProcessEnvironment::systemEnvironment();
+    proc_env.insert("SIQAD_PROBLEM_SHM", problem_shm);
+    proc_env.insert("SIQAD_RESULT_SHM", result_shm);
+    env = proc_env.toStringList();
+  }
+  QString program = command.takeFirst();
 
-  start_time = QDateTime::currentDateTime();
+  runner = new ProcessRunner(out_log, err_log, ResourceLimits::fromSettings());
+  connect(runner, &ProcessRunner::sig_resourceUsage, this,
+          [this](const ResourceUsage &usage, const QString &limit)
+          {
+            resource_usage = usage;
+            exceeded_limit = limit;
+          });
+  connect(runner, &ProcessRunner::sig_started, this,
+          [this](qint64 pid)
+          {
+            qDebug() << tr("Job step %1 process started with PID %2.").arg(placement).arg(pid);
+          });
+  connect(runner, &ProcessRunner::sig_streamRecords,
+          this, &JobStep::processStreamRecords);
+  connect(runner, &ProcessRunner::sig_finished,
+          this, &JobStep::processJobStepCompletion);
+  runner->moveToWorkerThread();
 
-  qDebug() << tr("Starting step step process %1").arg(placement);
-  process->start();
+  start_time = QDateTime::currentDateTime();
+  QMetaObject::invokeMethod(runner, "start", Qt::QueuedConnection,
+                            Q_ARG(QString, program), Q_ARG(QStringList, command),
+                            Q_ARG(QStringList, env));
+  return true;
+}
 
-  // block SiQAD process until the plugin process has started
-  qDebug() << tr("Waiting for process start success signal...");
-  if (!process->waitForStarted()) {
-    qCritical() << tr("Failed to start plugin process.");
+bool JobStep::invokeDaemon()
+{
+  // limits are imposed per process, which daemons outlive
+  if (!settings::AppSettings::instance()->get<bool>("plugs/plugin_daemons_enabled")
+      || !engine->daemonServesCommand(command_format)
+      || !ResourceLimits::fromSettings().isEmpty())
     return false;
-  } else {
-    qDebug() << "Job step process started successfully.";
-  }
 
-  // connect signals for error and finish
-  connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-          this, &JobStep::processJobStepCompletion);
+  daemon = engine->acquireDaemon();
+  if (daemon == nullptr)
+    return false;
 
-  // read out standard output and error messages
-  connect(process, &QProcess::readyReadStandardOutput,
-          [this]()
+  connect(daemon, &PluginDaemon::sig_standardOutput, this,
+          [this](const QByteArray &out)
           {
-            std_out.append(QString::fromUtf8(process->readAllStandardOutput()));
+            std_out_buf.append(out);
+            processStandardOutput();
           });
-  connect(process, &QProcess::readyReadStandardError,
-          [this]()
+  connect(daemon, &PluginDaemon::sig_standardError, this,
+          [this](const QByteArray &err)
           {
-            std_err.append(QString::fromUtf8(process->readAllStandardError()));
+            err_log->append(err);
           });
+  connect(daemon, &PluginDaemon::sig_requestFinished,
+          this, &JobStep::processDaemonCompletion);
 
+  start_time = QDateTime::currentDateTime();
+  daemon_usage_start = ResourceUsage::sample(daemon->processId());
+  bool shared = problem_segment != nullptr;
+  if (!daemon->submitRequest(problem_path, result_path, js_tmp_dir_path,
+                             shared ? problem_shm : QString(),
+                             shared ? result_shm : QString())) {
+    daemon->disconnect(this);
+    daemon = nullptr;
+    return false;
+  }
+  qDebug() << tr("Job step %1 handed to a plugin daemon.").arg(placement);
+  served_by_daemon = true;
   return true;
 }
 
+void JobStep::processDaemonCompletion(int t_exit_code, QProcess::ExitStatus t_exit_status)
+{
+  // only the usage accumulated while serving this step is accounted for
+  resource_usage = ResourceUsage::sample(daemon->processId()).since(daemon_usage_start);
+
+  // the daemon goes back to the engine's pool
+  daemon->disconnect(this);
+  daemon = nullptr;
+  processJobStepCompletion(t_exit_code, t_exit_status);
+}
+
 bool JobStep::readResults()
 {
   if (results_read) {
@@ -134,6 +255,34 @@ bool JobStep::readResults()
     return true;
   }
 
+  // plugins exchanging through shared memory leave their results in the 
+  // result segment, the result file is the fallback and also where cached 
+  // results are restored to
+  if (problem_segment != nullptr) {
+    SharedMemorySegment *segment = SharedMemorySegment::attach(result_shm);
+    SharedMemorySegment::unlink(result_shm);
+    if (segment != nullptr) {
+      // the result cache stores files, keep a copy of the segment for it
+      if (!result_cache_key.isEmpty()) {
+        QFile result_file(result_path);
+        if (!result_file.open(QFile::WriteOnly)
+            || result_file.write(reinterpret_cast<const char*>(segment->data()),
+                                 segment->size()) != qint64(segment->size())) {
+          qWarning() << tr("Failed to copy result segment %1 to %2, the result won't be cached.")
+            .arg(result_shm).arg(result_path);
+          result_cache_key.clear();
+        }
+      }
+      return readBinaryResults(segment);
+    }
+    qDebug() << tr("No result segment %1, reading the result file instead.")
+      .arg(result_shm);
+  }
+
+  // binary result files are recognized by their magic number
+  if (BinaryResultFile::isBinaryResultFile(result_path))
+    return readBinaryResults();
+
   QFile result_file(result_path);
 
   if(!result_file.open(QFile::ReadOnly | QFile::Text)){
@@ -173,8 +322,9 @@ bool JobStep::readResults()
           // TODO implement
           rs.skipCurrentElement();
         } else if (rs.name() == "time_elapsed_s") {
-          // TODO implement
-          rs.skipCurrentElement();
+          bool ok;
+          double elapsed = rs.readElementText().toDouble(&ok);
+          plugin_elapsed_s = ok ? elapsed : -1;
         } else {
           unrecognizedXMLElement(rs);
         }
@@ -183,22 +333,75 @@ bool JobStep::readResults()
       // params already stored in job_params, don't need to read again.
       rs.skipCurrentElement();
     } else if (rs.name() == "physloc") {
-      job_results.insert(comp::JobResult::DBLocationsResult,
-                         new comp::DBLocations(&rs));
+      setJobResult(comp::JobResult::DBLocationsResult,
+                   new comp::DBLocations(&rs));
     } else if (rs.name() == "elec_dist") {
-      job_results.insert(comp::JobResult::ChargeConfigsResult,
-                         new comp::ChargeConfigSet(&rs));
+      setJobResult(comp::JobResult::ChargeConfigsResult,
+                   new comp::ChargeConfigSet(&rs));
     } else if (rs.name() == "potential_map") {
-      job_results.insert(comp::JobResult::PotentialLandscapeResult,
-                         new comp::PotentialLandscape(&rs, QFileInfo(resultPath()).absolutePath()));
+      setJobResult(comp::JobResult::PotentialLandscapeResult,
+                   new comp::PotentialLandscape(&rs, QFileInfo(resultPath()).absolutePath()));
     } else if (rs.name() == "sqcommands") {
-      job_results.insert(comp::JobResult::SQCommandsResult,
-                        new comp::SQCommands(&rs));
+      setJobResult(comp::JobResult::SQCommandsResult,
+                   new comp::SQCommands(&rs));
     } else {
       unrecognizedXMLElement(rs);
     }
   }
 
+  assignDBPhysicalLocations();
+
+  // TODO remove line scans support from SiQADConn
+
+  if(rs.hasError()){
+    qCritical() << tr("Failed to read results, XML error - ") << rs.errorString().data();
+    return false;
+  }
+
+  qDebug() << tr("Successfully read job step result.");
+  result_file.close();
+
+  results_read = true;
+  return true;
+}
+
+bool JobStep::readBinaryResults(SharedMemorySegment *segment)
+{
+  QString source = (segment != nullptr) ? segment->name() : result_path;
+  qDebug() << tr("Reading binary simulation results from %1...").arg(source);
+  QSharedPointer<const BinaryResultFile> file((segment != nullptr)
+      ? new BinaryResultFile(segment) : new BinaryResultFile(result_path));
+  if (!file->isValid()) {
+    qCritical() << tr("Failed to read binary results from %1").arg(source);
+    return false;
+  }
+
+  // the results refer to the mapped file directly
+  if (file->hasSection(BinaryResultFile::PhysLocSection))
+    setJobResult(comp::JobResult::DBLocationsResult, new comp::DBLocations(file));
+  if (file->hasSection(BinaryResultFile::ElecDistSection))
+    setJobResult(comp::JobResult::ChargeConfigsResult, new comp::ChargeConfigSet(file));
+  if (file->hasSection(BinaryResultFile::PotentialMapSection))
+    setJobResult(comp::JobResult::PotentialLandscapeResult,
+                 new comp::PotentialLandscape(file, QFileInfo(resultPath()).absolutePath()));
+  assignDBPhysicalLocations();
+
+  qDebug() << tr("Successfully read job step result.");
+  results_read = true;
+  return true;
+}
+
+void JobStep::setJobResult(comp::JobResult::ResultType type, comp::JobResult *result)
+{
+  // results read from the result file supersede those streamed in during the
+  // run, which may still be referenced until sig_jobStepResultsUpdated
+  if (job_results.contains(type))
+    job_results.value(type)->deleteLater();
+  job_results.insert(type, result);
+}
+
+void JobStep::assignDBPhysicalLocations()
+{
   // TODO remove the following workaround after SiQADConn has been updated to
   // put DB physical locations inside electron config set
   if (job_results.keys().contains(comp::JobResult::DBLocationsResult)
@@ -207,28 +410,173 @@ bool JobStep::readResults()
     ecs->setDBPhysicalLocations(
         static_cast<comp::DBLocations*>(job_results.value(comp::JobResult::DBLocationsResult))->locations());
   }
+}
 
-  // TODO remove line scans support from SiQADConn
+void JobStep::processStandardOutput(bool flush)
+{
+  processStreamRecords(takeStreamRecords(std_out_buf, out_log.data(), flush));
+}
 
-  if(rs.hasError()){
-    qCritical() << tr("Failed to read results, XML error - ") << rs.errorString().data();
+void JobStep::processStreamRecords(const QByteArrayList &records)
+{
+  QList<ChargeConfigSet::ChargeConfig> stream_configs;
+  bool db_locs_updated = false;
+  for (const QByteArray &record : records)
+    readStreamRecord(record, stream_configs, db_locs_updated);
+
+  if (stream_configs.isEmpty() && !db_locs_updated)
+    return;
+
+  // accumulate streamed configs in a partial result set until the result 
+  // file is read
+  ChargeConfigSet *ecs = static_cast<ChargeConfigSet*>(
+      job_results.value(comp::JobResult::ChargeConfigsResult, nullptr));
+  if (ecs == nullptr && !stream_configs.isEmpty()) {
+    ecs = new ChargeConfigSet();
+    job_results.insert(comp::JobResult::ChargeConfigsResult, ecs);
+  }
+  if (ecs != nullptr)
+    ecs->addChargeConfigs(stream_configs);
+  assignDBPhysicalLocations();
+
+  emit sig_jobStepResultsUpdated(placement);
+}
+
+void JobStep::readStreamRecord(const QByteArray &record,
+                               QList<ChargeConfigSet::ChargeConfig> &stream_configs,
+                               bool &db_locs_updated)
+{
+  QXmlStreamReader rs(record);
+  if (!rs.readNextStartElement()) {
+    qWarning() << tr("Job step %1 received a malformed result stream record: %2")
+      .arg(placement).arg(QString::fromUtf8(record));
+    return;
+  }
+
+  if (rs.name() == "physloc") {
+    setJobResult(comp::JobResult::DBLocationsResult, new comp::DBLocations(&rs));
+    db_locs_updated = true;
+  } else if (rs.name() == "dist") {
+    ChargeConfigSet::ChargeConfig charge_config;
+    if (ChargeConfigSet::readChargeConfig(&rs, charge_config))
+      stream_configs.append(charge_config);
+  } else {
+    qWarning() << tr("Job step %1 received an unsupported result stream record %2")
+      .arg(placement).arg(rs.name().toString());
+  }
+}
+
+void JobStep::terminateJobStep()
+{
+  if (daemon != nullptr) {
+    daemon->terminateRequest();
+    return;
+  }
+  if (runner != nullptr)
+    QMetaObject::invokeMethod(runner, "terminate", Qt::QueuedConnection);
+}
+
+void JobStep::skipJobStep()
+{
+  if (job_step_state != NotInvoked)
+    return;
+  qDebug() << tr("Job step %1 skipped.").arg(placement);
+  job_step_state = Skipped;
+}
+
+bool JobStep::deriveProblemFile(const QString &template_path)
+{
+  QFile template_file(template_path);
+  if (!template_file.open(QFile::ReadOnly)) {
+    qWarning() << tr("Error when opening problem template %1: %2")
+      .arg(template_path).arg(template_file.errorString());
+    return false;
+  }
+  QByteArray problem = template_file.readAll();
+  template_file.close();
+
+  // locate the sim_params block written by the application
+  int params_start = problem.indexOf("<sim_params>");
+  int params_end = problem.indexOf("</sim_params>");
+  if (params_start != -1 && params_end != -1) {
+    params_end += QByteArray("</sim_params>").length();
+  } else {
+    params_start = problem.indexOf("<sim_params/>");
+    params_end = params_start + QByteArray("<sim_params/>").length();
+  }
+  if (params_start == -1) {
+    qWarning() << tr("No sim_params block found in problem template %1")
+      .arg(template_path);
     return false;
   }
 
-  qDebug() << tr("Successfully read job step result.");
-  result_file.close();
+  // serialize this step's parameters
+  QByteArray params;
+  QXmlStreamWriter ws(&params);
+  ws.writeStartElement("sim_params");
+  for (const QString &key : job_params.keys()) {
+    ws.writeTextElement(key, job_params.value(key));
+  }
+  ws.writeEndElement();
 
-  results_read = true;
+  QFile problem_file(problem_path);
+  if (!problem_file.open(QFile::WriteOnly)) {
+    qWarning() << tr("Error when opening problem file %1 to write: %2")
+      .arg(problem_path).arg(problem_file.errorString());
+    return false;
+  }
+  problem_file.write(problem.left(params_start));
+  problem_file.write(params);
+  problem_file.write(problem.mid(params_end));
+  problem_file.close();
   return true;
 }
 
-void JobStep::terminateJobStep()
+void JobStep::disableSharedExchange()
 {
-#ifdef _WIN32
-  process->kill();
-#else
-  process->terminate();
-#endif
+  releaseSharedSegments();
+  use_shared_exchange = false;
+  problem_shm.clear();
+  result_shm.clear();
+}
+
+bool JobStep::setSharedProblem(const BinaryProblem &problem)
+{
+  if (!use_shared_exchange)
+    return false;
+
+  if (problem_segment != nullptr)
+    delete problem_segment;
+  problem_segment = SharedMemorySegment::create(problem_shm, problem.serializedSize());
+  if (problem_segment == nullptr) {
+    qWarning() << tr("Job step %1 falling back to the problem file.").arg(placement);
+    disableSharedExchange();
+    return false;
+  }
+  problem.serialize(problem_segment->data());
+  shared_problem = problem;
+  return true;
+}
+
+bool JobStep::deriveSharedProblem(JobStep *template_step)
+{
+  if (template_step->problem_segment == nullptr)
+    return false;
+  BinaryProblem problem = template_step->shared_problem;
+  problem.setSimParams(job_params);
+  return setSharedProblem(problem);
+}
+
+void JobStep::releaseSharedSegments()
+{
+  if (problem_segment != nullptr) {
+    SharedMemorySegment::unlink(problem_shm);
+    delete problem_segment;
+    problem_segment = nullptr;
+  }
+  if (!result_shm.isEmpty())
+    SharedMemorySegment::unlink(result_shm);
+  shared_problem = BinaryProblem();
 }
 
 void JobStep::processJobStepCompletion(int t_exit_code, QProcess::ExitStatus t_exit_status)
@@ -239,9 +587,22 @@ void JobStep::processJobStepCompletion(int t_exit_code, QProcess::ExitStatus t_e
     .arg(placement).arg(exit_code).arg(str_exit_status);
   end_time = QDateTime::currentDateTime();
 
+  // process daemon output which arrived without a trailing newline, process
+  // output has already been flushed by the runner
+  processStandardOutput(true);
+
   bool successful = (exit_code == 0) && (exit_status == QProcess::NormalExit);
-  if (successful)
-    readResults();
+  job_step_state = successful ? FinishedNormally : FinishedWithError;
+  if (successful && readResults())
+    emit sig_jobStepResultsUpdated(placement);
+  releaseSharedSegments();
+
+  // store fresh results in the result cache, potential landscapes are skipped
+  // since they refer to plot files in the job step directory
+  if (successful && results_read && !result_from_cache && !result_cache_key.isEmpty()
+      && !job_results.contains(comp::JobResult::PotentialLandscapeResult)) {
+    ResultCache::store(result_cache_key, result_path);
+  }
 
   // inform the parent of the success state.
   emit sig_jobStepFinishState(placement, successful);
@@ -265,6 +626,16 @@ bool JobStep::commandKeywordReplacement()
   replace_map["@RESULTPATH@"] = result_path;
   replace_map["@JOBTMP@"] = job_tmp_dir_path;
   replace_map["@STEPTMP@"] = js_tmp_dir_path;
+  for (int dep : dep_result_paths.keys())
+    replace_map[resultPathKeyword(dep)] = dep_result_paths.value(dep);
+
+  // result paths are only known for declared dependencies, other references
+  // fail the step at invocation
+  command_error.clear();
+  if (!checkResultPathKeywords(command_format, dep_result_paths.keys(), &command_error)) {
+    qWarning() << tr("Job step %1: %2").arg(placement).arg(command_error);
+    return false;
+  }
 
   QRegExp regex("@(.*)?@");
   regex.setMinimal(true);
@@ -284,6 +655,26 @@ bool JobStep::commandKeywordReplacement()
 }
 
 
+bool JobStep::checkResultPathKeywords(const QStringList &command_format,
+                                      const QList<int> &dependencies,
+                                      QString *err_msg)
+{
+  QRegExp regex("@RESULTPATH_(\\d+)@");
+  QString joint_format = command_format.join(" ");
+  int pos = 0;
+  while ((pos = regex.indexIn(joint_format, pos)) != -1) {
+    if (!dependencies.contains(regex.cap(1).toInt())) {
+      if (err_msg != nullptr)
+        *err_msg = tr("%1 refers to step %2 which is not a dependency of this step.")
+          .arg(regex.cap(0)).arg(regex.cap(1));
+      return false;
+    }
+    pos += regex.matchedLength();
+  }
+  return true;
+}
+
+
 // SimJob implementation
 
 SimJob::SimJob(const QString &nm, QWidget *parent)
@@ -303,12 +694,41 @@ void SimJob::confirmJobStepsPlacement()
     return;
 
   for (int i=0; i<job_steps.length(); i++) {
-    job_steps.at(i)->prepareJobStep(i, runtimeTempPath());
+    JobStep *job_step = job_steps.at(i);
+
+    // resolve dependencies, steps without declarations run after the 
+    // previous step. Dependencies must refer to earlier steps which keeps the
+    // dependency graph acyclic.
+    if (!job_step->dependenciesDeclared())
+      job_step->setDependencies(i > 0 ? QList<int>({i-1}) : QList<int>());
+    QMap<int, QString> dep_result_paths;
+    for (int dep : job_step->jobStepDependencies()) {
+      if (dep < 0 || dep >= i) {
+        qWarning() << tr("Job step %1 ignores invalid dependency on step %2.")
+          .arg(i).arg(dep);
+        continue;
+      }
+      dep_result_paths.insert(dep, job_steps.at(dep)->resultPath());
+    }
+    job_step->setDependencies(dep_result_paths.keys());
+    job_step->setDependencyResultPaths(dep_result_paths);
+
+    job_step->prepareJobStep(i, runtimeTempPath());
+
+    // steps reading the result files of their dependencies need them on disk
+    for (int dep : job_step->jobStepDependencies()) {
+      if (job_step->usesResultFileOf(dep))
+        job_steps.at(dep)->disableSharedExchange();
+    }
   }
+  placement_confirmed = true;
 }
 
 void SimJob::prepareJob()
 {
+  if (job_prepared)
+    return;
+
   if (!placement_confirmed) {
     qDebug() << "Confirming job steps placement...";
     confirmJobStepsPlacement();
@@ -316,64 +736,193 @@ void SimJob::prepareJob()
 
   // export problem files for all job steps
   qDebug() << "Exporting job step problem files...";
-  for (JobStep *job_step : job_steps) {
-    emit sig_exportJobStepProblem(job_step, inclusion_area);
+  if (isParameterSweep() && !job_steps.isEmpty()) {
+    // sweep points only differ in sim_params, export the design once and 
+    // derive the remaining problem files from the first one
+    JobStep *first_step = job_steps.first();
+    emit sig_exportJobStepProblem(first_step, inclusion_area);
+    for (int i=1; i<job_steps.length(); i++) {
+      JobStep *job_step = job_steps.at(i);
+      if (first_step->usesSharedExchange()) {
+        // derive from the template problem in memory, export the design again
+        // if that fails
+        if (!job_step->deriveSharedProblem(first_step))
+          emit sig_exportJobStepProblem(job_step, inclusion_area);
+      } else {
+        job_step->disableSharedExchange();
+        job_step->deriveProblemFile(first_step->problemPath());
+      }
+    }
+  } else {
+    for (JobStep *job_step : job_steps) {
+      emit sig_exportJobStepProblem(job_step, inclusion_area);
+    }
   }
 
   // connect necessary signals
   for (JobStep *job_step : job_steps) {
+    job_step->setUseResultCache(!force_rerun);
     connect(job_step, &comp::JobStep::sig_jobStepFinishState,
             this, &SimJob::continueJob);
+    connect(job_step, &comp::JobStep::sig_jobStepResultsUpdated,
+            this, &SimJob::processJobStepResultsUpdate);
   }
+
+  job_prepared = true;
+}
+
+void SimJob::queueJob()
+{
+  prepareJob();
+  job_state = Queued;
 }
 
 bool SimJob::beginJob()
 {
-  if (!placement_confirmed)
+  if (!job_prepared)
     prepareJob();
 
   qDebug() << "Beginning job step invocation.";
   job_state = Running;
-  curr_step = job_steps.at(0);
-  return job_steps.at(0)->invokeBinary();
+  invokeReadySteps();
+  return !running_steps.isEmpty();
 }
 
 void SimJob::continueJob(int prev_step_ind, bool prev_step_successful)
 {
+  JobStep *prev_step = job_steps.at(prev_step_ind);
+  running_steps.removeOne(prev_step);
+
   if (!prev_step_successful) {
-    qDebug() << tr("Last job step finished unsuccessfully, ceasing job.");
-    jobFinishActions(FinishedWithError);
+    qDebug() << tr("Job step %1 finished unsuccessfully, skipping the steps "
+        "that depend on it.").arg(prev_step_ind);
+  } else {
+    qDebug() << tr("Received step completion notice from job step %1.").arg(prev_step_ind);
+    for (comp::JobResult::ResultType type : prev_step->jobResults().keys())
+      if (!result_type_step_map.contains(type, prev_step))
+        result_type_step_map.insert(type, prev_step);
+  }
+
+  if (job_state != Running)
     return;
+
+  invokeReadySteps();
+  finishJobIfDone();
+}
+
+void SimJob::processJobStepResultsUpdate(int step_ind)
+{
+  // make streamed results visible to the visualizer before the step finishes
+  JobStep *job_step = job_steps.at(step_ind);
+  for (comp::JobResult::ResultType type : job_step->jobResults().keys())
+    if (!result_type_step_map.contains(type, job_step))
+      result_type_step_map.insert(type, job_step);
+  emit sig_jobStepResultsUpdated(this, step_ind);
+}
+
+void SimJob::invokeReadySteps()
+{
+  // dependencies always precede their dependents in job_steps, so a single 
+  // pass propagates skips down the dependency graph
+  for (JobStep *job_step : job_steps) {
+    if (running_steps.length() >= max_parallel_steps)
+      break;
+    if (job_step->jobStepState() != JobStep::NotInvoked)
+      continue;
+
+    bool deps_done = true;
+    bool deps_failed = false;
+    for (int dep : job_step->jobStepDependencies()) {
+      JobStep::JobStepState dep_state = job_steps.at(dep)->jobStepState();
+      deps_failed |= dep_state == JobStep::FinishedWithError 
+        || dep_state == JobStep::Skipped;
+      deps_done &= dep_state == JobStep::FinishedNormally;
+    }
+
+    if (deps_failed) {
+      job_step->skipJobStep();
+    } else if (deps_done) {
+      if (job_step->invokeBinary()) {
+        running_steps.append(job_step);
+      } else {
+        qWarning() << tr("Job step %1 failed to be invoked.").arg(job_step->jobStepPlacement());
+      }
+    }
   }
+}
 
-  qDebug() << tr("Received step completion notice from job step %1.").arg(prev_step_ind);
+void SimJob::finishJobIfDone()
+{
+  if (!running_steps.isEmpty())
+    return;
 
-  qDebug() << tr("Prev step engine name %1").arg(job_steps[0]->pluginEngine()->name());
-  qDebug() << tr("job_steps.length=%1").arg(job_steps.length());
+  bool successful = true;
+  for (JobStep *job_step : job_steps) {
+    if (job_step->jobStepState() == JobStep::NotInvoked) {
+      // still waiting on dependencies, cannot happen once no step is running
+      // but check anyway to avoid finishing the job prematurely
+      return;
+    }
+    successful &= job_step->jobStepState() == JobStep::FinishedNormally;
+  }
 
-  for (comp::JobResult::ResultType type : job_steps.at(prev_step_ind)->jobResults().keys())
-    result_type_step_map.insert(type, job_steps.at(prev_step_ind));
+  if (isParameterSweep())
+    writeSweepSummary(QDir(runtimeTempPath()).filePath("sweep_summary.csv"));
+  writeResourceUsage(QDir(runtimeTempPath()).filePath("resource_usage.csv"));
+  jobFinishActions(successful ? FinishedNormally : FinishedWithError);
+}
 
-  int i = prev_step_ind + 1;
-  if (i < job_steps.length()) {
-    // invoke next step if any
-    job_steps.at(i)->invokeBinary();
-    curr_step = job_steps.at(i);
-  } else {
-    // wrap up job if no more steps
-    curr_step = nullptr;
-    jobFinishActions(FinishedNormally);
+int SimJob::stepConcurrency() const
+{
+  QVector<int> depth(job_steps.length(), 0);
+  QMap<int, int> depth_width;
+  for (int i=0; i<job_steps.length(); i++) {
+    for (int dep : job_steps.at(i)->jobStepDependencies())
+      depth[i] = qMax(depth[i], depth[dep] + 1);
+    depth_width[depth[i]]++;
   }
+  int concurrency = 1;
+  for (int width : depth_width.values())
+    concurrency = qMax(concurrency, width);
+  return concurrency;
+}
+
+QDateTime SimJob::startTime() const
+{
+  QDateTime start;
+  for (JobStep *job_step : job_steps)
+    if (job_step->startTime().isValid() && (!start.isValid() || job_step->startTime() < start))
+      start = job_step->startTime();
+  return start;
+}
+
+QDateTime SimJob::endTime() const
+{
+  QDateTime end;
+  for (JobStep *job_step : job_steps)
+    if (job_step->endTime().isValid() && (!end.isValid() || job_step->endTime() > end))
+      end = job_step->endTime();
+  return end;
 }
 
 void SimJob::terminateJob()
 {
-  if (curr_step != nullptr)
-    curr_step->terminateJobStep();
+  if (job_state == Queued) {
+    qDebug() << tr("Job %1 terminated before leaving the queue.").arg(name());
+    jobFinishActions(FinishedWithError);
+    return;
+  }
+
+  // prevent remaining steps from being invoked
+  for (JobStep *job_step : job_steps)
+    job_step->skipJobStep();
+  for (JobStep *job_step : running_steps)
+    job_step->terminateJobStep();
 }
 
-void SimJob::jobFinishActions(JobState job_state)
+void SimJob::jobFinishActions(JobState finish_state)
 {
+  job_state = finish_state;
   switch(job_state)
   {
     case FinishedWithError:
@@ -427,6 +976,231 @@ QList<QStandardItem*> SimJob::jobInfoStandardItemRow(QList<JobInfoStandardItemFi
   return info_si_row;
 }
 
+bool SimJob::parseDependencySpec(const QString &spec, int placement,
+                                 QList<int> &dependencies, QString *err_msg)
+{
+  dependencies.clear();
+  QString trimmed_spec = spec.trimmed();
+  if (trimmed_spec.isEmpty()) {
+    if (placement > 0)
+      dependencies.append(placement - 1);
+    return true;
+  } else if (trimmed_spec.compare("none", Qt::CaseInsensitive) == 0) {
+    return true;
+  }
+
+  for (const QString &dep_str : trimmed_spec.split(",", QString::SkipEmptyParts)) {
+    bool ok;
+    int dep = dep_str.trimmed().toInt(&ok);
+    if (!ok || dep < 0 || dep >= placement) {
+      if (err_msg != nullptr)
+        *err_msg = tr("Step %1 can only depend on earlier steps, got '%2'.")
+          .arg(placement).arg(dep_str.trimmed());
+      return false;
+    }
+    if (!dependencies.contains(dep))
+      dependencies.append(dep);
+  }
+  return true;
+}
+
+QList<int> SimJob::stepPlacements(const QList<bool> &rows_with_steps)
+{
+  QList<int> placements;
+  int placement = 0;
+  for (bool has_step : rows_with_steps)
+    placements.append(has_step ? placement++ : -1);
+  return placements;
+}
+
+bool SimJob::parseSweepSpec(const QString &spec,
+                            QMap<QString, QStringList> &sweep_values,
+                            QString *err_msg)
+{
+  auto fail = [err_msg](const QString &msg)
+  {
+    if (err_msg != nullptr)
+      *err_msg = msg;
+    return false;
+  };
+
+  sweep_values.clear();
+  qint64 total_pts = 1;
+  for (QString line : spec.split("\n")) {
+    line = line.trimmed();
+    if (line.isEmpty())
+      continue;
+
+    int eq_ind = line.indexOf("=");
+    if (eq_ind == -1)
+      return fail(tr("Expected 'key = values' in sweep line '%1'.").arg(line));
+    QString key = line.left(eq_ind).trimmed();
+    QString val_str = line.mid(eq_ind+1).trimmed();
+    if (key.isEmpty() || val_str.isEmpty())
+      return fail(tr("Empty key or values in sweep line '%1'.").arg(line));
+    if (sweep_values.contains(key))
+      return fail(tr("Parameter '%1' is swept more than once.").arg(key));
+
+    QStringList vals;
+    QStringList range = val_str.split(":");
+    if (range.length() == 3) {
+      // inclusive numeric range start:stop:step
+      bool ok_start, ok_stop, ok_step;
+      double start = range[0].toDouble(&ok_start);
+      double stop = range[1].toDouble(&ok_stop);
+      double step = range[2].toDouble(&ok_step);
+      if (!ok_start || !ok_stop || !ok_step)
+        return fail(tr("Non-numeric range for parameter '%1'.").arg(key));
+      if (!std::isfinite(start) || !std::isfinite(stop) || !std::isfinite(step))
+        return fail(tr("Non-finite range for parameter '%1'.").arg(key));
+      if (step == 0 || (stop - start) / step < 0)
+        return fail(tr("Step of parameter '%1' never reaches the range end.").arg(key));
+      // small tolerance so floating point error doesn't drop the end point
+      double steps = std::floor((stop - start) / step + 1e-9);
+      if (!std::isfinite(steps) || steps >= max_sweep_points)
+        return fail(tr("Range of parameter '%1' has more than %2 values.")
+            .arg(key).arg(max_sweep_points));
+      int n_pts = static_cast<int>(steps) + 1;
+      for (int i=0; i<n_pts; i++)
+        vals.append(QString::number(start + i * step, 'g', 12));
+    } else if (range.length() == 1) {
+      // explicit list of values
+      for (const QString &val : val_str.split(",", QString::SkipEmptyParts))
+        vals.append(val.trimmed());
+    } else {
+      return fail(tr("Malformed range for parameter '%1', expected start:stop:step.").arg(key));
+    }
+
+    if (vals.isEmpty())
+      return fail(tr("No values given for parameter '%1'.").arg(key));
+    total_pts *= vals.length();
+    if (total_pts > max_sweep_points)
+      return fail(tr("The sweep expands into more than %1 job steps.")
+          .arg(max_sweep_points));
+    sweep_values.insert(key, vals);
+  }
+  return true;
+}
+
+void SimJob::addParameterSweep(PluginEngine *engine, const QStringList &command_format,
+                               const gui::PropertyMap &prop_map,
+                               const QMap<QString, QStringList> &sweep_values)
+{
+  // expand the Cartesian product of all swept values
+  QList<QMap<QString, QString>> sweep_points({QMap<QString, QString>()});
+  for (const QString &key : sweep_values.keys()) {
+    QList<QMap<QString, QString>> expanded_points;
+    for (const QMap<QString, QString> &point : sweep_points) {
+      for (const QString &val : sweep_values.value(key)) {
+        QMap<QString, QString> expanded_point = point;
+        expanded_point.insert(key, val);
+        expanded_points.append(expanded_point);
+      }
+    }
+    sweep_points = expanded_points;
+  }
+
+  for (const QMap<QString, QString> &point : sweep_points) {
+    JobStep *job_step = new JobStep(engine, command_format, prop_map);
+    job_step->setDependencies(QList<int>());
+    for (const QString &key : point.keys())
+      job_step->setJobParameter(key, point.value(key));
+    addJobStep(job_step);
+  }
+  sweep_keys = sweep_values.keys();
+
+  qDebug() << tr("Parameter sweep over %1 expanded into %2 job steps.")
+    .arg(sweep_keys.join(", ")).arg(sweep_points.length());
+}
+
+QStringList SimJob::sweepSummaryHeader() const
+{
+  return sweep_keys + QStringList({"state", "ground_state_energy"});
+}
+
+QList<QStringList> SimJob::sweepSummary()
+{
+  QMetaEnum js_state_enum = QMetaEnum::fromType<JobStep::JobStepState>();
+  QList<QStringList> summary;
+  for (JobStep *js : job_steps) {
+    QStringList row;
+    for (const QString &key : sweep_keys)
+      row.append(js->jobParameters().value(key));
+    row.append(js_state_enum.valueToKey(js->jobStepState()));
+
+    // ground state energy among physically valid configs, falling back to 
+    // the lowest energy among all returned configs if none of them is valid
+    QString gs_energy;
+    if (js->jobResults().contains(comp::JobResult::ChargeConfigsResult)) {
+      comp::ChargeConfigSet *ccs = static_cast<comp::ChargeConfigSet*>(
+          js->jobResults().value(comp::JobResult::ChargeConfigsResult));
+      float energy;
+      if (ccs->groundStateEnergy(energy, true) || ccs->groundStateEnergy(energy, false))
+        gs_energy = QString::number(energy, 'g', 12);
+    }
+    row.append(gs_energy);
+    summary.append(row);
+  }
+  return summary;
+}
+
+bool SimJob::writeSweepSummary(const QString &path)
+{
+  QFile summary_file(path);
+  if (!summary_file.open(QFile::WriteOnly | QFile::Text)) {
+    qWarning() << tr("Error when opening sweep summary file %1: %2")
+      .arg(path).arg(summary_file.errorString());
+    return false;
+  }
+  QTextStream ts(&summary_file);
+  ts << sweepSummaryHeader().join(",") << "\n";
+  for (const QStringList &row : sweepSummary())
+    ts << row.join(",") << "\n";
+  summary_file.close();
+  qDebug() << tr("Sweep summary written to %1").arg(path);
+  return true;
+}
+
+QStringList SimJob::resourceUsageHeader()
+{
+  return QStringList({"step", "state", "wall_s", "plugin_elapsed_s",
+      "cpu_user_s", "cpu_sys_s", "peak_rss_kb", "read_bytes", "write_bytes",
+      "exceeded_limit"});
+}
+
+QList<QStringList> SimJob::resourceUsageTable()
+{
+  auto num = [](double val) {return val >= 0 ? QString::number(val) : QString();};
+  auto count = [](qint64 val) {return val >= 0 ? QString::number(val) : QString();};
+  QMetaEnum js_state_enum = QMetaEnum::fromType<JobStep::JobStepState>();
+  QList<QStringList> table;
+  for (JobStep *js : job_steps) {
+    ResourceUsage usage = js->resourceUsage();
+    table.append(QStringList({QString::number(js->jobStepPlacement()),
+          js_state_enum.valueToKey(js->jobStepState()), num(js->wallTime()),
+          num(js->pluginElapsedTime()), num(usage.user_s), num(usage.sys_s),
+          count(usage.peak_rss_kb), count(usage.read_bytes), count(usage.write_bytes),
+          js->exceededLimit()}));
+  }
+  return table;
+}
+
+bool SimJob::writeResourceUsage(const QString &path)
+{
+  QFile usage_file(path);
+  if (!usage_file.open(QFile::WriteOnly | QFile::Text)) {
+    qWarning() << tr("Error when opening resource usage file %1: %2")
+      .arg(path).arg(usage_file.errorString());
+    return false;
+  }
+  QTextStream ts(&usage_file);
+  ts << resourceUsageHeader().join(",") << "\n";
+  for (const QStringList &row : resourceUsageTable())
+    ts << row.join(",") << "\n";
+  usage_file.close();
+  return true;
+}
+
 QString SimJob::runtimeTempPath()
 {
   QString phys_tmp_rt_path = settings::AppSettings::instance()->getPath("plugs/runtime_tmp_root_path");
@@ -450,34 +1224,44 @@ QWidget *SimJob::terminalOutputDialog(QWidget *parent, Qt::WindowFlags w_flags)
   lw_job_steps->setSizePolicy(QSizePolicy::Minimum, QSizePolicy::Preferred);
   sw_job_term_outs->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
 
+  // output is only read out when a step is shown since chatty plugins may
+  // produce a lot of it
+  QList<std::function<void()>> step_loaders;
   for (JobStep *js : job_steps) {
     lw_job_steps->addItem(tr("Step %1").arg(js->jobStepPlacement()));
 
     QComboBox *cb_channel = new QComboBox();
     QPlainTextEdit *te_js_term_out = new QPlainTextEdit;
+    te_js_term_out->setReadOnly(true);
+    QPushButton *pb_open_log = new QPushButton(tr("Open Full Log"));
 
-    QString str_stdout = "Standard Output";
-    QString str_stderr = "Standard Error";
-    cb_channel->addItem(str_stdout);
-    cb_channel->addItem(str_stderr);
+    cb_channel->addItem("Standard Output", QProcess::StandardOutput);
+    cb_channel->addItem("Standard Error", QProcess::StandardError);
 
-    auto showChannelText = [js, te_js_term_out, str_stdout, str_stderr](const QString &str_channel)
+    auto showChannelText = [js, cb_channel, te_js_term_out, pb_open_log]()
     {
-      te_js_term_out->clear();
-      if (str_channel == str_stdout) {
-        te_js_term_out->setPlainText(js->terminalOutput(QProcess::StandardOutput));
-      } else if (str_channel == str_stderr) {
-        te_js_term_out->setPlainText(js->terminalOutput(QProcess::StandardError));
-      } else {
-        qWarning() << tr("Channel %1 not recognized").arg(str_channel);
-      }
+      QProcess::ProcessChannel channel = static_cast<QProcess::ProcessChannel>(
+          cb_channel->currentData().toInt());
+      te_js_term_out->setPlainText(js->terminalOutput(channel));
+      pb_open_log->setEnabled(QFileInfo(js->terminalLogPath(channel)).exists());
     };
 
-    connect(cb_channel, &QComboBox::currentTextChanged, showChannelText);
-    showChannelText(cb_channel->currentText());
+    connect(cb_channel, QOverload<int>::of(&QComboBox::currentIndexChanged), showChannelText);
+    connect(pb_open_log, &QPushButton::clicked,
+            [js, cb_channel]()
+            {
+              QProcess::ProcessChannel channel = static_cast<QProcess::ProcessChannel>(
+                  cb_channel->currentData().toInt());
+              QDesktopServices::openUrl(QUrl::fromLocalFile(js->terminalLogPath(channel)));
+            });
+    step_loaders.append(showChannelText);
+
+    QHBoxLayout *hl_channel = new QHBoxLayout();
+    hl_channel->addWidget(cb_channel);
+    hl_channel->addWidget(pb_open_log);
 
     QVBoxLayout *vl_js_term_out = new QVBoxLayout();
-    vl_js_term_out->addWidget(cb_channel);
+    vl_js_term_out->addLayout(hl_channel);
     vl_js_term_out->addWidget(te_js_term_out);
 
     QWidget *w_js_term_out = new QWidget();
@@ -486,7 +1270,14 @@ QWidget *SimJob::terminalOutputDialog(QWidget *parent, Qt::WindowFlags w_flags)
   }
 
   connect(lw_job_steps, &QListWidget::currentRowChanged,
-          sw_job_term_outs, &QStackedWidget::setCurrentIndex);
+          [sw_job_term_outs, step_loaders](int row)
+          {
+            if (row < 0 || row >= step_loaders.size())
+              return;
+            step_loaders.at(row)();
+            sw_job_term_outs->setCurrentIndex(row);
+          });
+  lw_job_steps->setCurrentRow(0);
 
   // pop-up widget
   QHBoxLayout *hl_job_term_out = new QHBoxLayout();
@@ -497,3 +1288,29 @@ QWidget *SimJob::terminalOutputDialog(QWidget *parent, Qt::WindowFlags w_flags)
   w_job_term_out->setLayout(hl_job_term_out);
   return w_job_term_out;
 }
+
+QWidget *SimJob::sweepSummaryDialog(QWidget *parent, Qt::WindowFlags w_flags)
+{
+  QWidget *w_sweep_summary = new QWidget(parent, w_flags);
+
+  QStringList header = sweepSummaryHeader();
+  QList<QStringList> summary = sweepSummary();
+  QTableWidget *tw_summary = new QTableWidget(summary.length(), header.length());
+  tw_summary->setHorizontalHeaderLabels(header);
+  tw_summary->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  for (int row=0; row<summary.length(); row++) {
+    for (int col=0; col<summary.at(row).length(); col++) {
+      tw_summary->setItem(row, col, new QTableWidgetItem(summary.at(row).at(col)));
+    }
+  }
+  tw_summary->resizeColumnsToContents();
+
+  QVBoxLayout *vl_sweep_summary = new QVBoxLayout();
+  vl_sweep_summary->addWidget(tw_summary);
+  vl_sweep_summary->addWidget(new QLabel(tr("Summary file: %1")
+        .arg(QDir(runtimeTempPath()).filePath("sweep_summary.csv"))));
+
+  w_sweep_summary->setWindowTitle(tr("%1 Sweep Summary").arg(name()));
+  w_sweep_summary->setLayout(vl_sweep_summary);
+  return w_sweep_summary;
+}
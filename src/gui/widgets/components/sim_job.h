@@ -13,6 +13,10 @@
 #include <QtWidgets>
 #include <QtCore>
 #include "plugin_engine.h"
+#include "binary_problem.h"
+#include "shared_segment.h"
+#include "output_log.h"
+#include "resource_usage.h"
 #include "job_results/job_result_types.h"
 #include "settings/settings.h" // TODO probably need this later
 #include <tuple> //std::tuple for 3+ article data structure, std::get for accessing the tuples
@@ -21,6 +25,7 @@
 namespace comp{
 
   class SimJob;
+  class ProcessRunner;
 
   //! A single job step in a job.
   class JobStep : public QObject
@@ -29,7 +34,11 @@ namespace comp{
 
   public:
 
-    enum JobStepState{NotInvoked, Running, FinishedWithError, FinishedNormally};
+    //! Job step run states. Skipped steps were never invoked because a step 
+    //! they depend on failed or the job was terminated.
+    enum JobStepState{NotInvoked, Running, FinishedWithError, FinishedNormally,
+      Skipped};
+    Q_ENUM(JobStepState);
 
     //! Constructor.
     JobStep(PluginEngine *t_engine, QStringList t_command_format, 
@@ -57,12 +66,45 @@ namespace comp{
     //! Process the job finish signal.
     void processJobStepCompletion(int t_exit_code, QProcess::ExitStatus t_exit_status);
 
-    //! Read job step results.
+    //! Return whether this job step is being or was served by a plugin daemon
+    //! instead of its own process.
+    bool servedByDaemon() {return served_by_daemon;}
+
+    //! Read job step results. Results streamed in while the plugin was 
+    //! running are replaced by those in the result file. Both XML and binary
+    //! result files are accepted, the format is recognized by its magic number.
     bool readResults();
 
     //! Kill job step
     void terminateJobStep();
 
+    //! Mark a job step which hasn't been invoked as skipped.
+    void skipJobStep();
+
+    //! Write this step's problem file by copying the problem file at 
+    //! template_path and replacing its sim_params block with the parameters
+    //! of this step. Used by parameter sweeps to avoid re-exporting the design
+    //! for every sweep point. Returns whether the write was successful.
+    bool deriveProblemFile(const QString &template_path);
+
+    //! Return whether this step hands its problem to the plugin and receives
+    //! its results through shared memory segments instead of files. Decided
+    //! in prepareJobStep() from the settings and the plugin capabilities.
+    bool usesSharedExchange() {return use_shared_exchange;}
+
+    //! Disable the shared memory exchange, e.g. when later steps need this
+    //! step's result file. Must be called before the problem is exported.
+    void disableSharedExchange();
+
+    //! Serialize the problem into this step's problem segment. Falls back to
+    //! the file exchange and returns false if the segment can't be created, 
+    //! in which case the problem file has to be written instead.
+    bool setSharedProblem(const BinaryProblem &problem);
+
+    //! The shared memory counterpart of deriveProblemFile, copies the problem
+    //! of template_step and replaces its sim_params with those of this step.
+    bool deriveSharedProblem(JobStep *template_step);
+
     // ACCESSORS
 
     //! Return the placement.
@@ -74,6 +116,61 @@ namespace comp{
     //! Return the simulation parameters.
     QMap<QString, QString> jobParameters() {return job_params;}
 
+    //! Override a single simulation parameter.
+    void setJobParameter(const QString &key, const QString &value) {job_params.insert(key, value);}
+
+    //! Return the job step state.
+    JobStepState jobStepState() {return job_step_state;}
+
+    //! Declare the placements of earlier job steps which must finish 
+    //! successfully before this step may be invoked. Steps without declared 
+    //! dependencies depend on the step right before them.
+    void setDependencies(const QList<int> &t_dependencies)
+    {
+      dependencies = t_dependencies;
+      dependencies_declared = true;
+    }
+
+    //! Return the placements of the job steps this step depends on.
+    QList<int> jobStepDependencies() {return dependencies;}
+
+    //! Return whether dependencies have been declared for this step.
+    bool dependenciesDeclared() {return dependencies_declared;}
+
+    //! Return whether the command format refers to the result file of the 
+    //! step at the given placement through @RESULTPATH_<n>@.
+    bool usesResultFileOf(int dep_placement)
+    {
+      return command_format.join(" ").contains(resultPathKeyword(dep_placement));
+    }
+
+    //! Return the command keyword standing for the result file path of the 
+    //! step at the given placement.
+    static QString resultPathKeyword(int dep_placement)
+    {
+      return QString("@RESULTPATH_%1@").arg(dep_placement);
+    }
+
+    //! Check that every @RESULTPATH_<n>@ in the command format refers to one
+    //! of the given dependencies. Returns false and describes the offending 
+    //! keyword in err_msg otherwise.
+    static bool checkResultPathKeywords(const QStringList &command_format,
+                                        const QList<int> &dependencies,
+                                        QString *err_msg=nullptr);
+
+    //! Set the result file paths of the dependencies, keyed by placement. 
+    //! They are made available to the command format as @RESULTPATH_<n>@ and
+    //! must be set before prepareJobStep() is called.
+    void setDependencyResultPaths(const QMap<int, QString> &paths) {dep_result_paths = paths;}
+
+    //! Set whether this job step may reuse results from the result cache. 
+    //! Disable to force the plugin to be rerun.
+    void setUseResultCache(bool use) {use_result_cache = use;}
+
+    //! Return whether the results of this job step were taken from the result
+    //! cache instead of invoking the plugin.
+    bool resultFromCache() {return result_from_cache;}
+
     //! Return the problem file path.
     QString problemPath() {return problem_path;}
 
@@ -86,17 +183,40 @@ namespace comp{
     //! Return the end time.
     QDateTime endTime() {return end_time;}
 
-    //! Return the terminal output from the specified channel.
+    //! Return the wall clock time in seconds, or -1 if the step hasn't 
+    //! finished.
+    double wallTime()
+    {
+      return (start_time.isValid() && end_time.isValid()) 
+        ? start_time.msecsTo(end_time) / 1000. : -1;
+    }
+
+    //! Return the resources used by the plugin process. Steps served by a
+    //! daemon account for the CPU time and I/O of the request only.
+    ResourceUsage resourceUsage() {return resource_usage;}
+
+    //! Return the resource limit the plugin process was killed for exceeding,
+    //! empty if none.
+    QString exceededLimit() {return exceeded_limit;}
+
+    //! Return the elapsed time reported by the plugin in its result file, or
+    //! -1 if not reported.
+    double pluginElapsedTime() {return plugin_elapsed_s;}
+
+    //! Return the terminal output from the specified channel. Only the most
+    //! recent output is kept in memory, see terminalLogPath() for the rest.
     QString terminalOutput(QProcess::ProcessChannel channel)
     {
-      switch (channel) {
-        case QProcess::StandardOutput:
-          return std_out;
-        case QProcess::StandardError:
-          return std_err;
-        default:
-          return std_out;
-      }
+      OutputLog *log = (channel == QProcess::StandardError) ? err_log.data() : out_log.data();
+      return (log != nullptr) ? log->text() : QString();
+    }
+
+    //! Return the path of the log file holding the full terminal output from
+    //! the specified channel, which only exists if there was any output.
+    QString terminalLogPath(QProcess::ProcessChannel channel)
+    {
+      OutputLog *log = (channel == QProcess::StandardError) ? err_log.data() : out_log.data();
+      return (log != nullptr) ? log->spillPath() : QString();
     }
 
     //! Return the job results.
@@ -107,8 +227,49 @@ namespace comp{
     //! Emit job step completion status.
     void sig_jobStepFinishState(int placement, bool successful);
 
+    //! Emitted when results have been streamed in from the running plugin or
+    //! when the final results have been read. Result pointers previously 
+    //! returned by jobResults() may have been replaced.
+    void sig_jobStepResultsUpdated(int placement);
+
   private:
 
+    //! Read job step results from a memory-mapped binary result file, or 
+    //! from the given result segment if provided.
+    bool readBinaryResults(SharedMemorySegment *segment=nullptr);
+
+    //! Unlink the problem and result segments and release the problem.
+    void releaseSharedSegments();
+
+    //! Hand the job step to a warm plugin daemon if the plugin supports it and
+    //! one is available. Returns whether the request was submitted.
+    bool invokeDaemon();
+
+    //! Process the completion of a request served by a plugin daemon.
+    void processDaemonCompletion(int t_exit_code, QProcess::ExitStatus t_exit_status);
+
+    //! Store a job result, replacing and scheduling the deletion of a 
+    //! previous result of the same type.
+    void setJobResult(comp::JobResult::ResultType type, comp::JobResult *result);
+
+    //! Hand DB locations to the charge config set if both are available.
+    void assignDBPhysicalLocations();
+
+    //! Split buffered daemon standard output into lines, parse result stream
+    //! records (lines starting with the stream marker) and append all other
+    //! lines to the terminal output. An incomplete last line is kept in the
+    //! buffer unless flush is set.
+    void processStandardOutput(bool flush=false);
+
+    //! Parse result stream records and merge them into the job results.
+    void processStreamRecords(const QByteArrayList &records);
+
+    //! Parse a single result stream record, which contains one XML element 
+    //! of the result file format (a physloc block or an elec_dist dist entry).
+    void readStreamRecord(const QByteArray &record,
+                          QList<ChargeConfigSet::ChargeConfig> &stream_configs,
+                          bool &db_locs_updated);
+
     //! Perform keyword replacement on the command and returns whether 
     //! the replacement took place.
     //! TODO implement some sort of "path role" which determines which types of
@@ -119,22 +280,41 @@ namespace comp{
     PluginEngine *engine;
     QStringList command_format;
     QMap<QString, QString> job_params;
+    QList<int> dependencies;                // placements of steps this step depends on
+    bool dependencies_declared=false;       // dependencies explicitly declared
+    QMap<int, QString> dep_result_paths;    // result paths of the dependencies
+    QString command_error;                  // why the command can't be formed, if it can't
 
     // pre-invocation variables
     int placement=-1;                       // execution order of this step within the job
     JobStepState job_step_state=NotInvoked; // job step run state
     QStringList command;                    // the invocation command
-    QProcess *process=nullptr;              // the program process
+    ProcessRunner *runner=nullptr;          // runs the program process off the GUI thread
+    PluginDaemon *daemon=nullptr;           // plugin daemon serving this step, if any
+    bool served_by_daemon=false;            // this step was handed to a plugin daemon
     QString job_tmp_dir_path;               // temp directory shared among steps
     QString js_tmp_dir_path;                // temp directory dedicated to this job step
     QString problem_path;                   // problem file path
     QString result_path;                    // result file path
+    bool use_result_cache=true;             // reuse cached results if available
+    QString result_cache_key;               // key of this step in the result cache
+    bool result_from_cache=false;           // results were taken from the result cache
+    bool use_shared_exchange=false;         // exchange problem and results through shared memory
+    QString problem_shm;                    // problem segment name
+    QString result_shm;                     // result segment name
+    BinaryProblem shared_problem;           // problem in the problem segment, template for sweeps
+    SharedMemorySegment *problem_segment=nullptr; // mapped problem segment
 
     // post-invocation, runtime-related variables
     QDateTime start_time;                   // start time of this job step
     QDateTime end_time;                     // end time of this job step
-    QString std_out;                        // stdout from process
-    QString std_err;                        // stderr from process
+    QSharedPointer<OutputLog> out_log;      // stdout from process
+    QByteArray std_out_buf;                 // daemon stdout not yet split into lines
+    QSharedPointer<OutputLog> err_log;      // stderr from process
+    ResourceUsage resource_usage;           // resources used by the process
+    ResourceUsage daemon_usage_start;       // daemon usage when this step was submitted
+    QString exceeded_limit;                 // resource limit the process was killed for
+    double plugin_elapsed_s=-1;             // elapsed time reported by the plugin
     int exit_code=-1;                       // exit code of the process, -1 if haven't invoked nor finished
     QProcess::ExitStatus exit_status;       // exit status of the process (normal or crashed)
 
@@ -159,6 +339,7 @@ namespace comp{
         pb_terminate = new QPushButton("Terminate");
         pb_job_terminal = new QPushButton("Log");
         pb_sim_visualize = new QPushButton("Visualize Results");
+        pb_sweep_summary = new QPushButton("Sweep Summary");
 
         connect(pb_job_terminal, &QPushButton::pressed,
                 [job](){job->terminalOutputDialog()->show();});
@@ -174,15 +355,18 @@ namespace comp{
                 });
         connect(pb_sim_visualize, &QPushButton::pressed,
                 [job](){emit job->sig_requestJobVisualization(job);});
+        connect(pb_sweep_summary, &QPushButton::pressed,
+                [job](){job->sweepSummaryDialog()->show();});
       }
 
       SimJob *job=nullptr;
       QPushButton *pb_terminate=nullptr;
       QPushButton *pb_job_terminal=nullptr;
       QPushButton *pb_sim_visualize=nullptr;
+      QPushButton *pb_sweep_summary=nullptr;
     };
 
-    enum JobState{NotInvoked, Running, FinishedWithError, FinishedNormally};
+    enum JobState{NotInvoked, Queued, Running, FinishedWithError, FinishedNormally};
     Q_ENUM(JobState);
 
     enum JobInfoStandardItemField{JobNameField, JobStartTimeField, 
@@ -201,6 +385,20 @@ namespace comp{
     //! Append a job step.
     void addJobStep(JobStep *js) {job_steps.append(js);}
 
+    //! Parse a job step dependency specification for the step at the given
+    //! placement into dependencies. An empty spec means the step depends on
+    //! the previous step, "none" means the step has no dependencies, otherwise
+    //! the spec is a comma separated list of earlier step placements. Returns
+    //! false and writes the reason to err_msg if parsing fails.
+    static bool parseDependencySpec(const QString &spec, int placement,
+                                    QList<int> &dependencies, 
+                                    QString *err_msg=nullptr);
+
+    //! Return the placement of the job step created from each row of a job
+    //! step list, given which rows hold a job step. Rows without one get -1
+    //! and don't take up a placement.
+    static QList<int> stepPlacements(const QList<bool> &rows_with_steps);
+
     //! Return the job step at the specified index.
     JobStep *getJobStep(int i) {return job_steps.at(i);}
 
@@ -208,11 +406,72 @@ namespace comp{
     QList<JobStep*> jobSteps() {return job_steps;}
 
 
+    // PARAMETER SWEEP
+
+    //! Parse a parameter sweep specification into sweep_values. Each non-empty
+    //! line takes the form "key = start:stop:step" for an inclusive numeric 
+    //! range or "key = v1, v2, v3" for an explicit list of values. Ranges 
+    //! must be finite and the sweep may expand into at most 10^4 job steps.
+    //! Returns false and writes the reason to err_msg if parsing fails.
+    static bool parseSweepSpec(const QString &spec, 
+                               QMap<QString, QStringList> &sweep_values,
+                               QString *err_msg=nullptr);
+
+    //! Append one job step per point of the grid spanned by sweep_values 
+    //! (Cartesian product of all swept keys). Each step takes the properties
+    //! in prop_map with the swept entries replaced. Sweep steps have no 
+    //! dependencies on each other and share a single design export.
+    void addParameterSweep(PluginEngine *engine, const QStringList &command_format,
+                           const gui::PropertyMap &prop_map,
+                           const QMap<QString, QStringList> &sweep_values);
+
+    //! Return whether this job is a parameter sweep.
+    bool isParameterSweep() const {return !sweep_keys.isEmpty();}
+
+    //! Return the swept parameter keys.
+    QStringList sweepKeys() const {return sweep_keys;}
+
+    //! Return the header of the sweep summary table.
+    QStringList sweepSummaryHeader() const;
+
+    //! Return the sweep summary table with one row per sweep point, holding 
+    //! the swept parameter values followed by the step state and the ground 
+    //! state energy. The energy is that of the lowest physically valid config,
+    //! or of the lowest config if none is valid, and empty if the step 
+    //! returned no charge configurations.
+    QList<QStringList> sweepSummary();
+
+    //! Write the sweep summary table to a CSV file at the given path.
+    bool writeSweepSummary(const QString &path);
+
+    //! Show a dialog containing the sweep summary table.
+    QWidget *sweepSummaryDialog(QWidget *parent=nullptr, Qt::WindowFlags w_flags=Qt::Dialog);
+
+
+    // RESOURCE ACCOUNTING
+
+    //! Return the header of the resource usage table.
+    static QStringList resourceUsageHeader();
+
+    //! Return the resource usage table with one row per job step, holding the
+    //! placement, step state, wall clock and plugin reported times, CPU times,
+    //! peak RSS, I/O bytes and the exceeded resource limit. Unavailable values
+    //! are left empty.
+    QList<QStringList> resourceUsageTable();
+
+    //! Write the resource usage table to a CSV file at the given path.
+    bool writeResourceUsage(const QString &path);
+
+
     // OTHER SETTINGS
 
     //! Set the inclusion area.
     void setInclusionArea(gui::DesignInclusionArea a) {inclusion_area = a;}
 
+    //! Set whether job steps must invoke their plugins even if matching 
+    //! results exist in the result cache.
+    void setForceRerun(bool force) {force_rerun = force;}
+
     //! Return the inclusion area.
     gui::DesignInclusionArea inclusionArea() {return inclusion_area;}
 
@@ -226,16 +485,27 @@ namespace comp{
     //! Prepare the job and contained job steps for invocation.
     void prepareJob();
 
+    //! Prepare the job (if it hasn't been prepared already) and mark it as 
+    //! queued. Problem files are exported at this point so the job reflects
+    //! the design at submission time rather than at invocation time.
+    void queueJob();
+
     //! Begin execution sequence - the first job step would be invoked, 
     //! appropriate signals connected and at the end of each job step the next 
     //! one would be invoked. Returns whether the job has begun execution.
     bool beginJob();
 
-    //! Continue the job if previous step was successful, stop it otherwise.
+    //! Invoke job steps whose dependencies have all finished. Steps depending
+    //! on a failed step are skipped, other steps continue to run. The job
+    //! finishes with error if any step failed or was skipped.
     void continueJob(int prev_step_ind, bool prev_step_successful);
 
+    //! Register the result types of a job step whose results have been 
+    //! updated (e.g. streamed from a running plugin) and relay the update.
+    void processJobStepResultsUpdate(int step_ind);
+
     //! Terminal the running job step process and prevent remaining job steps 
-    //! from executing.
+    //! from executing. Queued jobs are simply finished without being invoked.
     void terminateJob();
 
     //! Job finish actions.
@@ -264,15 +534,27 @@ namespace comp{
     //! Runtime temporary directory (all job steps share the same dir).
     QString runtimeTempPath();
 
-    //! Return the overall start time of the job (start time of the first step).
-    QDateTime startTime() const {return job_steps.first()->startTime();}
+    //! Return the overall start time of the job (earliest step start time).
+    QDateTime startTime() const;
 
-    //! Return the overall end time of the job (end time of the last step).
-    QDateTime endTime() const {return job_steps.last()->endTime();}
+    //! Return the overall end time of the job (latest step end time).
+    QDateTime endTime() const;
 
     //! Return the current job state.
     JobState jobState() const {return job_state;}
 
+    //! Return the number of job steps that may run at the same time given the
+    //! step dependencies, estimated as the largest number of steps sharing 
+    //! the same depth in the dependency graph. Only valid after the job steps
+    //! placement has been confirmed.
+    int stepConcurrency() const;
+
+    //! Return the maximum number of job steps allowed to run at the same time.
+    int maxParallelSteps() const {return max_parallel_steps;}
+
+    //! Set the maximum number of job steps allowed to run at the same time.
+    void setMaxParallelSteps(int n) {max_parallel_steps = qMax(1, n);}
+
     //! Return GUI control elements.
     GuiControlElems guiControlElems() const {return gui_ctrl_elems;}
 
@@ -295,20 +577,35 @@ namespace comp{
     //! Request the job results to be shown.
     void sig_requestJobVisualization(SimJob *job);
 
+    //! Emitted when the results of a job step have been updated, including 
+    //! results streamed in while the step is still running.
+    void sig_jobStepResultsUpdated(SimJob *job, int step_ind);
+
 
   private:
 
+    //! Invoke job steps whose dependencies are satisfied until the parallel
+    //! step limit is reached and skip steps whose dependencies failed.
+    void invokeReadySteps();
+
+    //! Wrap up the job if no job step is running or left to run.
+    void finishJobIfDone();
+
     // variables
     JobState job_state;                 // the state of the job
     QList<JobStep*> job_steps;          // list of steps in this simulation job, each step invokes one simulation
     QMultiMap<comp::JobResult::ResultType, JobStep*> result_type_step_map;  // all result types contained in job steps
     bool placement_confirmed=false;     // the job steps execution order has been confirmed, must be true before execution begins
+    bool job_prepared=false;            // problem files have been exported and signals connected
     gui::DesignInclusionArea inclusion_area=gui::IncludeEntireDesign;       // the inclusion area for this job
+    bool force_rerun=false;             // ignore the result cache for this job
     QString job_name;                   // job name for identification
     QString job_tmp_dir_path;           // job directory for storing runtime data
     QDateTime start_time, end_time;     // start and end times of the job
     QStringList cml_arguments;          // command line arguments when invoking the job
-    JobStep *curr_step=nullptr;
+    QList<JobStep*> running_steps;      // job steps currently being executed
+    int max_parallel_steps=1;           // max concurrently running job steps
+    QStringList sweep_keys;             // parameter keys swept by this job, empty if not a sweep
     GuiControlElems gui_ctrl_elems;     // store GUI control elements
 
     // read xml
@@ -14,6 +14,11 @@
 QColor gui::DesignPanel::background_col;
 QColor gui::DesignPanel::background_col_publish;
 qreal gui::DesignPanel::zoom_visibility_threshold;
+qreal gui::DesignPanel::dbdot_lod_threshold;
+
+// item batches larger than this are added to or removed from the scene with
+// the scene index suspended
+static const int bulk_index_threshold = 1000;
 
 // constructor
 gui::DesignPanel::DesignPanel(QWidget *parent)
@@ -307,6 +312,68 @@ void gui::DesignPanel::removeItem(prim::Item *item, prim::Layer *layer, bool ret
   itman->updateTableRemove(item);
 }
 
+void gui::DesignPanel::addItems(const QList<prim::Item*> &items, int layer_index,
+    const QList<int> &indices)
+{
+  if (layer_index <= 0 || layer_index >= layman->layerCount()) {
+    qCritical() << tr("Invalid layer index");
+    return;
+  }
+  prim::Layer *layer = layman->getLayer(layer_index);
+  if (!indices.isEmpty() && indices.last() >= layer->getItems().count() + items.count()) {
+    qCritical() << tr("Invalid item index");
+    return;
+  }
+
+  QPointF old_pos(mapToScene(mapFromParent(rect().center())));
+
+  layer->insertItems(items, indices);
+  // large batches rebuild the scene index once instead of updating it per item
+  bool suspend_index = items.count() > bulk_index_threshold
+    && scene->itemIndexMethod() == QGraphicsScene::BspTreeIndex;
+  if (suspend_index)
+    scene->setItemIndexMethod(QGraphicsScene::NoIndex);
+  for (prim::Item *item : items)
+    scene->addItem(item);
+  if (suspend_index)
+    scene->setItemIndexMethod(QGraphicsScene::BspTreeIndex);
+
+  updateSceneRect();
+
+  QPointF new_pos(mapToScene(mapFromParent(rect().center())));
+  scrollDelta(new_pos - old_pos);
+
+  itman->updateTableAdd(items);
+}
+
+void gui::DesignPanel::removeItems(const QList<prim::Item*> &items, prim::Layer *layer)
+{
+  if (layer->removeItems(items) != items.count())
+    qWarning() << tr("Not all items to be removed were found in the layer");
+
+  QPointF old_pos(mapToScene(mapFromParent(rect().center())));
+
+  bool suspend_index = items.count() > bulk_index_threshold
+    && scene->itemIndexMethod() == QGraphicsScene::BspTreeIndex;
+  if (suspend_index)
+    scene->setItemIndexMethod(QGraphicsScene::NoIndex);
+  for (prim::Item *item : items)
+    scene->removeItem(item);
+  if (suspend_index)
+    scene->setItemIndexMethod(QGraphicsScene::BspTreeIndex);
+
+  updateSceneRect();
+
+  QPointF new_pos(mapToScene(mapFromParent(rect().center())));
+  scrollDelta(new_pos - old_pos);
+
+  itman->updateTableRemove(items);
+  for (prim::Item *item : items) {
+    emit sig_itemRemoved(item);
+    delete item;
+  }
+}
+
 void gui::DesignPanel::addItemToScene(prim::Item *item)
 {
   scene->addItem(item);
@@ -527,10 +594,8 @@ void gui::DesignPanel::screenshot(QPainter *painter, const QRectF &region, const
   QList<prim::LatticeDotPreview*> latdot_previews;
   prim::Lattice *lat = static_cast<prim::Lattice*>(layman->getLayer(0, !layman->isSimLayerMode()));
   if (lat->isVisible()) {
-    QList<prim::LatticeCoord> coords = lat->enclosedSites(region);
+    QList<prim::LatticeCoord> coords = lat->unoccupiedSites(lat->enclosedSites(region));
     for (prim::LatticeCoord coord : coords) {
-      if (lat->isOccupied(coord))
-        continue;
       prim::LatticeDotPreview *ldp = new prim::LatticeDotPreview(coord);
       ldp->setPos(lat->latticeCoord2ScenePos(coord));
       ldp->setZValue(INT_MIN);
@@ -543,9 +608,15 @@ void gui::DesignPanel::screenshot(QPainter *painter, const QRectF &region, const
   if (clip_reactivate)
     screenman->setClipVisibility(false, false);
 
+  // the batched low detail pass belongs to the view, screenshots always
+  // render DBs in full detail
+  bool low_detail = prim::DBDot::lowDetail();
+  prim::DBDot::setLowDetail(false);
+
   // render scene onto painter
   scene->render(painter, outrect, region);
 
+  prim::DBDot::setLowDetail(low_detail);
   if (clip_reactivate)
     screenman->setClipVisibility(true, false);
 
@@ -611,6 +682,13 @@ void gui::DesignPanel::writeToXmlStream(QXmlStreamWriter *ws,
   ws->writeEndElement(); // end of design node
 }
 
+void gui::DesignPanel::writeToBinaryProblem(comp::BinaryProblem *problem,
+    DesignInclusionArea inclusion_area)
+{
+  layman->saveLayersBinary(problem);
+  layman->saveLayerItemsBinary(problem, inclusion_area);
+}
+
 void gui::DesignPanel::loadFromFile(QXmlStreamReader *rs, bool is_sim_result)
 {
   if (!is_sim_result) {
@@ -899,12 +977,19 @@ void gui::DesignPanel::clearSimResults()
 void gui::DesignPanel::clearPlots()
 {
   setDisplayMode(DesignMode);
-  for (prim::Item* temp_item: sim_results_items) {
+  // iterate over a copy as removing plots also removes them from the list
+  const QList<prim::Item*> result_items = sim_results_items;
+  for (prim::Item* temp_item: result_items) {
     if (temp_item->item_type == prim::Item::PotPlot) {
       prim::PotPlot *pp = static_cast<prim::PotPlot*>(temp_item);
-      undo_stack->push(new CreatePotPlot(this,
-          pp->getPotPlotPath(), pp->getGraphContainer(), pp->getAnimPath(),
-          static_cast<prim::PotPlot*>(temp_item), true));
+      if (pp->getRasterPyramid().isEmpty()) {
+        undo_stack->push(new CreatePotPlot(this,
+            pp->getPotPlotPath(), pp->getGraphContainer(), pp->getAnimPath(),
+            static_cast<prim::PotPlot*>(temp_item), true));
+      } else {
+        // raster plots aren't created through the undo stack
+        sim_results_items.removeOne(temp_item);
+      }
       removeItemFromScene(temp_item);
       delete temp_item;
     }
@@ -921,6 +1006,15 @@ void gui::DesignPanel::displayPotentialPlot(QString pot_plot_path, QRectF graph_
   createPotPlot(pot_plot_path, graph_container, pot_plot_anim);
 }
 
+void gui::DesignPanel::displayPotentialRaster(const QVector<QImage> &pyramid, QRectF graph_container)
+{
+  clearPlots();
+  setDisplayMode(SimDisplayMode);
+  prim::PotPlot *pp = new prim::PotPlot(pyramid, graph_container);
+  addItemToScene(static_cast<prim::Item*>(pp));
+  sim_results_items.append(static_cast<prim::Item*>(pp));
+}
+
 // SLOTS
 
 void gui::DesignPanel::selectClicked(prim::Item *)
@@ -992,6 +1086,18 @@ void gui::DesignPanel::updateBackground()
     scene->setBackgroundBrush(QBrush(lat->tileableLatticeImage(col, display_mode == gui::ScreenshotMode)));
   else
     scene->setBackgroundBrush(QBrush(col));
+
+  updateLevelOfDetail();
+}
+
+void gui::DesignPanel::updateLevelOfDetail()
+{
+  bool low_detail = display_mode != gui::ScreenshotMode
+    && qAbs(transform().m11() + transform().m12()) < dbdot_lod_threshold;
+  if (low_detail != prim::DBDot::lowDetail()) {
+    prim::DBDot::setLowDetail(low_detail);
+    viewport()->update();
+  }
 }
 
 void gui::DesignPanel::editTextLabel(prim::Item *text_lab,
@@ -1333,6 +1439,58 @@ void gui::DesignPanel::dragEnterEvent(QDragEnterEvent *e)
   e->ignore();
 }
 
+void gui::DesignPanel::drawForeground(QPainter *painter, const QRectF &rect)
+{
+  QGraphicsView::drawForeground(painter, rect);
+  if (!prim::DBDot::lowDetail())
+    return;
+
+  // DBs are well under a pixel wide at this zoom, so every visible DB becomes
+  // a single pixel of an image covering the exposed part of the viewport
+  QRect exposed = mapFromScene(rect).boundingRect().intersected(viewport()->rect());
+  if (exposed.isEmpty())
+    return;
+  QImage img(exposed.size(), QImage::Format_ARGB32_Premultiplied);
+  img.fill(Qt::transparent);
+  QTransform to_img = viewportTransform()
+    * QTransform::fromTranslate(-exposed.left(), -exposed.top());
+
+  for (bool design_role : {true, false}) {
+    prim::Lattice *lat = layman->getLattice(design_role);
+    if (lat == nullptr)
+      continue;
+
+    // unit cell range covering the exposed region, padded by a cell since the
+    // corners snap to their nearest sites
+    int n_min=INT_MAX, m_min=INT_MAX, n_max=INT_MIN, m_max=INT_MIN;
+    for (const QPointF &corner : {rect.topLeft(), rect.topRight(),
+                                  rect.bottomLeft(), rect.bottomRight()}) {
+      prim::LatticeCoord coord = lat->nearestSite(corner, true);
+      n_min = qMin(n_min, coord.n);
+      m_min = qMin(m_min, coord.m);
+      n_max = qMax(n_max, coord.n);
+      m_max = qMax(m_max, coord.m);
+    }
+
+    QList<prim::DBDot*> dbs = lat->dbsInRange(prim::LatticeCoord(n_min-1, m_min-1, 0),
+                                              prim::LatticeCoord(n_max+1, m_max+1, 0));
+    for (prim::DBDot *db : dbs) {
+      if (!db->isVisible())
+        continue;
+      QPoint px = to_img.map(db->scenePos()).toPoint();
+      if (!img.rect().contains(px))
+        continue;
+      reinterpret_cast<QRgb*>(img.scanLine(px.y()))[px.x()] =
+        qPremultiply(db->lowDetailColor().rgba());
+    }
+  }
+
+  painter->save();
+  painter->resetTransform();
+  painter->drawImage(exposed.topLeft(), img);
+  painter->restore();
+}
+
 // INTERNAL METHODS
 
 void gui::DesignPanel::constructStatics()
@@ -1341,6 +1499,7 @@ void gui::DesignPanel::constructStatics()
   background_col = gui_settings->get<QColor>("view/bg_col");
   background_col_publish = gui_settings->get<QColor>("view/bg_col_pb");
   zoom_visibility_threshold = gui_settings->get<qreal>("latdot/zoom_vis_threshold");
+  dbdot_lod_threshold = gui_settings->get<qreal>("dbdot/lod_zoom_threshold");
 }
 
 
@@ -1433,6 +1592,8 @@ void gui::DesignPanel::applyZoom(qreal ds, QWheelEvent *e)
   if ((old_zoom < zoom_visibility_threshold && zoom_visibility_threshold <= new_zoom)
       || (new_zoom < zoom_visibility_threshold && zoom_visibility_threshold <= old_zoom))
     updateBackground();
+  else
+    updateLevelOfDetail();
 
   informZoomUpdate();
 }
@@ -1871,9 +2032,7 @@ void gui::DesignPanel::createDBPreviews(QList<prim::LatticeCoord> coords)
 
 void gui::DesignPanel::appendDBPreviews(QList<prim::LatticeCoord> coords)
 {
-  for (prim::LatticeCoord coord : coords) {
-    if (lattice->isOccupied(coord))
-      continue;
+  for (prim::LatticeCoord coord : lattice->unoccupiedSites(coords)) {
     prim::DBDotPreview *db_prev = new prim::DBDotPreview(coord);
     db_prev->setPos(lattice->latticeCoord2ScenePos(coord));
     db_previews.append(db_prev);
@@ -1942,7 +2101,7 @@ gui::DesignPanel::CreateDB::CreateDB(prim::LatticeCoord l_coord, int layer_index
 
   // dbdot index in layer
   prim::Layer *layer = dp->layman->getLayer(layer_index);
-  index = invert ? layer->getItems().indexOf(db_at_loc) : layer->getItems().size();
+  index = invert ? layer->getItemIndex(db_at_loc) : layer->getItems().size();
 }
 
 void gui::DesignPanel::CreateDB::undo()
@@ -1977,6 +2136,81 @@ void gui::DesignPanel::CreateDB::destroy()
 }
 
 
+// CreateDBs class
+
+gui::DesignPanel::CreateDBs::CreateDBs(const QList<prim::LatticeCoord> &l_coords,
+    int layer_index, DesignPanel *dp, bool invert, QUndoCommand *parent)
+  : QUndoCommand(parent), invert(invert), dp(dp), layer_index(layer_index)
+{
+  prim::Layer *layer = dp->layman->getLayer(layer_index);
+  lat_coords.reserve(l_coords.size());
+  indices.reserve(l_coords.size());
+
+  if (invert) {
+    // order the lattice dots by item stack index so that undo can merge the
+    // DBs back in place
+    QMap<int, prim::LatticeCoord> coords_by_ind;
+    for (const prim::LatticeCoord &l_coord : l_coords) {
+      prim::DBDot *db = dp->lattice->dbAt(l_coord);
+      if (!db || !layer->containsItem(db))
+        qFatal("Trying to remove a non-existing DB");
+      coords_by_ind.insert(layer->getItemIndex(db), l_coord);
+    }
+    for (auto it=coords_by_ind.constBegin(); it!=coords_by_ind.constEnd(); ++it) {
+      indices.append(it.key());
+      lat_coords.append(it.value());
+    }
+  } else {
+    // new DBs go on top of the layer item stack
+    int top = layer->getItems().size();
+    for (const prim::LatticeCoord &l_coord : l_coords) {
+      if (dp->lattice->isOccupied(l_coord))
+        qFatal("Trying to make a new DB at a location that already has one");
+      lat_coords.append(l_coord);
+      indices.append(top++);
+    }
+  }
+}
+
+void gui::DesignPanel::CreateDBs::undo()
+{
+  invert ? create() : destroy();
+}
+
+void gui::DesignPanel::CreateDBs::redo()
+{
+  invert ? destroy() : create();
+}
+
+void gui::DesignPanel::CreateDBs::create()
+{
+  QList<prim::Item*> dbs;
+  dbs.reserve(lat_coords.size());
+  for (const prim::LatticeCoord &l_coord : lat_coords) {
+    prim::DBDot *new_db = new prim::DBDot(l_coord, layer_index);
+    dp->lattice->setOccupied(l_coord, new_db);
+    new_db->setPos(dp->lattice->latticeCoord2ScenePos(l_coord));
+    dbs.append(new_db);
+  }
+  dp->addItems(dbs, layer_index, indices);
+}
+
+void gui::DesignPanel::CreateDBs::destroy()
+{
+  QList<prim::Item*> dbs;
+  dbs.reserve(lat_coords.size());
+  for (const prim::LatticeCoord &l_coord : lat_coords) {
+    // indices are only valid if every DB is removed
+    prim::DBDot *db = dp->lattice->dbAt(l_coord);
+    if (!db)
+      qFatal("Trying to remove a non-existing DB");
+    dp->lattice->setUnoccupied(l_coord);
+    dbs.append(db);
+  }
+  dp->removeItems(dbs, dp->layman->getLayer(layer_index));
+}
+
+
 // CreatePotPlot class
 gui::DesignPanel::CreatePotPlot::CreatePotPlot(gui::DesignPanel *dp, QString pot_plot_path, QRectF graph_container, QString pot_anim_path, prim::PotPlot *pp, bool invert, QUndoCommand *parent)
   : QUndoCommand(parent), dp(dp), pot_plot_path(pot_plot_path), graph_container(graph_container), pot_anim_path(pot_anim_path), pp(pp), invert(invert)
@@ -2022,7 +2256,7 @@ gui::DesignPanel::CreateTextLabel::CreateTextLabel(int layer_index,
     scene_rect(scene_rect), text(text)
 {
   prim::Layer *layer = dp->layman->getLayer(layer_index);
-  item_index = invert ? layer->getItems().indexOf(text_lab) : layer->getItems().size();
+  item_index = invert ? layer->getItemIndex(text_lab) : layer->getItems().size();
 }
 
 void gui::DesignPanel::CreateTextLabel::undo()
@@ -2063,7 +2297,7 @@ gui::DesignPanel::EditTextLabel::EditTextLabel(int layer_index, DesignPanel *dp,
     text_new(new_text)
 {
   prim::Layer *layer= dp->layman->getLayer(layer_index);
-  item_index = layer->getItems().indexOf(text_lab);
+  item_index = layer->getItemIndex(text_lab);
   text_orig = text_lab->text();
 }
 
@@ -2096,7 +2330,7 @@ gui::DesignPanel::CreateItem::CreateItem(int layer_index, DesignPanel *dp,
     item(item)
 {
   prim::Layer *layer = dp->layman->getLayer(layer_index);
-  item_index = invert ? layer->getItems().indexOf(item) : layer->getItems().size();
+  item_index = invert ? layer->getItemIndex(item) : layer->getItems().size();
   in_scene = invert ? true : false;
 }
 
@@ -2243,10 +2477,9 @@ gui::DesignPanel::FormAggregate::FormAggregate(QList<prim::Item *> &items,
       return;
     }
 
-  // format the input items to a pointer invariant form, TODO could be done more efficiently
-  QStack<prim::Item*> layer_items = layer->getItems();
+  // format the input items to a pointer invariant form
   for(prim::Item *item : items)
-    item_inds.append(layer_items.indexOf(item));
+    item_inds.append(layer->getItemIndex(item));
   std::sort(item_inds.begin(), item_inds.end());
 }
 
@@ -2261,12 +2494,11 @@ gui::DesignPanel::FormAggregate::FormAggregate(prim::Aggregate *agg, int offset,
   prim::Layer *layer = dp->layman->getLayer(layer_index);
 
   // aggregate index
-  QStack<prim::Item*> layer_items = layer->getItems();
-  agg_index = layer_items.indexOf(agg);
+  agg_index = layer->getItemIndex(agg);
 
   // doesn't really matter where we add the items from the aggregate to the layer
   // item stack... add to the end
-  for(int i=layer_items.count()-1, j=0; j < agg->getChildren().count(); j++)
+  for(int i=layer->getItems().count()-1, j=0; j < agg->getChildren().count(); j++)
     item_inds.append(i+j+offset);
 }
 
@@ -2289,7 +2521,7 @@ void gui::DesignPanel::FormAggregate::form()
 
   // all items should be in the same layer as the aggregate was and have no parents
   prim::Item *item=0;
-  QStack<prim::Item*> layer_items = layer->getItems();
+  const QStack<prim::Item*> &layer_items = layer->getItems();
   for(const int &ind : item_inds){
     if(ind >= layer_items.size())
       qFatal("Undo/Redo mismatch... something went wrong");
@@ -2351,7 +2583,7 @@ gui::DesignPanel::MoveItem::MoveItem(prim::Item *item, const QPointF &offset,
 {
   layer_index = item->layer_id;
   // qDebug() << dp->layman->getLayer(layer_index)->getItemIndex(item);
-  item_index = dp->layman->getLayer(layer_index)->getItems().indexOf(item);
+  item_index = dp->layman->getLayer(layer_index)->getItemIndex(item);
 }
 
 
@@ -2643,11 +2875,9 @@ void gui::DesignPanel::createDBs(prim::LatticeCoord lat_coord)
   if (lat_list.isEmpty()) {
     return;
   }
-  undo_stack->beginMacro(tr("create dangling bonds"));
-  for (prim::LatticeCoord lc: lat_list) {
-    undo_stack->push(new CreateDB(lc, layer_index, this));
-  }
-  undo_stack->endMacro();
+  CreateDBs *create_dbs = new CreateDBs(lat_list, layer_index, this);
+  create_dbs->setText(tr("create %1 dangling bonds").arg(lat_list.size()));
+  undo_stack->push(create_dbs);
 }
 
 void gui::DesignPanel::createElectrode(QRect scene_rect)
@@ -2751,11 +2981,11 @@ void gui::DesignPanel::deleteSelection()
   qDebug() << tr("Deleting %1 items").arg(selection.count());
 
   undo_stack->beginMacro(tr("delete %1 items").arg(selection.count()));
+  deleteDBs(selection);
   for(prim::Item *item : selection){
     switch(item->item_type){
       case prim::Item::DBDot:
-        undo_stack->push(new CreateDB(static_cast<prim::DBDot*>(item)->latticeCoord(),
-                                      item->layer_id, this, 0, true));
+        // already deleted in bulk
         break;
       case prim::Item::Aggregate:
         destroyAggregate(static_cast<prim::Aggregate*>(item));
@@ -2778,6 +3008,21 @@ void gui::DesignPanel::deleteSelection()
 }
 
 
+void gui::DesignPanel::deleteDBs(const QList<prim::Item*> &items)
+{
+  // one bulk command per layer holding DBs
+  QMap<int, QList<prim::LatticeCoord>> coords_by_layer;
+  for (prim::Item *item : items)
+    if (item->item_type == prim::Item::DBDot)
+      coords_by_layer[item->layer_id].append(static_cast<prim::DBDot*>(item)->latticeCoord());
+  for (auto it=coords_by_layer.constBegin(); it!=coords_by_layer.constEnd(); ++it) {
+    CreateDBs *delete_dbs = new CreateDBs(it.value(), it.key(), this, true);
+    delete_dbs->setText(tr("delete %1 dangling bonds").arg(it.value().size()));
+    undo_stack->push(delete_dbs);
+  }
+}
+
+
 void gui::DesignPanel::formAggregate(QList<prim::Item*> items)
 {
   QList<prim::Item*> selection = items;
@@ -2846,12 +3091,9 @@ void gui::DesignPanel::destroyAggregate(prim::Aggregate *agg)
   undo_stack->push(new FormAggregate(agg, 0, this));
 
   // recursively destroy all children using undo/redo enabled methods
+  deleteDBs(items.toList());
   for(prim::Item* item : items){
     switch(item->item_type){
-      case prim::Item::DBDot:
-        undo_stack->push(new CreateDB(static_cast<prim::DBDot*>(item)->latticeCoord(),
-                                      item->layer_id, this, 0, true));
-        break;
       case prim::Item::Aggregate:
         destroyAggregate(static_cast<prim::Aggregate*>(item));
         break;
@@ -2886,10 +3128,26 @@ bool gui::DesignPanel::pasteAtGhost()
 
   undo_stack->beginMacro(tr("Paste %1 items").arg(clipboard.count()));
 
+  // DBs which aren't part of an aggregate are pasted in bulk, skipping sites
+  // where copies overlap
+  QList<prim::LatticeCoord> db_coords;
+  QSet<prim::LatticeCoord> db_coord_set;
   for(int i=0; i<ghost->getCount(); i++){
-    for(prim::Item *item : ghost->getTopItems())
-      pasteItem(ghost, i, item);
+    for(prim::Item *item : ghost->getTopItems()){
+      if(item->item_type == prim::Item::DBDot){
+        prim::LatticeCoord coord = ghost->getLatticeCoord(static_cast<prim::DBDot*>(item), i);
+        if(lattice->isValid(coord) && !db_coord_set.contains(coord)){
+          db_coords.append(coord);
+          db_coord_set.insert(coord);
+        }
+      } else {
+        pasteItem(ghost, i, item);
+      }
+    }
   }
+  if(!db_coords.isEmpty())
+    undo_stack->push(new CreateDBs(db_coords,
+          layman->indexOf(layman->getMRULayer(prim::Layer::DB)), this));
   undo_stack->endMacro();
 
   pasting=false;
@@ -101,6 +101,16 @@ namespace gui{
     //! Remove the given Item from the given Layer if possible.
     void removeItem(prim::Item *item, prim::Layer* layer, bool retain_item=false);
 
+    //! Add a batch of new Items to the Layer at the given layer_index, each at
+    //! the given index of the resulting Layer Item stack. Indices must be
+    //! ascending. The scene and item manager are updated once for the batch.
+    void addItems(const QList<prim::Item*> &items, int layer_index,
+        const QList<int> &indices);
+
+    //! Remove a batch of Items from the given Layer and delete them. The scene
+    //! and item manager are updated once for the batch.
+    void removeItems(const QList<prim::Item*> &items, prim::Layer *layer);
+
     //! Add a new Item to the graphics scene without adding it to a layer. This
     //! either means the Item is already owned by another class and only needs
     //! to be shown graphically, or the Item is merely a temporary graphics
@@ -173,6 +183,9 @@ namespace gui{
     //! Save layers and items into the given write stream.
     void writeToXmlStream(QXmlStreamWriter *, DesignInclusionArea);
 
+    //! Add layers and items to a binary simulation problem.
+    void writeToBinaryProblem(comp::BinaryProblem *, DesignInclusionArea);
+
 
     // LOAD
 
@@ -210,6 +223,10 @@ namespace gui{
     //! Display the simulation result from PoisSolver
     void displayPotentialPlot(QString pot_plot_path, QRectF graph_container, QString pot_anim_path);
 
+    //! Display a potential raster pyramid rendered by SiQAD itself, the 
+    //! graph_container is in scene coordinates.
+    void displayPotentialRaster(const QVector<QImage> &pyramid, QRectF graph_container);
+
     //! Show the color dialog, adding the target items into the list of items to recolor.
     void showColorDialog(QList<prim::Item*> target_items);
 
@@ -252,6 +269,10 @@ namespace gui{
     //! Update background to match current display mode and zoom level.
     void updateBackground();
 
+    //! Switch DBs between full and low detail to match the current display
+    //! mode and zoom level.
+    void updateLevelOfDetail();
+
     //! Edit text label
     void editTextLabel(prim::Item *text_lab, const QString &new_text);
 
@@ -321,6 +342,10 @@ namespace gui{
 
     void dragEnterEvent(QDragEnterEvent *e) Q_DECL_OVERRIDE;
 
+    //! Draw the DBs in the exposed region as single pixels when they are
+    //! shown in low detail.
+    void drawForeground(QPainter *painter, const QRectF &rect) Q_DECL_OVERRIDE;
+
   private slots:
     void undoAction();
     void redoAction();
@@ -351,6 +376,7 @@ namespace gui{
     static QColor background_col;         // normal background color
     static QColor background_col_publish; // background color in publishing mode
     static qreal zoom_visibility_threshold;
+    static qreal dbdot_lod_threshold;     // zoom below which DBs are shown in low detail
 
     // Common actions used in the design panel
     QAction *action_undo;       // reverse in the undo stack
@@ -493,6 +519,7 @@ namespace gui{
     class ResizeItem;       // resize a ResizableRect
 
     class CreateDB;         // create a dangling bond at a given lattice dot
+    class CreateDBs;        // create dangling bonds at many lattice dots at once
     class FormAggregate;    // form an aggregate from a list of Items
 
     class CreateLayer;      // create a new layer
@@ -536,6 +563,9 @@ namespace gui{
     // delete all selected items
     void deleteSelection();
 
+    // delete the DBDots among the given items with one bulk command per layer
+    void deleteDBs(const QList<prim::Item*> &items);
+
     // create an aggregate from the provided list or from selected surface Items
     void formAggregate(QList<prim::Item*> items=QList<prim::Item*>());
 
@@ -595,6 +625,37 @@ namespace gui{
   };
 
 
+  class DesignPanel::CreateDBs : public QUndoCommand
+  {
+  public:
+    //! Create dangling bonds at the given lattice dots in one batch, set invert
+    //! if deleting the DBs at those lattice dots instead.
+    CreateDBs(const QList<prim::LatticeCoord> &l_coords, int layer_index,
+        DesignPanel *dp, bool invert=false, QUndoCommand *parent=0);
+
+    // destroy or re-create the dangling bonds
+    virtual void undo();
+
+    // re-create or destroy the dangling bonds
+    virtual void redo();
+
+  private:
+
+    void create();    // create the dangling bonds
+    void destroy();   // destroy the dangling bonds
+
+    bool invert;      // swaps create/delete on redo/undo
+
+    QVector<prim::LatticeCoord> lat_coords; // lattice dots in item stack order
+
+    DesignPanel *dp;  // DesignPanel pointer
+    int layer_index;  // index of layer in dp->layers stack
+
+    // internals
+    QList<int> indices; // ascending indices of the DBDots in the layer item stack
+  };
+
+
   class DesignPanel::FormAggregate : public QUndoCommand
   {
   public:
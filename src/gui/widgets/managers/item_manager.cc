@@ -118,6 +118,11 @@ void ItemManager::addItemRow(prim::Item *item)
       return;
     }
   }
+  appendItemRow(item);
+}
+
+void ItemManager::appendItemRow(prim::Item *item)
+{
   ItemTableRowContent *new_content = new ItemTableRowContent();
   new_content->item = item;
   new_content->type = new QTableWidgetItem(item->getQStringItemType());
@@ -163,6 +168,34 @@ void ItemManager::updateTableRemove(prim::Item *item)
   }
 }
 
+void ItemManager::updateTableAdd(const QList<prim::Item*> &items)
+{
+  // only rows of items not yet in the table are added
+  QSet<prim::Item*> listed;
+  for (ItemTableRowContent* row_content: table_row_contents)
+    listed.insert(row_content->item);
+  item_table->setUpdatesEnabled(false);
+  for (prim::Item *item : items)
+    if (item != 0 && !listed.contains(item))
+      appendItemRow(item);
+  item_table->setUpdatesEnabled(true);
+}
+
+void ItemManager::updateTableRemove(const QList<prim::Item*> &items)
+{
+  // table rows are in the same order as table_row_contents
+  QSet<prim::Item*> rm_set = QSet<prim::Item*>::fromList(items);
+  item_table->setUpdatesEnabled(false);
+  for (int row=table_row_contents.size()-1; row>=0; row--) {
+    if (rm_set.contains(table_row_contents.at(row)->item)) {
+      ItemTableRowContent *row_content = table_row_contents.takeAt(row);
+      item_table->removeRow(row);
+      delete row_content;
+    }
+  }
+  item_table->setUpdatesEnabled(true);
+}
+
 TableWidget::TableWidget(QWidget *parent)
   :QTableWidget(parent)
 {
@@ -47,6 +47,12 @@ namespace gui{
   public slots:
     void updateTableAdd();
     void updateTableRemove(prim::Item* item);
+
+    //! Add rows for a batch of items which were just added.
+    void updateTableAdd(const QList<prim::Item*> &items);
+
+    //! Remove the rows of a batch of items.
+    void updateTableRemove(const QList<prim::Item*> &items);
     void showProperties();
     void updateItemSelection();
     void deleteItemSelection();
@@ -55,6 +61,7 @@ namespace gui{
     void initItemManager();
     void initItemTableHeaders();
     void addItemRow(prim::Item *item);
+    void appendItemRow(prim::Item *item);
     void clearItemTable();
 
     LayerManager *layman;
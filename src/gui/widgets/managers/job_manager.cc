@@ -55,12 +55,18 @@ void JobManager::addJob(comp::SimJob *job)
   QList<QStandardItem*> row_job_info;
   row_job_info.append(new QStandardItem(job->name()));
   job_view_model->insertRow(0, row_job_info); // prepend row
+  job_view_items.insert(job, row_job_info.first());
+  // the address of a deleted job may be reused by a later one
+  connect(job, &QObject::destroyed, this,
+          [this, job](){job_view_items.remove(job);});
 
   QList<QWidget*> row_widgets({
         job->guiControlElems().pb_terminate,
         job->guiControlElems().pb_sim_visualize,
         job->guiControlElems().pb_job_terminal
       });
+  if (job->isParameterSweep())
+    row_widgets.append(job->guiControlElems().pb_sweep_summary);
 
   tv_job_view->resizeColumnToContents(0);
   QModelIndex mi_back = job_view_model->indexFromItem(row_job_info.back());
@@ -75,16 +81,81 @@ void JobManager::addJob(comp::SimJob *job)
 void JobManager::runJob(comp::SimJob *job)
 {
   addJob(job);
-  job->beginJob();
+  if (job_queue.contains(job) || running_jobs.contains(job))
+    return;
+
+  // export problem files now so the job captures the design at submission time
+  job->queueJob();
+  job_queue.append(job);
+  scheduleJobs();
+}
+
+void JobManager::scheduleJobs()
+{
+  // free slots are recomputed on every iteration since a job that fails to 
+  // begin releases its slots through processFinishedJob
+  int free_slots;
+  while (!job_queue.isEmpty()
+      && (free_slots = maxWorkerSlots() - occupiedWorkerSlots()) > 0) {
+    comp::SimJob *job = job_queue.takeFirst();
+    job->setMaxParallelSteps(qMin(free_slots, job->stepConcurrency()));
+    running_jobs.append(job);
+    qDebug() << tr("Starting job %1 with %2 worker slot(s) (%3 running, %4 queued).")
+      .arg(job->name()).arg(job->maxParallelSteps())
+      .arg(running_jobs.length()).arg(job_queue.length());
+    if (!job->beginJob()) {
+      qWarning() << tr("Job %1 failed to begin.").arg(job->name());
+      // processFinishedJob releases the worker slot
+      job->jobFinishActions(comp::SimJob::FinishedWithError);
+    }
+  }
+}
+
+int JobManager::occupiedWorkerSlots() const
+{
+  int slots = 0;
+  for (comp::SimJob *job : running_jobs)
+    slots += job->maxParallelSteps();
+  return slots;
+}
+
+int JobManager::maxWorkerSlots() const
+{
+  settings::AppSettings *app_settings = settings::AppSettings::instance();
+  // the limit was stored as max_concurrent_jobs before it counted job steps,
+  // keep honouring it until the new key is set
+  QString key = (!app_settings->contains("plugs/max_worker_slots")
+                 && app_settings->contains("plugs/max_concurrent_jobs"))
+    ? "plugs/max_concurrent_jobs" : "plugs/max_worker_slots";
+  int max_slots = app_settings->get<int>(key);
+  if (max_slots <= 0)
+    max_slots = QThread::idealThreadCount();
+  return qMax(1, max_slots);
 }
 
 void JobManager::processFinishedJob(comp::SimJob *job, comp::SimJob::JobState)
 {
+  // release the worker slot (or drop the job from the queue if it was 
+  // terminated before being invoked) and start the next queued jobs
+  job_queue.removeOne(job);
+  running_jobs.removeOne(job);
+  scheduleJobs();
+
   // TODO if successful, check that result files are all successfully read (add
   // a flag in job steps to facilitate this)
 
   // update GUI elements in job manager
-
+  // list the resource usage of each step under the job
+  QStandardItem *job_item = job_view_items.value(job);
+  if (job_item != nullptr) {
+    for (comp::JobStep *js : job->jobSteps()) {
+      QString usage = tr("Step %1: %2 s wall, %3").arg(js->jobStepPlacement())
+        .arg(js->wallTime(), 0, 'f', 2).arg(js->resourceUsage().summary());
+      if (!js->exceededLimit().isEmpty())
+        usage += tr(", killed for exceeding the %1").arg(js->exceededLimit());
+      job_item->appendRow(new QStandardItem(usage));
+    }
+  }
 
   // execute SQCommands if any is available
   // TODO allow users to make execution manual and prompt user before execution
@@ -481,6 +552,69 @@ QWidget *JobManager::initJobSetupPanel()
               mb_no_js.exec();
               return;
             }
+            // check for parameter sweeps, which are only supported for single 
+            // step jobs
+            EngineDataset *sweep_dataset = nullptr;
+            QMap<QString, QStringList> sweep_values;
+            for (int i=0; i<job_steps_model->rowCount(); i++) {
+              QStandardItem *si_job_step = job_steps_model->item(i);
+              EngineDataset *eng_dataset = static_cast<JobStepViewListItem*>(si_job_step)->eng_dataset;
+              if (eng_dataset == nullptr || eng_dataset->isEmpty()
+                  || eng_dataset->sweep_spec.trimmed().isEmpty())
+                continue;
+              QString err_msg;
+              if (job_steps_model->rowCount() != 1) {
+                err_msg = "Parameter sweeps are only supported for jobs with a single job step.";
+              } else if (!comp::SimJob::parseSweepSpec(eng_dataset->sweep_spec, 
+                                                       sweep_values, &err_msg)) {
+                err_msg = tr("Invalid parameter sweep: %1").arg(err_msg);
+              } else {
+                gui::PropertyMap props = eng_dataset->prop_form->finalProperties();
+                for (const QString &key : sweep_values.keys()) {
+                  if (!props.contains(key)) {
+                    err_msg = tr("Swept parameter '%1' is not a parameter of %2.")
+                      .arg(key).arg(eng_dataset->engine->name());
+                    break;
+                  }
+                }
+              }
+              if (!err_msg.isEmpty()) {
+                QMessageBox mb_sweep_err;
+                mb_sweep_err.setText(err_msg);
+                mb_sweep_err.exec();
+                return;
+              }
+              sweep_dataset = eng_dataset;
+            }
+
+            // rows without an engine dataset don't become job steps, 
+            // dependencies refer to the placements of the steps created
+            QList<EngineDataset*> row_datasets;
+            QList<bool> rows_with_steps;
+            for (int i=0; i<job_steps_model->rowCount(); i++) {
+              QStandardItem *si_job_step = job_steps_model->item(i);
+              EngineDataset *eng_dataset = static_cast<JobStepViewListItem*>(si_job_step)->eng_dataset;
+              row_datasets.append(eng_dataset);
+              rows_with_steps.append(eng_dataset != nullptr && !eng_dataset->isEmpty());
+            }
+            QList<int> step_placements = comp::SimJob::stepPlacements(rows_with_steps);
+
+            // check job step dependencies
+            for (int i=0; i<row_datasets.length(); i++) {
+              EngineDataset *eng_dataset = row_datasets.at(i);
+              QList<int> deps;
+              QString err_msg;
+              if (step_placements.at(i) != -1 && (!comp::SimJob::parseDependencySpec(
+                    eng_dataset->dependency_spec, step_placements.at(i), deps, &err_msg)
+                  || !comp::JobStep::checkResultPathKeywords(
+                    eng_dataset->command_format.split("\n"), deps, &err_msg))) {
+                QMessageBox mb_dep_err;
+                mb_dep_err.setText(tr("Invalid job step dependencies: %1").arg(err_msg));
+                mb_dep_err.exec();
+                return;
+              }
+            }
+
             hide();
             auto job_details = job_details_pane->finalJobDetails();
             if (job_details.name.isEmpty()) {
@@ -489,15 +623,26 @@ QWidget *JobManager::initJobSetupPanel()
             // create sim job and submit to application
             comp::SimJob *new_job = new comp::SimJob(job_details.name);
             new_job->setInclusionArea(job_details.inclusion_area);
-            for (int i=0; i<job_steps_model->rowCount(); i++) {
-              QStandardItem *si_job_step = job_steps_model->item(i);
-              EngineDataset *eng_dataset = static_cast<JobStepViewListItem*>(si_job_step)->eng_dataset;
-              if (eng_dataset == nullptr || eng_dataset->isEmpty())
+            new_job->setForceRerun(job_details.force_rerun);
+            if (sweep_dataset != nullptr) {
+              new_job->addParameterSweep(sweep_dataset->engine,
+                                         sweep_dataset->command_format.split("\n"),
+                                         sweep_dataset->prop_form->finalProperties(),
+                                         sweep_values);
+            }
+            for (int i=0; i<row_datasets.length() && sweep_dataset == nullptr; i++) {
+              if (step_placements.at(i) == -1)
                 continue;
+              EngineDataset *eng_dataset = row_datasets.at(i);
               // create a sim job step and add it to the job
-              new_job->addJobStep(new comp::JobStep(eng_dataset->engine,
-                                                    eng_dataset->command_format.split("\n"),
-                                                    eng_dataset->prop_form->finalProperties()));
+              comp::JobStep *job_step = new comp::JobStep(eng_dataset->engine,
+                                                          eng_dataset->command_format.split("\n"),
+                                                          eng_dataset->prop_form->finalProperties());
+              QList<int> deps;
+              comp::SimJob::parseDependencySpec(eng_dataset->dependency_spec,
+                                                step_placements.at(i), deps);
+              job_step->setDependencies(deps);
+              new_job->addJobStep(job_step);
             }
             runJob(new_job);
           });
@@ -527,7 +672,7 @@ QWidget *JobManager::initJobSetupPanel()
 QWidget *JobManager::initJobViewPanel()
 {
   job_view_model = new QStandardItemModel();
-  job_view_model->setColumnCount(4);  // TODO make dynamic
+  job_view_model->setColumnCount(5);  // TODO make dynamic
   tv_job_view = new QTreeView();
   tv_job_view->header()->setStretchLastSection(false);
   tv_job_view->setModel(job_view_model);
@@ -563,6 +708,7 @@ JobSetupDetailsPane::JobSetupDetailsPane(QWidget *parent)
   QGroupBox *gb_plugin_props = new QGroupBox("Plugin Invocation");
   QGroupBox *gb_plugin_status = new QGroupBox("Plugin Status");
   QGroupBox *gb_plugin_params = new QGroupBox("Plugin Runtime Parameters");
+  QGroupBox *gb_sweep = new QGroupBox("Parameter Sweep");
 
   // Job
   le_job_name = new QLineEdit();
@@ -570,6 +716,9 @@ JobSetupDetailsPane::JobSetupDetailsPane(QWidget *parent)
   QCheckBox *cb_auto_job_name = new QCheckBox("Auto job name");
   cb_auto_job_name->setChecked(true);
   cbb_inclusion_area = new QComboBox();
+  cb_force_rerun = new QCheckBox("Force rerun");
+  cb_force_rerun->setToolTip("Invoke the plugins even if results of an "
+      "identical job step are available in the result cache.");
 
   // response to auto job name checkbox
   auto autoJobNameResponse = [this](int check_state)
@@ -595,6 +744,7 @@ JobSetupDetailsPane::JobSetupDetailsPane(QWidget *parent)
   fl_job_props->addRow(new QLabel("Job name"), le_job_name);
   fl_job_props->addRow(hl_auto_job_name);
   fl_job_props->addRow(new QLabel("Inclusion area"), cbb_inclusion_area);
+  fl_job_props->addRow(cb_force_rerun);
   fl_job_props->setSizeConstraint(QLayout::SetMinimumSize);
   gb_job_props->setLayout(fl_job_props);
 
@@ -614,11 +764,29 @@ JobSetupDetailsPane::JobSetupDetailsPane(QWidget *parent)
   hl_command->addStretch();
   hl_command->addWidget(tb_command_preset);
 
+  le_dependencies = new QLineEdit();
+  le_dependencies->setPlaceholderText("previous step");
+  le_dependencies->setToolTip("Comma separated list of earlier steps (counting "
+      "from 0) which must finish before this step starts, or 'none' to start "
+      "right away. Steps whose dependencies are satisfied run concurrently. "
+      "Result files of dependencies can be passed to the command as "
+      "@RESULTPATH_<step>@. Leave empty to run after the previous step.");
+
   QFormLayout *fl_plugin_props = new QFormLayout();
   fl_plugin_props->addRow(hl_command);
   fl_plugin_props->addRow(te_command);
+  fl_plugin_props->addRow(new QLabel("Depends on steps"), le_dependencies);
   gb_plugin_props->setLayout(fl_plugin_props);
 
+  // update dependency specification in engine dataset to the newest content
+  connect(le_dependencies, &QLineEdit::textChanged,
+          [this](const QString &text)
+          {
+            if (eng_dataset == nullptr)
+              return;
+            eng_dataset->dependency_spec = text;
+          });
+
   // update command format in engine dataset to the newest textedit content
   connect(te_command, &QTextEdit::textChanged,
           [this]()
@@ -651,11 +819,32 @@ JobSetupDetailsPane::JobSetupDetailsPane(QWidget *parent)
   vl_plugin_params = new QVBoxLayout();
   gb_plugin_params->setLayout(vl_plugin_params);
 
+  // Parameter Sweep
+  te_sweep = new QPlainTextEdit();
+  te_sweep->setPlaceholderText("mu = -0.32:-0.25:0.01\nT_init = 500, 1000");
+  te_sweep->setToolTip("One swept parameter per line, either as an inclusive "
+      "range 'key = start:stop:step' or as a list 'key = v1, v2, v3'. A job "
+      "step is created for every combination of values and the steps are run "
+      "in parallel. Leave empty to run a single step.");
+  QVBoxLayout *vl_sweep = new QVBoxLayout();
+  vl_sweep->addWidget(te_sweep);
+  gb_sweep->setLayout(vl_sweep);
+
+  // update sweep specification in engine dataset to the newest content
+  connect(te_sweep, &QPlainTextEdit::textChanged,
+          [this]()
+          {
+            if (eng_dataset == nullptr)
+              return;
+            eng_dataset->sweep_spec = te_sweep->toPlainText();
+          });
+
   QVBoxLayout *vl_pane = new QVBoxLayout();
   vl_pane->addWidget(gb_job_props);
   vl_pane->addWidget(gb_plugin_props);
   vl_pane->addWidget(gb_plugin_status);
   vl_pane->addWidget(gb_plugin_params);
+  vl_pane->addWidget(gb_sweep);
   vl_pane->addStretch();
   setLayout(vl_pane);
 }
@@ -684,11 +873,15 @@ void JobSetupDetailsPane::setEngineDataset(JobManager::EngineDataset *t_eng_data
   if (eng_dataset == nullptr) {
     // no dataset selected, clear GUI elements
     te_command->setText("");
+    te_sweep->setPlainText("");
+    le_dependencies->setText("");
     menu_command_preset->clear();
     return;
   }
 
   te_command->setText(eng_dataset->command_format);
+  te_sweep->setPlainText(eng_dataset->sweep_spec);
+  le_dependencies->setText(eng_dataset->dependency_spec);
 
   // update engine command preset menu
   menu_command_preset->clear();
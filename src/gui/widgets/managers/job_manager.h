@@ -61,6 +61,8 @@ namespace gui{
       uint id=0;
       comp::PluginEngine *engine=nullptr;
       QString command_format;           // command format with arguments delimited by "\n".
+      QString sweep_spec;               // parameter sweep specification, see SimJob::parseSweepSpec
+      QString dependency_spec;          // job step dependencies, see SimJob::parseDependencySpec
       PropertyForm *prop_form=nullptr;
     };
 
@@ -77,9 +79,32 @@ namespace gui{
     void addJob(comp::SimJob *job);
 
     //! Run the specified job, if the job hasn't already been added to the 
-    //! manager it will be added.
+    //! manager it will be added. The job's problem files are exported right
+    //! away but the job is only invoked once a worker slot is available (see
+    //! maxWorkerSlots()).
     void runJob(comp::SimJob *job);
 
+    //! Invoke queued jobs in FIFO order until all worker slots are occupied
+    //! or the queue is empty. Jobs whose steps may run concurrently
+    //! (e.g. parameter sweeps) are granted as many worker slots as are free, 
+    //! up to their step concurrency.
+    void scheduleJobs();
+
+    //! Return the number of worker slots occupied by running jobs.
+    int occupiedWorkerSlots() const;
+
+    //! Return the number of worker slots, i.e. the maximum number of job steps
+    //! allowed to run at the same time across all jobs. Taken from the 
+    //! application settings, falls back to the CPU core count if the setting
+    //! is not a positive number.
+    int maxWorkerSlots() const;
+
+    //! Return the number of jobs waiting for a worker slot.
+    int queuedJobCount() const {return job_queue.length();}
+
+    //! Return the number of jobs currently running.
+    int runningJobCount() const {return running_jobs.length();}
+
     //! Process a finished job.
     void processFinishedJob(comp::SimJob *job, comp::SimJob::JobState finish_state);
 
@@ -154,6 +179,9 @@ namespace gui{
     SimVisualizer *sim_visualizer;         // pointer to the sim_visualizer
 
     QList<comp::SimJob*> sim_jobs;        // list of all jobs
+    QMap<comp::SimJob*, QStandardItem*> job_view_items; // job rows in the job view
+    QList<comp::SimJob*> job_queue;       // jobs waiting for a worker slot (FIFO)
+    QList<comp::SimJob*> running_jobs;    // jobs currently occupying a worker slot
     QListView *lv_engines;                // list view of engines in the engine list
     QListView *lv_job_steps;              // list view of job steps
     QTreeView *tv_job_view;               // tree view of all jobs
@@ -206,6 +234,7 @@ namespace gui{
     {
       QString name;
       gui::DesignInclusionArea inclusion_area;
+      bool force_rerun;
     };
 
     //! Constructor.
@@ -230,6 +259,7 @@ namespace gui{
       QMetaEnum inc_a_enum = QMetaEnum::fromType<IA>();
       job_details.inclusion_area = static_cast<IA>(inc_a_enum.keyToValue(
             cbb_inclusion_area->currentText().toLatin1()));
+      job_details.force_rerun = cb_force_rerun->isChecked();
       return job_details;
     }
     
@@ -239,11 +269,14 @@ namespace gui{
     JobManager::EngineDataset *eng_dataset=nullptr; // currently used engine dataset
     QLineEdit *le_job_name;                         // job name
     QComboBox *cbb_inclusion_area;                  // inclusion area
+    QCheckBox *cb_force_rerun;                      // ignore cached results
     QLabel *l_plugin_name;                          // plugin name
     QLabel *l_plugin_status;                        // plugin status
     QPushButton *pb_refresh_status;                 // refresh the plugin status
     QMenu *menu_command_preset;                     // command format preset selection menu
     QTextEdit *te_command;                          // command format edit field
+    QPlainTextEdit *te_sweep;                       // parameter sweep specification edit field
+    QLineEdit *le_dependencies;                     // job step dependencies edit field
     QVBoxLayout *vl_plugin_params;                  // layout holding engine property form
   };
 
@@ -295,6 +295,19 @@ void LayerManager::saveLayerItems(QXmlStreamWriter *ws, DesignInclusionArea incl
     layer->saveItems(ws, inclusion_area);
 }
 
+void LayerManager::saveLayersBinary(comp::BinaryProblem *problem) const
+{
+  for(prim::Layer *layer : layers)
+    layer->saveLayerBinary(problem);
+}
+
+void LayerManager::saveLayerItemsBinary(comp::BinaryProblem *problem,
+                                        DesignInclusionArea inclusion_area) const
+{
+  for(prim::Layer *layer : layers)
+    layer->saveItemsBinary(problem, inclusion_area);
+}
+
 void LayerManager::tableSelectionChanged(int row)
 {
   //table selection was changed, change the active layer to the one selected.
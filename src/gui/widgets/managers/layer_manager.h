@@ -227,6 +227,12 @@ namespace gui{
     //! Save items contained in all layers to XML stream. TODO improve structure
     void saveLayerItems(QXmlStreamWriter *, DesignInclusionArea) const;
 
+    //! Add all layer properties to a binary simulation problem.
+    void saveLayersBinary(comp::BinaryProblem *) const;
+
+    //! Add items contained in all layers to a binary simulation problem.
+    void saveLayerItemsBinary(comp::BinaryProblem *, DesignInclusionArea) const;
+
 
     // GUI
 
@@ -9,6 +9,7 @@
 #include "aggregate.h"
 #include "dbdot.h"
 #include "hull/hulls.h"
+#include "gui/widgets/components/binary_problem.h"
 
 qreal prim::Aggregate::edge_width;
 QColor prim::Aggregate::edge_col;
@@ -199,6 +200,14 @@ void prim::Aggregate::saveItems(QXmlStreamWriter *stream) const {
   stream->writeEndElement();
 }
 
+void prim::Aggregate::saveItemsBinary(comp::BinaryProblem *problem, int aggregate) const
+{
+  int index = problem->addAggregate(aggregate);
+  for(prim::Item *item : items){
+    item->saveItemsBinary(problem, index);
+  }
+}
+
 
 void prim::Aggregate::prepareStatics()
 {
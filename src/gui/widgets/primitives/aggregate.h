@@ -53,6 +53,7 @@ namespace prim{
 
     // save to file
     virtual void saveItems(QXmlStreamWriter *) const override;
+    virtual void saveItemsBinary(comp::BinaryProblem *, int aggregate) const override;
 
   private:
 
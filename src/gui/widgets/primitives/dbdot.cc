@@ -9,12 +9,14 @@
 
 #include "dbdot.h"
 #include "settings/settings.h"
+#include "gui/widgets/components/binary_problem.h"
 // Initialize statics
 
 qreal prim::DBDot::diameter_m = -1;
 qreal prim::DBDot::diameter_l;
 qreal prim::DBDot::edge_width;
 qreal prim::DBDot::publish_scale;
+bool prim::DBDot::low_detail = false;
 
 prim::Item::StateColors prim::DBDot::fill_col_def;           // normal dbdot
 prim::Item::StateColors prim::DBDot::fill_col_electron;  // contains electron
@@ -139,10 +141,8 @@ QRectF prim::DBDot::boundingRect() const
 }
 
 
-void prim::DBDot::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
+void prim::DBDot::updateStateColors(QColor &fill_col_state, QColor &edge_col_state)
 {
-  QColor fill_col_state;
-  QColor edge_col_state;
   if (display_mode == gui::SimDisplayMode ||
       display_mode == gui::ScreenshotMode) {
     setFill(abs(show_elec));
@@ -165,6 +165,27 @@ void prim::DBDot::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWi
     fill_col_state = getCurrentStateColor(fill_col);
     edge_col_state = getCurrentStateColor(edge_col);
   }
+}
+
+
+QColor prim::DBDot::lowDetailColor()
+{
+  QColor fill_col_state;
+  QColor edge_col_state;
+  updateStateColors(fill_col_state, edge_col_state);
+  return fill_col_state.alpha() != 0 ? fill_col_state : edge_col_state;
+}
+
+
+void prim::DBDot::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
+{
+  // drawn by the design panel instead
+  if (low_detail)
+    return;
+
+  QColor fill_col_state;
+  QColor edge_col_state;
+  updateStateColors(fill_col_state, edge_col_state);
 
   qreal edge_width_paint = edge_width;
   qreal diameter_paint = diameter;
@@ -235,6 +256,18 @@ void prim::DBDot::saveItems(QXmlStreamWriter *ws) const
   ws->writeEndElement();
 }
 
+void prim::DBDot::saveItemsBinary(comp::BinaryProblem *problem, int aggregate) const
+{
+  comp::BinaryProblem::DBDotRecord db;
+  db.x = physloc.x();
+  db.y = physloc.y();
+  db.n = lat_coord.n;
+  db.m = lat_coord.m;
+  db.l = lat_coord.l;
+  db.aggregate = aggregate;
+  problem->addDBDot(db);
+}
+
 
 void prim::DBDot::constructStatics()
 {
@@ -58,9 +58,20 @@ namespace prim{
 
     // SAVE LOAD
     virtual void saveItems(QXmlStreamWriter *) const override;
+    virtual void saveItemsBinary(comp::BinaryProblem *, int aggregate) const override;
     
     virtual QColor getCurrentFillColor() override {return fill_col.normal;}
 
+    //! Set whether DBs are shown in low detail. The design panel then draws
+    //! all visible DBs as single pixels in one pass and paint() does nothing.
+    static void setLowDetail(bool low) {low_detail = low;}
+
+    //! Return whether DBs are shown in low detail.
+    static bool lowDetail() {return low_detail;}
+
+    //! Return the color of the pixel representing this DB in low detail.
+    QColor lowDetailColor();
+
   protected:
     virtual void mousePressEvent(QGraphicsSceneMouseEvent *e) override;
 
@@ -69,6 +80,10 @@ namespace prim{
     // construct static variables
     void constructStatics();
 
+    // pick the fill and edge colors and the dot size for the current display
+    // mode and electron occupation
+    void updateStateColors(QColor &fill_col_state, QColor &edge_col_state);
+
     // VARIABLES
     prim::LatticeCoord lat_coord; // lattice coordinates of the DB
     QPointF physloc;             // physical location
@@ -94,6 +109,7 @@ namespace prim{
     static qreal diameter_l;    // large sized dot
     static qreal edge_width;    // proportional width of dot boundary edge
     static qreal publish_scale; // size scaling factor when in publish screenshot mode
+    static bool low_detail;     // DBs are drawn by the design panel in a batched pass
 
   };
 
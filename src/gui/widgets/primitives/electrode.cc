@@ -9,6 +9,7 @@
 #include <algorithm>
 #include "electrode.h"
 #include "settings/settings.h"
+#include "gui/widgets/components/binary_problem.h"
 
 
 
@@ -248,6 +249,24 @@ void prim::Electrode::saveItems(QXmlStreamWriter *ss) const
   ss->writeEndElement();
 }
 
+void prim::Electrode::saveItemsBinary(comp::BinaryProblem *problem, int aggregate) const
+{
+  comp::BinaryProblem::ElectrodeRecord elec;
+  elec.layer_id = layer_id;
+  elec.electrode_type = getProperty("type").value.toString().toLower() == "clocked" ? 1 : 0;
+  elec.net = getProperty("net").value.toInt();
+  elec.aggregate = aggregate;
+  elec.x1 = sceneRect().topLeft().x()/scale_factor; //convert to angstrom
+  elec.y1 = sceneRect().topLeft().y()/scale_factor;
+  elec.x2 = sceneRect().bottomRight().x()/scale_factor;
+  elec.y2 = sceneRect().bottomRight().y()/scale_factor;
+  elec.potential = getProperty("potential").value.toDouble();
+  elec.phase = getProperty("phase").value.toDouble();
+  elec.angle = getAngleDegrees();
+  elec.pixel_per_angstrom = scale_factor;
+  problem->addElectrode(elec);
+}
+
 void prim::Electrode::mousePressEvent(QGraphicsSceneMouseEvent *e)
 {
   // TODO Nathan do these need to be captured?
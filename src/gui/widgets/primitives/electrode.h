@@ -56,6 +56,7 @@ namespace prim{
 
     // saving to design
     virtual void saveItems(QXmlStreamWriter *) const override;
+    virtual void saveItemsBinary(comp::BinaryProblem *, int aggregate) const override;
 
     //! Return the class default property map
     virtual gui::PropertyMap *classPropertyMap() override {return &default_class_properties;}
@@ -10,6 +10,8 @@
 #include "ghost.h"
 #include "dbdot.h"
 
+#include <algorithm>
+
 
 // GHOSTDOT CLASS
 qreal prim::GhostDot::diameter = -1;
@@ -182,6 +184,11 @@ void prim::Ghost::cleanGhost()
   anchor=0;
   valid_hash.clear();
 
+  displacement = prim::LatticeCoord(0,0,0);
+  footprint_rows.clear();
+  footprint_n_cell = 0;
+  conflict_set = conflict_row = -1;
+
   hide();
 }
 
@@ -217,6 +224,7 @@ void prim::Ghost::moveByCoord(prim::LatticeCoord coord_offset, prim::Lattice *la
   for(int n=0; n < sets.count(); n++)
     for (prim::GhostDot *dot : sets.at(n))
       dot->setLatticeCoord(dot->latticeCoord() + coord_offset*(n+1));
+  displacement = displacement + coord_offset;
   QPointF offset = lattice->latticeCoord2ScenePos(coord_offset);
 
   instance()->translate(offset.x(), offset.y());
@@ -265,13 +273,32 @@ void prim::Ghost::setValid(bool val)
 
 bool prim::Ghost::checkValid(const prim::LatticeCoord &offset, prim::Lattice *lattice)
 {
-
-  for(int n=0; n<sets.count(); n++)
-    for(prim::GhostDot *dot : sets.at(n)){
-      prim::LatticeCoord coord = dot->latticeCoord()+offset*(n+1);
-      if(!lattice->isValid(coord) || lattice->isOccupied(coord))
+  if(sets.isEmpty() || sets.first().isEmpty())
+    return true;
+  if(footprint_n_cell != lattice->cellSiteCount())
+    buildFootprint(lattice->cellSiteCount());
+
+  // set n is displaced by (n+1) times the displacement of the first set, all
+  // of its sites have to remain within their unit cells
+  prim::LatticeCoord shift = displacement + offset;
+  int n_sets = sets.count();
+  if(footprint_l_min + qMin(shift.l, shift.l*n_sets) < 0
+      || footprint_l_max + qMax(shift.l, shift.l*n_sets) >= footprint_n_cell)
+    return false;
+
+  // a conflict found at the previous position usually persists when the
+  // ghost moves by a few sites, test it first
+  if(conflict_set >= 0 && conflict_set < n_sets && conflict_row < footprint_rows.count()
+      && footprintRowOccupied(conflict_set, conflict_row, shift, lattice))
+    return false;
+
+  for(int n=0; n<n_sets; n++)
+    for(int row=0; row<footprint_rows.count(); row++)
+      if(footprintRowOccupied(n, row, shift, lattice)){
+        conflict_set = n;
+        conflict_row = row;
         return false;
-    }
+      }
   return true;
 }
 
@@ -320,6 +347,53 @@ void prim::Ghost::echoNode(QString &s, prim::AggNode *node)
 // PRIVATE METHODS
 
 
+void prim::Ghost::buildFootprint(int n_cell)
+{
+  // collect the site indices of the first set before any move by row
+  QMap<int, QList<qint64>> row_sites;
+  footprint_l_min = n_cell;
+  footprint_l_max = -1;
+  for(prim::GhostDot *dot : sets.first()){
+    prim::LatticeCoord coord = dot->latticeCoord() - displacement;
+    row_sites[coord.m].append(qint64(coord.n)*n_cell + coord.l);
+    footprint_l_min = qMin(footprint_l_min, coord.l);
+    footprint_l_max = qMax(footprint_l_max, coord.l);
+  }
+
+  footprint_rows.clear();
+  for(auto it=row_sites.constBegin(); it!=row_sites.constEnd(); ++it){
+    FootprintRow row;
+    row.m = it.key();
+    row.first_site = *std::min_element(it.value().constBegin(), it.value().constEnd());
+    qint64 last_site = *std::max_element(it.value().constBegin(), it.value().constEnd());
+    row.bits.fill(0, int((last_site - row.first_site) / 64 + 1));
+    for(qint64 site : it.value()){
+      qint64 bit = site - row.first_site;
+      row.bits[int(bit / 64)] |= quint64(1) << (bit % 64);
+    }
+    footprint_rows.append(row);
+  }
+  footprint_n_cell = n_cell;
+  conflict_set = conflict_row = -1;
+}
+
+
+bool prim::Ghost::footprintRowOccupied(int set_ind, int row_ind,
+    const prim::LatticeCoord &shift, prim::Lattice *lattice) const
+{
+  // sites stay within their unit cells, so displacing the ghost shifts the
+  // site indices of a row uniformly
+  qint64 k = set_ind + 1;
+  const FootprintRow &row = footprint_rows.at(row_ind);
+  int m = row.m + int(shift.m*k);
+  qint64 first_site = row.first_site + (qint64(shift.n)*footprint_n_cell + shift.l)*k;
+  for(int i=0; i<row.bits.size(); i++)
+    if(lattice->occupancyWord(m, first_site + 64*i) & row.bits.at(i))
+      return true;
+  return false;
+}
+
+
 prim::Ghost::Ghost()
  : Item(prim::Item::Ghost)
 {
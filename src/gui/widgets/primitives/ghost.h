@@ -199,7 +199,8 @@ namespace prim{
     //! manual set for the validity of the current position
     void setValid(bool val);
 
-    //! check if the current position is valid.
+    //! check if moving the ghost by the given lattice offset would place all
+    //! GhostDots on valid and unoccupied lattice sites.
     bool checkValid(const prim::LatticeCoord &offset, prim::Lattice *lattice);
 
     //! change in position between the first source and GhostDot, for moving Items
@@ -252,6 +253,23 @@ namespace prim{
     // Move the ghost by the given pixel values
     void translate(qreal dx, qreal dy);
 
+    // rasterize the lattice sites of the GhostDots before any move into
+    // footprint_rows for lattices with n_cell sites per unit cell
+    void buildFootprint(int n_cell);
+
+    // return whether the given footprint row of the given set overlaps with
+    // occupied lattice sites when the ghost is displaced by shift
+    bool footprintRowOccupied(int set_ind, int row_ind,
+        const prim::LatticeCoord &shift, prim::Lattice *lattice) const;
+
+    // footprint of the GhostDots in a single unit cell row as a bitmap of
+    // site indices n*n_cell+l, in the layout of the lattice occupancy bitmap
+    struct FootprintRow {
+      int m;                  // unit cell row
+      qint64 first_site;      // site index of the first bit
+      QVector<quint64> bits;  // occupied sites
+    };
+
     QList<Item*> sources;         // list of Item objects for each GhostDot
     prim::AggNode aggnode;        // nested structure of sources
 
@@ -269,6 +287,14 @@ namespace prim{
 
     prim::GhostDot *anchor; // snap anchor
 
+    prim::LatticeCoord displacement;  // lattice offset of the first set since prepare
+    QList<FootprintRow> footprint_rows; // footprint of the first set before any move
+    int footprint_n_cell=0;   // sites per unit cell of the footprint, 0 if not built
+    int footprint_l_min;      // smallest l of the footprint
+    int footprint_l_max;      // largest l of the footprint
+    int conflict_set=-1;      // set of the last found occupied footprint row
+    int conflict_row=-1;      // last found occupied footprint row
+
     QPointF anchor_offset;  // offset of the anchor from the Ghost center
     QPointF zero_offset;    // stored offset for center of Ghost
 
@@ -19,6 +19,11 @@
 #include "settings/settings.h"
 #include "gui/property_map.h"
 
+// forward declaration for comp::BinaryProblem
+namespace comp{
+  class BinaryProblem;
+}
+
 namespace prim{
 
   // forward declaration for prim::Layer
@@ -124,6 +129,9 @@ namespace prim{
 
     // SAVE LOAD
     virtual void saveItems(QXmlStreamWriter *) const {}
+    //! Add the item to a binary simulation problem, aggregate is the index of
+    //! the containing aggregate or -1 for the top level.
+    virtual void saveItemsBinary(comp::BinaryProblem *, int) const {}
     virtual void loadFromFile(QXmlStreamReader *) {} // TODO instead of using this function, switch to using constructor
 
     //! Handy struct for storing various color variables for items when under
@@ -27,6 +27,180 @@ QColor prim::Lattice::lat_edge_col_pb;
 QColor prim::Lattice::lat_fill_col;
 QColor prim::Lattice::lat_fill_col_pb;
 
+// occupancy grid chunks span chunk_dim x chunk_dim unit cells, each row of a
+// chunk then fills exactly n_cell bitmap words
+static const int chunk_shift = 6;
+static const int chunk_dim = 1 << chunk_shift;
+
+static quint64 chunkKey(int chunk_n, int chunk_m)
+{
+  return (quint64(quint32(chunk_n)) << 32) | quint32(chunk_m);
+}
+
+
+void prim::OccupancyGrid::reset(int t_n_cell)
+{
+  clear();
+  n_cell = qMax(t_n_cell, 1);
+}
+
+
+void prim::OccupancyGrid::set(const prim::LatticeCoord &l_coord, prim::DBDot *dbdot)
+{
+  int idx;
+  Chunk *chunk = chunkOf(l_coord, idx);
+  if (chunk == nullptr) {
+    if (dbdot == nullptr || l_coord.l < 0 || l_coord.l >= n_cell)
+      return;
+    // allocate the chunk on first occupation
+    chunk = new Chunk;
+    chunk->dbs.fill(nullptr, chunk_dim * chunk_dim * n_cell);
+    chunk->bits.fill(0, chunk_dim * n_cell);
+    chunks.insert(chunkKey(l_coord.n >> chunk_shift, l_coord.m >> chunk_shift), chunk);
+    cache_valid = false;
+    chunkOf(l_coord, idx);
+  }
+
+  quint64 mask = quint64(1) << (idx & 63);
+  bool was_occupied = chunk->bits[idx >> 6] & mask;
+  chunk->dbs[idx] = dbdot;
+  if (dbdot != nullptr && !was_occupied) {
+    chunk->bits[idx >> 6] |= mask;
+    chunk->count++;
+    occ_count++;
+  } else if (dbdot == nullptr && was_occupied) {
+    chunk->bits[idx >> 6] &= ~mask;
+    chunk->count--;
+    occ_count--;
+    if (chunk->count == 0) {
+      chunks.remove(chunkKey(l_coord.n >> chunk_shift, l_coord.m >> chunk_shift));
+      delete chunk;
+      cache_valid = false;
+    }
+  }
+}
+
+
+void prim::OccupancyGrid::clear()
+{
+  qDeleteAll(chunks);
+  chunks.clear();
+  occ_count = 0;
+  cache_valid = false;
+}
+
+
+prim::DBDot *prim::OccupancyGrid::at(const prim::LatticeCoord &l_coord) const
+{
+  int idx;
+  Chunk *chunk = chunkOf(l_coord, idx);
+  return chunk != nullptr ? chunk->dbs.at(idx) : nullptr;
+}
+
+
+QList<prim::LatticeCoord> prim::OccupancyGrid::unoccupied(
+    const QList<prim::LatticeCoord> &coords) const
+{
+  QList<prim::LatticeCoord> free_coords;
+  free_coords.reserve(coords.size());
+  for (const prim::LatticeCoord &coord : coords)
+    if (!contains(coord))
+      free_coords.append(coord);
+  return free_coords;
+}
+
+
+QList<prim::DBDot*> prim::OccupancyGrid::dbsInRange(int n_min, int m_min,
+    int n_max, int m_max) const
+{
+  QList<prim::DBDot*> dbs;
+  if (occ_count == 0 || n_min > n_max || m_min > m_max)
+    return dbs;
+
+  int row_words = n_cell; // chunk_dim * n_cell bits per row
+  for (int chunk_m = m_min >> chunk_shift; chunk_m <= m_max >> chunk_shift; chunk_m++) {
+    for (int chunk_n = n_min >> chunk_shift; chunk_n <= n_max >> chunk_shift; chunk_n++) {
+      Chunk *chunk = chunks.value(chunkKey(chunk_n, chunk_m), nullptr);
+      if (chunk == nullptr)
+        continue;
+      // bit range of the requested unit cells within each row of the chunk
+      int first_bit = (qMax(n_min - chunk_n * chunk_dim, 0)) * n_cell;
+      int end_bit = (qMin(n_max - chunk_n * chunk_dim, chunk_dim - 1) + 1) * n_cell;
+      int row_first = qMax(m_min - chunk_m * chunk_dim, 0);
+      int row_last = qMin(m_max - chunk_m * chunk_dim, chunk_dim - 1);
+      for (int row = row_first; row <= row_last; row++) {
+        const quint64 *row_bits = chunk->bits.constData() + row * row_words;
+        for (int word_i = first_bit >> 6; word_i <= (end_bit - 1) >> 6; word_i++) {
+          quint64 word = row_bits[word_i];
+          if (word_i == first_bit >> 6)
+            word &= ~quint64(0) << (first_bit & 63);
+          if (word_i == (end_bit - 1) >> 6 && (end_bit & 63) != 0)
+            word &= ~quint64(0) >> (64 - (end_bit & 63));
+          while (word != 0) {
+            int bit = qCountTrailingZeroBits(word);
+            dbs.append(chunk->dbs[row * row_words * 64 + word_i * 64 + bit]);
+            word &= word - 1;
+          }
+        }
+      }
+    }
+  }
+  return dbs;
+}
+
+
+prim::OccupancyGrid::Chunk *prim::OccupancyGrid::chunkOf(
+    const prim::LatticeCoord &l_coord, int &idx) const
+{
+  if (l_coord.l < 0 || l_coord.l >= n_cell)
+    return nullptr;
+  // arithmetic shifts floor negative coordinates into their chunks
+  int chunk_n = l_coord.n >> chunk_shift;
+  int chunk_m = l_coord.m >> chunk_shift;
+  idx = ((l_coord.m - chunk_m * chunk_dim) * chunk_dim
+      + l_coord.n - chunk_n * chunk_dim) * n_cell + l_coord.l;
+  return chunkAt(chunk_n, chunk_m);
+}
+
+
+prim::OccupancyGrid::Chunk *prim::OccupancyGrid::chunkAt(int chunk_n, int chunk_m) const
+{
+  quint64 key = chunkKey(chunk_n, chunk_m);
+  if (!cache_valid || key != cached_key) {
+    cached_chunk = chunks.value(key, nullptr);
+    cached_key = key;
+    cache_valid = true;
+  }
+  return cached_chunk;
+}
+
+
+quint64 prim::OccupancyGrid::occupancyWord(int m, qint64 first_site) const
+{
+  if (occ_count == 0)
+    return 0;
+  // arithmetic shift and mask floor negative site indices
+  qint64 word_i = first_site >> 6;
+  int shift = first_site & 63;
+  quint64 word = rowWord(m, word_i) >> shift;
+  if (shift != 0)
+    word |= rowWord(m, word_i + 1) << (64 - shift);
+  return word;
+}
+
+
+quint64 prim::OccupancyGrid::rowWord(int m, qint64 word_i) const
+{
+  // each chunk row is n_cell words long and continues in the next chunk
+  qint64 chunk_n = word_i >= 0 ? word_i / n_cell : -((n_cell - 1 - word_i) / n_cell);
+  int chunk_m = m >> chunk_shift;
+  Chunk *chunk = chunkAt(int(chunk_n), chunk_m);
+  if (chunk == nullptr)
+    return 0;
+  return chunk->bits.at((m - chunk_m * chunk_dim) * n_cell + int(word_i - chunk_n * n_cell));
+}
+
+
 prim::Lattice::Lattice(const QString &fname, int lay_id)
   : Layer(tr("Lattice"), Layer::Lattice, LayerRole::Design, 0)
 {
@@ -300,6 +474,7 @@ void prim::Lattice::construct()
 
   // get values from the lattice_settings
   n_cell = lattice_settings->get<int>("cell/N");
+  occ_latdots.reset(n_cell);
   for(int i=0;i<n_cell;i++)
     b.append(lattice_settings->get<QPointF>(QString("cell/b%1").arg(i+1)));
   for(int i=0;i<2;i++){
@@ -56,6 +56,87 @@ namespace prim{
     }
   };
 
+  //! Occupancy of lattice sites, stored in dense square chunks of unit cells
+  //! which are allocated once a site in them is occupied. Each chunk holds the
+  //! DBDot pointers of its sites and an occupancy bitmap, so lookups of nearby
+  //! sites stay within one chunk and range queries scan the bitmap.
+  class OccupancyGrid
+  {
+  public:
+
+    //! Construct an empty grid for lattices with n_cell sites per unit cell.
+    OccupancyGrid(int n_cell=1) : n_cell(n_cell) {}
+
+    //! Destructor.
+    ~OccupancyGrid() {clear();}
+
+    //! Clear the grid and set the number of sites per unit cell.
+    void reset(int t_n_cell);
+
+    //! Set the DBDot at the given site, nullptr to unoccupy it.
+    void set(const prim::LatticeCoord &l_coord, prim::DBDot *dbdot);
+
+    //! Remove all occupation (the DBDots aren't deleted).
+    void clear();
+
+    //! Return the DBDot at the given site, or nullptr if unoccupied.
+    prim::DBDot *at(const prim::LatticeCoord &l_coord) const;
+
+    //! Return whether the given site is occupied.
+    bool contains(const prim::LatticeCoord &l_coord) const
+    {
+      int idx;
+      Chunk *chunk = chunkOf(l_coord, idx);
+      return chunk != nullptr && (chunk->bits.at(idx >> 6) >> (idx & 63)) & 1;
+    }
+
+    //! Return the given sites which are unoccupied, in the given order.
+    QList<prim::LatticeCoord> unoccupied(const QList<prim::LatticeCoord> &coords) const;
+
+    //! Return the DBDots at all sites in unit cells with n in [n_min, n_max]
+    //! and m in [m_min, m_max].
+    QList<prim::DBDot*> dbsInRange(int n_min, int m_min, int n_max, int m_max) const;
+
+    //! Return the occupancy of 64 consecutive sites in the unit cell row m,
+    //! starting at the site with index n*n_cell+l. Bit i of the returned word
+    //! corresponds to the site with index first_site+i.
+    quint64 occupancyWord(int m, qint64 first_site) const;
+
+    //! Return the number of occupied sites.
+    int count() const {return occ_count;}
+
+  private:
+
+    Q_DISABLE_COPY(OccupancyGrid)
+
+    struct Chunk {
+      QVector<prim::DBDot*> dbs;  // sites ordered by m, n, then l
+      QVector<quint64> bits;      // occupancy bitmap in the same order
+      int count=0;                // occupied sites in the chunk
+    };
+
+    //! Return the chunk containing the given site and its index within the
+    //! chunk, or nullptr if the chunk isn't allocated or the site invalid.
+    Chunk *chunkOf(const prim::LatticeCoord &l_coord, int &idx) const;
+
+    //! Return the chunk at the given chunk coordinates, or nullptr if not
+    //! allocated.
+    Chunk *chunkAt(int chunk_n, int chunk_m) const;
+
+    //! Return the given bitmap word of the unit cell row m, counting words
+    //! across chunks.
+    quint64 rowWord(int m, qint64 word_i) const;
+
+    int n_cell;                         // sites per unit cell
+    int occ_count=0;                    // occupied sites
+    QHash<quint64, Chunk*> chunks;      // allocated chunks by chunk coordinates
+
+    // the last chunk looked up, consecutive lookups tend to hit the same one
+    mutable bool cache_valid=false;
+    mutable quint64 cached_key;
+    mutable Chunk *cached_chunk;
+  };
+
   class Lattice : public prim::Layer
   {
   public:
@@ -105,13 +186,12 @@ namespace prim{
 
     //! Set lattice dot location to be occupied
     void setOccupied(const prim::LatticeCoord &l_coord, prim::DBDot *dbdot) {
-      qDebug() << tr("set occupied %1, %2, %3").arg(l_coord.n).arg(l_coord.m).arg(l_coord.l);
-      occ_latdots.insert(l_coord, dbdot);
+      occ_latdots.set(l_coord, dbdot);
     }
 
     //! Set lattice dot location to be unoccupied
     void setUnoccupied(const prim::LatticeCoord &l_coord) {
-      occ_latdots.remove(l_coord);
+      occ_latdots.set(l_coord, nullptr);
     }
 
     //! Clear occupation list (the pointers aren't actually deleted).
@@ -120,18 +200,40 @@ namespace prim{
     }
 
     //! Return whether lattice dot location is occupied.
-    bool isOccupied(const prim::LatticeCoord &l_coord) {
+    bool isOccupied(const prim::LatticeCoord &l_coord) const {
       return occ_latdots.contains(l_coord);
     }
 
+    //! Return the given lattice coordinates which are unoccupied.
+    QList<prim::LatticeCoord> unoccupiedSites(const QList<prim::LatticeCoord> &coords) const {
+      return occ_latdots.unoccupied(coords);
+    }
+
+    //! Return the DBDots within the unit cells spanned by the two given 
+    //! lattice coordinates, regardless of their l coordinates.
+    QList<prim::DBDot*> dbsInRange(const prim::LatticeCoord &coord1,
+        const prim::LatticeCoord &coord2) const {
+      return occ_latdots.dbsInRange(qMin(coord1.n, coord2.n), qMin(coord1.m, coord2.m),
+          qMax(coord1.n, coord2.n), qMax(coord1.m, coord2.m));
+    }
+
+    //! Return the occupancy of 64 consecutive sites in the unit cell row m,
+    //! see OccupancyGrid::occupancyWord.
+    quint64 occupancyWord(int m, qint64 first_site) const {
+      return occ_latdots.occupancyWord(m, first_site);
+    }
+
+    //! Return the number of sites per unit cell.
+    int cellSiteCount() const {return n_cell;}
+
     //! Return whether the given lattice coordinate is a valid coordinate.
     bool isValid(const prim::LatticeCoord &l_coord) const {
       return (l_coord.l >= 0 && l_coord.l < b.length());
     }
 
     //! Return the DBDot pointer at the specified lattice coord, or nullptr if none.
-    prim::DBDot *dbAt(const prim::LatticeCoord &l_coord) {
-      return occ_latdots.contains(l_coord) ? occ_latdots.value(l_coord) : nullptr;
+    prim::DBDot *dbAt(const prim::LatticeCoord &l_coord) const {
+      return occ_latdots.at(l_coord);
     }
 
     //! Return a list of DBDot pointers at specified physical locations (angstrom).
@@ -162,7 +264,7 @@ namespace prim{
     bool orthog;        // lattice vectors are orthogonal
     qreal a2[2];        // square magnitudes of lattice vectors
 
-    QHash<prim::LatticeCoord, prim::DBDot*> occ_latdots; // set of occupied lattice dots
+    prim::OccupancyGrid occ_latdots;  // occupied lattice dots
 
     // constants
 
@@ -12,6 +12,7 @@
 #include "electrode.h"
 #include "dblayer.h"
 #include "lattice.h"
+#include "gui/widgets/components/binary_problem.h"
 
 
 // statics
@@ -74,6 +75,7 @@ prim::Layer::~Layer()
     prim::Item *item = items.pop();
     delete item;
   }
+  item_inds.clear();
 }
 
 
@@ -89,14 +91,18 @@ void prim::Layer::setLayerID(int lay_id){
     item->setLayerID(lay_id);
 }
 
-// NOTE: in future, it might be worth keeping the items in a binary tree, sorted
-// by pointer address (which should not be modifiable).
-
 void prim::Layer::addItem(prim::Item *item, int index)
 {
-  if(!items.contains(item)){
+  if(!item_inds.contains(item)){
     if(index <= items.size()){
-      items.insert(index < 0 ? items.size() : index, item);
+      int ind = index < 0 ? items.size() : index;
+      items.insert(ind, item);
+      item_inds.insert(item, ind);
+      // items pushed on top keep the indices up to date
+      if (ind == items.size()-1 && stale_from == ind)
+        stale_from = items.size();
+      else
+        markIndicesStale(ind);
       // set item flags to agree with layer
       item->setActive(active);
       item->setVisible(visible);
@@ -112,22 +118,95 @@ void prim::Layer::addItem(prim::Item *item, int index)
 
 bool prim::Layer::removeItem(prim::Item *item)
 {
-  bool found = items.removeOne(item);
-  if(!found)
+  int ind = getItemIndex(item);
+  if(ind < 0){
     qDebug() << tr("item not found in layer...");
-  return found;
+    return false;
+  }
+  items.remove(ind);
+  item_inds.remove(item);
+  markIndicesStale(ind);
+  return true;
+}
+
+
+int prim::Layer::getItemIndex(prim::Item *item) const
+{
+  auto it = item_inds.constFind(item);
+  if (it == item_inds.constEnd())
+    return -1;
+  // recorded indices below stale_from are current, as are the indices of
+  // all items below it
+  if (it.value() < stale_from)
+    return it.value();
+  for (int i=stale_from; i<items.size(); i++)
+    item_inds[items.at(i)] = i;
+  stale_from = items.size();
+  return item_inds.value(item);
+}
+
+
+void prim::Layer::insertItems(const QList<prim::Item*> &new_items,
+    const QList<int> &indices)
+{
+  // merge the new items into a fresh stack instead of shifting the stack on
+  // every insertion
+  if (new_items.isEmpty())
+    return;
+  QStack<prim::Item*> merged;
+  merged.reserve(items.size() + new_items.size());
+  int old_i=0, new_i=0;
+  while (new_i < new_items.size()) {
+    if (indices.at(new_i) <= merged.size() || old_i == items.size()) {
+      prim::Item *item = new_items.at(new_i++);
+      item->setActive(active);
+      item->setVisible(visible);
+      item_inds.insert(item, merged.size());
+      merged.append(item);
+    } else {
+      merged.append(items.at(old_i++));
+    }
+  }
+  while (old_i < items.size())
+    merged.append(items.at(old_i++));
+  items = merged;
+  markIndicesStale(indices.first());
+}
+
+
+int prim::Layer::removeItems(const QList<prim::Item*> &rm_items)
+{
+  QSet<prim::Item*> rm_set;
+  for (prim::Item *item : rm_items)
+    if (item_inds.remove(item))
+      rm_set.insert(item);
+  if (rm_set.isEmpty())
+    return 0;
+
+  int kept=0;
+  for (int i=0; i<items.size(); i++) {
+    if (!rm_set.contains(items.at(i)))
+      items[kept++] = items.at(i);
+    else
+      markIndicesStale(kept);
+  }
+  items.resize(kept);
+  return rm_set.size();
 }
 
 
 prim::Item *prim::Layer::takeItem(int ind)
 {
   if(ind==-1 && !items.isEmpty())
-    return items.takeLast();
+    ind = items.count()-1;
   if(ind < 0 || ind >= items.count()){
     qCritical() << tr("Invalid item index...");
     return 0;
   }
-  return items.takeAt(ind);
+  prim::Item *item = items.takeAt(ind);
+  item_inds.remove(item);
+  markIndicesStale(ind);
+  return item;
 }
 
 void prim::Layer::setVisible(bool vis)
@@ -210,6 +289,42 @@ void prim::Layer::saveItems(QXmlStreamWriter *ws, gui::DesignInclusionArea inclu
   ws->writeEndElement();
 }
 
+void prim::Layer::saveLayerBinary(comp::BinaryProblem *problem) const
+{
+  if (layer_role != LayerRole::Design) {
+    qDebug() << tr("Skipping layer %1: %2 as the role is volatile.")
+      .arg(layer_id).arg(name);
+    return;
+  }
+
+  comp::BinaryProblem::LayerEntry layer;
+  layer.name = getName();
+  layer.type = contentTypeString();
+  layer.role = roleString();
+  layer.zoffset = zOffset();
+  layer.zheight = zHeight();
+  problem->addLayer(layer);
+}
+
+void prim::Layer::saveItemsBinary(comp::BinaryProblem *problem,
+                                  gui::DesignInclusionArea inclusion_area) const
+{
+  if (layer_role != LayerRole::Design)
+    return;
+
+  for(prim::Item *item : items){
+    switch (inclusion_area) {
+      case gui::IncludeSelectedItems:
+        if (item->isSelected())
+          item->saveItemsBinary(problem, -1);
+        break;
+      case gui::IncludeEntireDesign:
+      default:
+        item->saveItemsBinary(problem, -1);
+    }
+  }
+}
+
 void prim::Layer::loadItems(QXmlStreamReader *ws, QGraphicsScene *scene)
 {
   qDebug() << QObject::tr("Loading layer items for %1").arg(name);
@@ -226,7 +341,19 @@ void prim::Layer::loadItems(QXmlStreamReader *ws, QGraphicsScene *scene)
         prim::Emitter::instance()->sig_moveDBToLatticeCoord(dbdot, lc.n, lc.m, lc.l);
       } else if (ws->name() == "aggregate") {
         ws->readNext();
-        addItem(new prim::Aggregate(ws, scene, layer_id));
+        prim::Aggregate *agg = new prim::Aggregate(ws, scene, layer_id);
+        addItem(agg);
+        // DBs in aggregates occupy their lattice sites like any other DB
+        QStack<prim::Item*> agg_items = agg->getChildren();
+        while (!agg_items.isEmpty()) {
+          prim::Item *item = agg_items.pop();
+          if (item->item_type == prim::Item::DBDot) {
+            prim::DBDot *agg_db = static_cast<prim::DBDot*>(item);
+            static_cast<prim::DBLayer*>(this)->getLattice()->setOccupied(agg_db->latticeCoord(), agg_db);
+          } else if (item->item_type == prim::Item::Aggregate) {
+            agg_items += static_cast<prim::Aggregate*>(item)->getChildren();
+          }
+        }
       } else if (ws->name() == "electrode") {
         ws->readNext();
         addItem(new prim::Electrode(ws, scene, layer_id));
@@ -90,6 +90,15 @@ namespace prim{
     //! is found and removed, false otherwise.
     bool removeItem(prim::Item *item);
 
+    //! insert new Items in a single pass, each at the given index of the
+    //! resulting item stack. Indices must be ascending and the Items must not
+    //! already be in the layer.
+    void insertItems(const QList<prim::Item*> &new_items, const QList<int> &indices);
+
+    //! remove the given Items from the layer in a single pass. Returns the
+    //! number of Items found and removed.
+    int removeItems(const QList<prim::Item*> &rm_items);
+
     //! pop the Item given by the index. Returns 0 if invalid index.
     prim::Item *takeItem(int ind=-1);
 
@@ -127,11 +136,15 @@ namespace prim{
     //! item stack; otherwise, return 0
     prim::Item *getItem(int i) { return i >= 0 && i<items.size() ? items.at(i) : 0;}
 
-    //! get index of an item with the item's pointer
-    int getItemIndex(prim::Item *item) {return items.indexOf(item);}
+    //! get index of an item with the item's pointer, or -1 if the item isn't
+    //! in the layer
+    int getItemIndex(prim::Item *item) const;
+
+    //! return whether the item is in the layer
+    bool containsItem(prim::Item *item) const {return item_inds.contains(item);}
 
     //! get the Layer's items, needs to be a copy rather than a reference for Layer removal
-    QStack<prim::Item*> &getItems() {return items;}
+    const QStack<prim::Item*> &getItems() const {return items;}
 
     // SAVE LOAD
     virtual void saveLayer(QXmlStreamWriter *) const;
@@ -139,6 +152,11 @@ namespace prim{
     virtual void saveItems(QXmlStreamWriter *, gui::DesignInclusionArea) const;
     virtual void loadItems(QXmlStreamReader *, QGraphicsScene *);
 
+    //! Add the layer properties and the layer items to a binary simulation
+    //! problem, the binary equivalents of saveLayer and saveItems.
+    void saveLayerBinary(comp::BinaryProblem *) const;
+    void saveItemsBinary(comp::BinaryProblem *, gui::DesignInclusionArea) const;
+
   signals:
 
     void sig_visibilityChanged(bool visible);
@@ -159,6 +177,14 @@ namespace prim{
     // list of items in order of insertion, should probably be a linked list
     QStack<prim::Item*> items;
 
+    // stack index of each item. Insertions and removals only lower stale_from,
+    // the indices of items at or above it are refreshed on the next lookup.
+    mutable QHash<prim::Item*, int> item_inds;
+    mutable int stale_from=0;
+
+    // mark the indices of items at or above the given stack index as outdated
+    void markIndicesStale(int ind) {stale_from = qMin(stale_from, ind);}
+
     // flags
     bool visible=true;// layer is shown. If false, active should aso be false
     bool active=true; // layer is edittable
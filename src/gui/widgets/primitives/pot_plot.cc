@@ -23,6 +23,13 @@ prim::PotPlot::PotPlot(QString pot_plot_path, QRectF graph_container, QString po
   initPotPlot(pot_plot_path, graph_container, pot_anim_path);
 }
 
+prim::PotPlot::PotPlot(const QVector<QImage> &raster_pyramid, QRectF graph_container):
+  prim::Item(prim::Item::PotPlot)
+{
+  initPotPlot(QString(), graph_container, QString());
+  this->raster_pyramid = raster_pyramid;
+}
+
 prim::PotPlot::~PotPlot()
 {
   delete potential_animation;
@@ -67,11 +74,20 @@ QRectF prim::PotPlot::boundingRect() const
 }
 
 //Actually draw the picture into the rectangle.
-void prim::PotPlot::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
+void prim::PotPlot::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *)
 {
   painter->setOpacity(0.5);
   QRectF graph_container_draw = QRectF(qreal(0),qreal(0),graph_container.width(), graph_container.height());
-  if (potential_animation->isValid()) {
+  if (!raster_pyramid.isEmpty()) {
+    // paint the coarsest level that still has a pixel per screen pixel
+    qreal lod = option->levelOfDetailFromTransform(painter->worldTransform());
+    qreal screen_width = graph_container.width() * lod;
+    int level = 0;
+    while (level + 1 < raster_pyramid.size()
+           && raster_pyramid.at(level + 1).width() >= screen_width)
+      level++;
+    painter->drawImage(graph_container_draw, raster_pyramid.at(level));
+  } else if (potential_animation->isValid()) {
     painter->drawImage(graph_container_draw, potential_animation->currentPixmap().toImage());
   } else {
     painter->drawImage(graph_container_draw, potential_plot);
@@ -81,6 +97,8 @@ void prim::PotPlot::paint(QPainter *painter, const QStyleOptionGraphicsItem *, Q
 
 prim::Item *prim::PotPlot::deepCopy() const
 {
+  if (!raster_pyramid.isEmpty())
+    return new PotPlot(raster_pyramid, graph_container);
   prim::PotPlot *pp = new PotPlot(pot_plot_path, graph_container, pot_anim_path);
   return pp;
 }
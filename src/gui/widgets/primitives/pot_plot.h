@@ -24,6 +24,10 @@ namespace prim{
     //! and a QRectF to contain it.
     PotPlot(QString pot_plot_path, QRectF graph_container, QString pot_anim_path);
 
+    //! constructor, create a PotPlot from a pyramid of raster images at 
+    //! decreasing resolution, the level matching the zoom is painted.
+    PotPlot(const QVector<QImage> &raster_pyramid, QRectF graph_container);
+
     //! destructor
     ~PotPlot();
 
@@ -36,6 +40,7 @@ namespace prim{
     QRectF getGraphContainer(void){return graph_container;}
     QString getPotPlotPath(void){return pot_plot_path;}
     QString getAnimPath(void){return pot_anim_path;}
+    QVector<QImage> getRasterPyramid(void){return raster_pyramid;}
     void updateSimMovie();
     // inherited abstract method implementations
     QRectF boundingRect() const override;
@@ -56,6 +61,7 @@ namespace prim{
     QMovie *potential_animation;
     QString pot_plot_path;
     QString pot_anim_path;
+    QVector<QImage> raster_pyramid;
     static qreal edge_width;  // proportional width of dot boundary edge
     static QColor fill_col;   // dot fill color (same for all lattice dots)
     static QColor edge_col;     // edge colour, unselected
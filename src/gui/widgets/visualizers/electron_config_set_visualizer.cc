@@ -115,9 +115,9 @@ ECSVisualizer::ChargeConfigSetVisualizer(prim::Lattice *lattice, QWidget *parent
   connect(pb_degenerate_states, &QPushButton::pressed,
           [this]()
           {
-            if (charge_config_set == nullptr || curr_charge_config.config.empty()) 
+            if (charge_config_set == nullptr || curr_charge_config_ind < 0) 
               return;
-            visualizeDegenerateStates(curr_charge_config);
+            visualizeDegenerateStates(curr_charge_config_ind);
           });
 
   // physically valid state filter
@@ -157,19 +157,20 @@ void ECSVisualizer::setChargeConfigSet(comp::ChargeConfigSet *t_set,
 {
   // clean up past results
   clearChargeConfigResult();
-  charge_config_list.clear();
+  charge_config_list = comp::ChargeConfigSet::IndexRange();
   curr_charge_config = ECS::ChargeConfig();
+  curr_charge_config_ind = -1;
 
   // set up new results
   charge_config_set = t_set;
   updateGUIConfigSetChange();
   bool phys_valid_filter = cb_phys_valid_filter->isChecked();
-  setChargeConfigList(t_set == nullptr ? QList<ECS::ChargeConfig>() : charge_config_set->chargeConfigs(phys_valid_filter));
+  setChargeConfigList(t_set == nullptr ? comp::ChargeConfigSet::IndexRange() : charge_config_set->configIndices(phys_valid_filter));
   if (t_set != nullptr && show_results_now) {
     showChargeConfigResultFromSlider();
     if (preferred_sel == LowestPhysicallyValidState) {
       // select the lowest energy configuration that is physically valid
-      int gs_ind = ECS::lowestPhysicallyValidInd(charge_config_list);
+      int gs_ind = comp::ChargeConfigSet::lowestPhysicallyValidInd(charge_config_list);
       s_charge_config_list->setValue(gs_ind);
     } else if (preferred_sel == LowestInMostPopularNetCharge) {
       // filter to the most popular net charge occurance
@@ -186,7 +187,26 @@ void ECSVisualizer::setChargeConfigSet(comp::ChargeConfigSet *t_set,
 
 }
 
-void ECSVisualizer::setChargeConfigList(const QList<comp::ChargeConfigSet::ChargeConfig> &ec)
+void ECSVisualizer::refreshChargeConfigSet(comp::ChargeConfigSet *t_set)
+{
+  if (t_set == nullptr) {
+    clearVisualizer();
+    return;
+  }
+
+  bool had_selection = !curr_charge_config.config.isEmpty();
+  if (t_set != charge_config_set)
+    curr_charge_config_ind = -1;  // index refers to the previous set
+  charge_config_set = t_set;
+  updateGUIConfigSetChange();
+  setChargeConfigList(charge_config_set->configIndices(cb_phys_valid_filter->isChecked()));
+
+  // setChargeConfigList only re-shows a previous selection
+  if (!had_selection && !charge_config_list.isEmpty())
+    showChargeConfigResultFromSlider();
+}
+
+void ECSVisualizer::setChargeConfigList(const comp::ChargeConfigSet::IndexRange &ec)
 {
   // cache the current config (curr_charge_config can be affected by GUI update)
   ECS::ChargeConfig curr_config_cache = curr_charge_config;
@@ -202,7 +222,9 @@ void ECSVisualizer::setChargeConfigList(const QList<comp::ChargeConfigSet::Charg
   }
   bool found = false;
   for (int i=0; i<charge_config_list.length(); i++) {
-    if (ec.at(i) == curr_config_cache) {
+    // only unpack configs which could possibly match
+    if (charge_config_set->energy(ec.at(i)) == curr_config_cache.energy
+        && charge_config_set->chargeConfig(ec.at(i)) == curr_config_cache) {
       s_charge_config_list->setValue(i);
       found = true;
       break;
@@ -225,7 +247,8 @@ void ECSVisualizer::showChargeConfigResultFromSlider()
     qCritical() << tr("Charge config set slider value out of bound");
     return;
   }
-  showChargeConfigResult(charge_config_list.at(charge_config_ind),
+  curr_charge_config_ind = charge_config_list.at(charge_config_ind);
+  showChargeConfigResult(charge_config_set->chargeConfig(curr_charge_config_ind),
       charge_config_set->dbPhysicalLocations());
   updateGUIConfigSelectionChange(charge_config_ind);
 }
@@ -241,7 +264,8 @@ void ECSVisualizer::showChargeConfigResult(const ECS::ChargeConfig &charge_confi
 
   // set the charge fill state of the provided set of DBs
   showing_db_sites = lattice->dbsAtPhysLocs(db_phys_locs);
-  if (db_phys_locs.size() != 0 && showing_db_sites.empty()) {
+  if ((db_phys_locs.size() != 0 && showing_db_sites.empty())
+      || showing_db_sites.length() < curr_charge_config.config.length()) {
     qCritical() << tr("Failed to retrieve all DB locations, aborting charge \
         config result display.");
     return;
@@ -258,21 +282,18 @@ void ECSVisualizer::showChargeConfigResult(const ECS::ChargeConfig &charge_confi
   }
 }
 
-void ECSVisualizer::visualizeDegenerateStates(const ECS::ChargeConfig &charge_config)
+void ECSVisualizer::visualizeDegenerateStates(int config_ind)
 {
-  QList<ECS::ChargeConfig> degen_configs = charge_config_set->degenerateConfigs(charge_config);
-  QList<float> db_fill;
+  comp::ChargeConfigSet::IndexRange degen_configs = charge_config_set->degenerateConfigs(config_ind);
 
   // add all of the degen configs
-  bool init=true;
-  for (ECS::ChargeConfig t_config : degen_configs) {
-    for (int i=0; i<t_config.config.size(); i++) {
-      if (init)
-        db_fill.append(t_config.config.at(i));
-      else 
-        db_fill[i] += t_config.config.at(i);
+  QList<float> db_fill;
+  for (int i=0; i<charge_config_set->configInfo(config_ind).db_count; i++)
+    db_fill.append(0);
+  for (int degen_ind : degen_configs) {
+    for (int i=0; i<db_fill.size(); i++) {
+      db_fill[i] += charge_config_set->chargeAt(degen_ind, i);
     }
-    init=false;
   }
 
   // divide the degen config count and sqrt
@@ -289,10 +310,10 @@ void ECSVisualizer::applyNetChargeFilter(const bool &use_slider, const int &net_
 {
   bool phys_valid_filter = cb_phys_valid_filter->isChecked();
   if (!use_slider) {
-    setChargeConfigList(charge_config_set->chargeConfigs(phys_valid_filter, true, net_charge));
+    setChargeConfigList(charge_config_set->configIndices(phys_valid_filter, true, net_charge));
     s_net_charge_filter->setValue(charge_config_set->netCharges().indexOf(net_charge));
   } else {
-    setChargeConfigList(charge_config_set->chargeConfigs(phys_valid_filter));
+    setChargeConfigList(charge_config_set->configIndices(phys_valid_filter));
   }
   updateGUIFilterSelectionChange(net_charge);
 }
@@ -315,8 +336,9 @@ QWidget *ECSVisualizer::scatterPlotChargeConfigSet()
   series->setMarkerSize(15.0);
 
   if (charge_config_set != nullptr) {
-    for (comp::ChargeConfigSet::ChargeConfig config : charge_config_set->chargeConfigs()) {
-      series->append(config.netNegCharge(), config.energy);
+    for (int i=0; i<charge_config_set->configCount(); i++) {
+      series->append(charge_config_set->configInfo(i).netNegCharge(),
+                     charge_config_set->energy(i));
     }
   } else {
     qCritical() << tr("No charge config set selected/available.");
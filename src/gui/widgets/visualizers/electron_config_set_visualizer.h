@@ -45,10 +45,19 @@ namespace gui{
                             bool show_results_now=true,
                             PreferredSelection preferred_sel=LowestPhysicallyValidState);
 
-    //! Set a new charge config list (which contains charge configurations
-    //! with applied filters, sort rules, etc.) Without filter, the list would
-    //! just be the list returned by charge_config_set->chargeConfigs().
-    void setChargeConfigList(const QList<comp::ChargeConfigSet::ChargeConfig> &ec);
+    //! Refresh the visualizer after the charge config set has been extended 
+    //! or replaced, e.g. by results streamed in from a running plugin. The 
+    //! currently shown config stays selected if it is still in the list.
+    void refreshChargeConfigSet(comp::ChargeConfigSet *t_set);
+
+    //! Return the charge config set currently being visualized.
+    comp::ChargeConfigSet *chargeConfigSet() {return charge_config_set;}
+
+    //! Set a new charge config list (which contains indices of charge 
+    //! configurations in the set with applied filters, sort rules, etc.) 
+    //! Without filter, the list would just be the list returned by 
+    //! charge_config_set->configIndices().
+    void setChargeConfigList(const comp::ChargeConfigSet::IndexRange &ec);
 
     //! Show the charge config specified by the current slider location.
     void showChargeConfigResultFromSlider();
@@ -60,8 +69,8 @@ namespace gui{
                                   const QList<QPointF> &db_phys_locs,
                                   const QList<float> &db_fill=QList<float>());
 
-    //! Color in degenerate states.
-    void visualizeDegenerateStates(const comp::ChargeConfigSet::ChargeConfig &charge_config);
+    //! Color in degenerate states of the config at the given set index.
+    void visualizeDegenerateStates(int config_ind);
 
     //! Apply an charge count filter with the given net charge count. 
     //! If use_slider is set to true, then the slider value is applied.
@@ -101,10 +110,11 @@ namespace gui{
     prim::Lattice *lattice;
     // current charge config set (contains all information about this config)
     comp::ChargeConfigSet *charge_config_set=nullptr;
-    // current charge config list (filtered/sorted/etc.)
-    QList<comp::ChargeConfigSet::ChargeConfig> charge_config_list;
-    // current charge config being shown
+    // current charge config list as indices into the set (filtered/sorted/etc.)
+    comp::ChargeConfigSet::IndexRange charge_config_list;
+    // current charge config being shown and its index in the set
     comp::ChargeConfigSet::ChargeConfig curr_charge_config;
+    int curr_charge_config_ind=-1;
     QList<prim::DBDot*> showing_db_sites;       // DB sites currently controlled by visualizer
 
     // GUI variables
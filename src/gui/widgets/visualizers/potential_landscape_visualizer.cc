@@ -54,12 +54,26 @@ void PLVisualizer::showPotentialResultOverlay()
   // TODO move the functions in Design Panel over here
   // TODO potplot creation and removal probably don't need to be undoable
 
-  // current re-implementation of Nathan's code:
   clearPotentialResultOverlay();  // clean up existing results
-  QVector<float> pot_vec_top_left = pot_landscape->potentials().front();
-  QVector<float> pot_vec_bot_right = pot_landscape->potentials().back();
-  QPointF p_top_left(pot_vec_top_left[0], pot_vec_top_left[1]);
-  QPointF p_bot_right(pot_vec_bot_right[0], pot_vec_bot_right[1]);
+  if (pot_landscape->sampleCount() == 0)
+    return;
+
+  // render the samples directly if they form a grid
+  QVector<QImage> pyramid = pot_landscape->rasterPyramid();
+  if (!pyramid.isEmpty()) {
+    QRectF bounds = pot_landscape->rasterBounds();
+    QRectF graph_container(bounds.topLeft() * prim::Item::scale_factor,
+                           bounds.size() * prim::Item::scale_factor);
+    design_pan->displayPotentialRaster(pyramid, graph_container);
+    return;
+  }
+
+  // otherwise fall back to the plots written by the plugin, current 
+  // re-implementation of Nathan's code:
+  const PL::PotentialSample &pot_top_left = pot_landscape->sample(0);
+  const PL::PotentialSample &pot_bot_right = pot_landscape->sample(pot_landscape->sampleCount()-1);
+  QPointF p_top_left(pot_top_left.x, pot_top_left.y);
+  QPointF p_bot_right(pot_bot_right.x, pot_bot_right.y);
   p_top_left *= prim::Item::scale_factor;
   p_bot_right *= prim::Item::scale_factor;
 
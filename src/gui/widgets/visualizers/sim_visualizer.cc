@@ -114,6 +114,18 @@ SimVisualizer::SimVisualizer(DesignPanel *design_pan, QWidget *parent)
             setChargeConfigSetJobStep(str_job_step_ind.toInt());
           });
 
+  // refresh the charge config set being streamed in by a running job step
+  live_refresh_timer = new QTimer(this);
+  live_refresh_timer->setSingleShot(true);
+  live_refresh_timer->setInterval(500);
+  connect(live_refresh_timer, &QTimer::timeout,
+          [this]()
+          {
+            if (charge_config_set_visualizer->chargeConfigSet() != nullptr)
+              charge_config_set_visualizer->refreshChargeConfigSet(
+                  charge_config_set_visualizer->chargeConfigSet());
+          });
+
   // potential landscape results
   pot_landscape_visualizer = new PotentialLandscapeVisualizer(design_pan);
   gb_pot_landscape = new QGroupBox("Potential Landscape");
@@ -191,6 +203,10 @@ void SimVisualizer::showJob(comp::SimJob *job)
   qDebug() << tr("Showing job %1").arg(job->name());
   setEnabled(true);
 
+  // follow results streamed in by steps which are still running
+  connect(job, &comp::SimJob::sig_jobStepResultsUpdated,
+          this, &SimVisualizer::jobStepResultsUpdated);
+
   // tell application to show virualization side dock and load Result layers
   emit sig_showJobInvoked(job);
 
@@ -250,7 +266,11 @@ void SimVisualizer::clearJob()
 
   charge_config_set_visualizer->clearVisualizer();
   pot_landscape_visualizer->clearVisualizer();
+  live_refresh_timer->stop();
 
+  if (sim_job != nullptr)
+    disconnect(sim_job, &comp::SimJob::sig_jobStepResultsUpdated,
+               this, &SimVisualizer::jobStepResultsUpdated);
   sim_job = nullptr;
 
   // disable user interaction to the entire plugin
@@ -260,6 +280,38 @@ void SimVisualizer::clearJob()
   // output dialog button somewhere
 }
 
+void SimVisualizer::jobStepResultsUpdated(comp::SimJob *job, int step_ind)
+{
+  if (job != sim_job)
+    return;
+
+  comp::JobStep *js = job->getJobStep(step_ind);
+  ECS *charge_config_set = static_cast<ECS*>(
+      js->jobResults().value(JR::ChargeConfigsResult, nullptr));
+  if (charge_config_set == nullptr)
+    return;
+
+  // offer the step for selection as soon as it has any charge configs
+  QString str_job_step_ind = QString::number(step_ind);
+  if (cb_job_steps_charge_configs->findText(str_job_step_ind) == -1) {
+    gb_charge_configs->setEnabled(true);
+    cb_job_steps_charge_configs->addItem(str_job_step_ind);
+    return;
+  }
+
+  if (cb_job_steps_charge_configs->currentText() != str_job_step_ind)
+    return;
+
+  if (charge_config_set != charge_config_set_visualizer->chargeConfigSet()) {
+    // the set has been replaced (e.g. by the final results), the previous one
+    // is about to be deleted so switch over right away
+    live_refresh_timer->stop();
+    charge_config_set_visualizer->refreshChargeConfigSet(charge_config_set);
+  } else if (!live_refresh_timer->isActive()) {
+    live_refresh_timer->start();
+  }
+}
+
 void SimVisualizer::designPanelResetActions()
 {
   charge_config_set_visualizer->setLattice(design_pan->getLattice(false));
@@ -40,6 +40,11 @@ namespace gui{
     //! Take actions after design panel reset
     void designPanelResetActions();
 
+    //! Update the shown results if the given job step of the shown job has
+    //! new results. Streamed results of running steps are refreshed at most
+    //! once per live refresh interval.
+    void jobStepResultsUpdated(comp::SimJob *job, int step_ind);
+
     //! Return the result types supported by this class.
     QList<comp::JobResult::ResultType> supportedResultTypes()
     {
@@ -110,6 +115,8 @@ namespace gui{
     QComboBox *cb_job_steps_charge_configs;     // job steps containing electron configurations
     QComboBox *cb_job_steps_pot_landscape;    // job steps containing potential landscape
 
+    QTimer *live_refresh_timer;               // throttles refreshes of streamed results
+
     /*
     void initSimVisualizer();
 
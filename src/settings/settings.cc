@@ -141,6 +141,18 @@ QSettings *settings::AppSettings::m_defs()
   }));
   S->setValue("plugs/preset_root_path", QString("<CONFIG>/plugins/"));
   S->setValue("plugs/runtime_tmp_root_path", QString("<SYSTMP>/plugins/"));
+  S->setValue("plugs/max_worker_slots", 0);  // max job steps running at once across all jobs, 0 to use the CPU core count
+  S->setValue("plugs/result_cache_enabled", true);  // reuse results of identical job steps
+  S->setValue("plugs/result_cache_path", QString("<SYSTMP>/result_cache/"));
+  S->setValue("plugs/result_cache_max_mb", 1024); // result cache size cap in MiB, LRU eviction beyond
+  S->setValue("plugs/plugin_daemons_enabled", true);  // serve job steps with warm plugin daemons if plugins support it
+  S->setValue("plugs/daemon_idle_timeout_s", 300);   // idle time before a plugin daemon is shut down, 0 to keep alive
+  S->setValue("plugs/shm_exchange_enabled", true);   // exchange problems and results through shared memory if plugins support it
+  S->setValue("plugs/terminal_buffer_kb", 1024);     // plugin terminal output kept in memory per channel in KiB, the rest is only logged to file
+  S->setValue("plugs/limit_memory_mb", 0);      // plugin processes exceeding this RSS in MiB are killed, 0 for no limit
+  S->setValue("plugs/limit_wall_time_s", 0);    // plugin processes running longer than this are killed, 0 for no limit
+  S->setValue("plugs/process_nice", 0);         // niceness increment of plugin processes
+  S->setValue("plugs/cpu_affinity", QString()); // CPUs plugin processes may run on, e.g. "0-3,6", empty for all
 
   S->setValue("float_prc", 6);  // float precision specified in QString::setNum; not always obeyed.
   S->setValue("float_fmt", "g");   // float format specified in QString::setNum; not always obeyed.
@@ -199,6 +211,7 @@ QSettings* settings::GUISettings::m_defs()
   S->setValue("dbdot/diameter_m", 1.5);         // dot diameter (mid)
   S->setValue("dbdot/diameter_l", 2);           // dot diameter (large)
   S->setValue("dbdot/publish_scale", 1.8);      // scaling for publish mode
+  S->setValue("dbdot/lod_zoom_threshold", .015); // the zoom threshold (m11 transform) below which DBs are drawn as single pixels
   S->setValue("dbdot/edge_width", .15);         // edge width rel. to diameter
   S->setValue("dbdot/edge_col", QColor(255,255,255));     // edge color
   S->setValue("dbdot/edge_col_sel", QColor(0,100,255));   // edge color (selected)
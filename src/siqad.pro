@@ -8,7 +8,7 @@
 CONFIG += qt c++11
 CONFIG += release
 
-QT += core gui widgets svg printsupport uitools charts
+QT += core gui widgets svg printsupport uitools charts concurrent
 
 TEMPLATE = app
 TARGET = siqad
@@ -33,6 +33,9 @@ RESOURCES = resources/application.qrc
 win32:RC_ICONS = resources/ico/siqad.ico
 # macx:ICON = resources/ico/siqad.icns
 
+# POSIX shared memory used for problem and result exchange with plugins
+unix:!macx:LIBS += -lrt
+
 
 #################################
 # INPUT GUI HEADERS AND SOURCES #
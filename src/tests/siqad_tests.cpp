@@ -1,7 +1,20 @@
 #include <QtTest/QtTest>
 
+#include "gui/widgets/design_panel.h"
 #include "gui/widgets/managers/layer_manager.h"
 #include "gui/widgets/primitives/lattice.h"
+#include "gui/widgets/components/sim_job.h"
+#include "gui/widgets/components/process_runner.h"
+#include "gui/widgets/components/result_cache.h"
+
+// bare item for exercising layer bookkeeping without a scene
+class BareItem: public prim::Item
+{
+public:
+  BareItem() : prim::Item(prim::Item::Text) {}
+  QRectF boundingRect() const override {return QRectF();}
+  void paint(QPainter *, const QStyleOptionGraphicsItem *, QWidget *) override {}
+};
 
 class SiQADTests: public QObject
 {
@@ -50,6 +63,460 @@ private slots:
     QCOMPARE(layman->layerCount(), 0);
   }
 
+  void testLayerItemIndices()
+  {
+    prim::Layer layer("Indices");
+    QList<prim::Item*> taken;
+    // the lazily updated indices agree with the stack after every change
+    auto indicesConsistent = [&layer, &taken]() -> bool {
+      const QStack<prim::Item*> &items = layer.getItems();
+      for (prim::Item *item : items)
+        if (!layer.containsItem(item) || layer.getItemIndex(item) != items.indexOf(item))
+          return false;
+      for (prim::Item *item : taken)
+        if (layer.containsItem(item) || layer.getItemIndex(item) != -1)
+          return false;
+      return true;
+    };
+
+    for (int i=0; i<5; i++)
+      layer.addItem(new BareItem());
+    QVERIFY(indicesConsistent());
+
+    // mid-stack insert and remove
+    layer.addItem(new BareItem(), 2);
+    QVERIFY(indicesConsistent());
+    taken.append(layer.getItems().at(1));
+    QVERIFY(layer.removeItem(taken.last()));
+    QVERIFY(indicesConsistent());
+
+    // batch insert and remove
+    QList<prim::Item*> new_items({new BareItem(), new BareItem()});
+    layer.insertItems(new_items, {0, 3});
+    QCOMPARE(layer.getItems().at(3), new_items.last());
+    QVERIFY(indicesConsistent());
+    QList<prim::Item*> rm_items({layer.getItems().at(0), layer.getItems().at(4)});
+    QCOMPARE(layer.removeItems(rm_items), 2);
+    taken.append(rm_items);
+    QVERIFY(indicesConsistent());
+
+    // taking the top item
+    prim::Item *top = layer.getItems().last();
+    QCOMPARE(layer.takeItem(-1), top);
+    taken.append(top);
+    QVERIFY(indicesConsistent());
+    QCOMPARE(layer.getItems().count(), 4);
+
+    qDeleteAll(taken);
+  }
+
+  void testCreateDBsStackOrder()
+  {
+    gui::DesignPanel *dp = new gui::DesignPanel();
+    prim::Layer *surface = dp->layerManager()->getLayer("Surface");
+    auto stackCoords = [surface]() -> QList<prim::LatticeCoord> {
+      QList<prim::LatticeCoord> coords;
+      for (prim::Item *item : surface->getItems())
+        coords.append(static_cast<prim::DBDot*>(item)->latticeCoord());
+      return coords;
+    };
+
+    // create -> undo -> redo puts the DBs back on top
+    QList<prim::LatticeCoord> coords({prim::LatticeCoord(0, 0, 0),
+        prim::LatticeCoord(1, 0, 0), prim::LatticeCoord(2, 0, 1)});
+    for (const prim::LatticeCoord &coord : coords)
+      QVERIFY(dp->commandCreateItem("DBDot", "auto", {QString::number(coord.n),
+            QString::number(coord.m), QString::number(coord.l)}));
+    QCOMPARE(stackCoords(), coords);
+    QMetaObject::invokeMethod(dp, "undoAction");
+    QCOMPARE(stackCoords(), coords.mid(0, 2));
+    QMetaObject::invokeMethod(dp, "redoAction");
+    QCOMPARE(stackCoords(), coords);
+
+    // bulk deletion of DBs around the middle of the stack merges them back in
+    // place on undo
+    dp->setTool(gui::ToolType::SelectTool);
+    surface->getItems().at(0)->setSelected(true);
+    surface->getItems().at(2)->setSelected(true);
+    QMetaObject::invokeMethod(dp, "deleteAction");
+    QCOMPARE(stackCoords(), QList<prim::LatticeCoord>({coords.at(1)}));
+    QMetaObject::invokeMethod(dp, "undoAction");
+    QCOMPARE(stackCoords(), coords);
+    QMetaObject::invokeMethod(dp, "redoAction");
+    QCOMPARE(stackCoords(), QList<prim::LatticeCoord>({coords.at(1)}));
+    QMetaObject::invokeMethod(dp, "undoAction");
+    QCOMPARE(stackCoords(), coords);
+
+    delete dp;
+  }
+
+  void testParameterSweepSpec()
+  {
+    QMap<QString, QStringList> sweep_values;
+
+    // ranges are inclusive of the end point, lists are taken as-is
+    QVERIFY(comp::SimJob::parseSweepSpec("mu = -0.3:-0.25:0.01\n\nT_init = 500, 1000",
+                                         sweep_values));
+    QCOMPARE(sweep_values.keys(), QStringList({"T_init", "mu"}));
+    QCOMPARE(sweep_values.value("mu").length(), 6);
+    QCOMPARE(sweep_values.value("mu").first().toDouble(), -0.3);
+    QCOMPARE(sweep_values.value("mu").last().toDouble(), -0.25);
+    QCOMPARE(sweep_values.value("T_init"), QStringList({"500", "1000"}));
+
+    // malformed specifications are refused
+    QString err_msg;
+    QVERIFY(!comp::SimJob::parseSweepSpec("mu -0.3", sweep_values, &err_msg));
+    QVERIFY(!err_msg.isEmpty());
+    QVERIFY(!comp::SimJob::parseSweepSpec("mu = 0:1:-0.1", sweep_values));
+    QVERIFY(!comp::SimJob::parseSweepSpec("mu = 1\nmu = 2", sweep_values));
+
+    // non-finite and oversized sweeps are refused
+    QVERIFY(!comp::SimJob::parseSweepSpec("mu = 0:inf:1", sweep_values));
+    QVERIFY(!comp::SimJob::parseSweepSpec("mu = nan:1:0.1", sweep_values));
+    QVERIFY(!comp::SimJob::parseSweepSpec("mu = 0:1:1e-12", sweep_values, &err_msg));
+    QVERIFY(err_msg.contains("mu"));
+    QVERIFY(comp::SimJob::parseSweepSpec("mu = 1:100:1\nT_init = 1:100:1", sweep_values));
+    QVERIFY(!comp::SimJob::parseSweepSpec("mu = 1:100:1\nT_init = 1:101:1", sweep_values));
+  }
+
+  void testJobStepDependencySpec()
+  {
+    QList<int> deps;
+
+    // empty spec falls back to the previous step
+    QVERIFY(comp::SimJob::parseDependencySpec("", 0, deps));
+    QVERIFY(deps.isEmpty());
+    QVERIFY(comp::SimJob::parseDependencySpec("", 2, deps));
+    QCOMPARE(deps, QList<int>({1}));
+
+    QVERIFY(comp::SimJob::parseDependencySpec("none", 2, deps));
+    QVERIFY(deps.isEmpty());
+    QVERIFY(comp::SimJob::parseDependencySpec("0, 1, 0", 3, deps));
+    QCOMPARE(deps, QList<int>({0, 1}));
+
+    // only earlier steps may be depended on
+    QVERIFY(!comp::SimJob::parseDependencySpec("2", 2, deps));
+    QVERIFY(!comp::SimJob::parseDependencySpec("-1", 2, deps));
+    QVERIFY(!comp::SimJob::parseDependencySpec("a", 2, deps));
+
+    // empty rows in the job step list don't take up a placement, so the
+    // step after one depends on the step before it
+    QList<int> placements = comp::SimJob::stepPlacements({true, false, true, true});
+    QCOMPARE(placements, QList<int>({0, -1, 1, 2}));
+    QVERIFY(comp::SimJob::parseDependencySpec("", placements.at(2), deps));
+    QCOMPARE(deps, QList<int>({0}));
+    QVERIFY(comp::SimJob::parseDependencySpec("1", placements.at(3), deps));
+    QVERIFY(!comp::SimJob::parseDependencySpec("2", placements.at(3), deps));
+
+    // result paths of other steps are only available for dependencies
+    QStringList format({"@BINPATH@", "@RESULTPATH_0@", "@RESULTPATH@"});
+    QVERIFY(comp::JobStep::checkResultPathKeywords(format, QList<int>({0})));
+    QVERIFY(!comp::JobStep::checkResultPathKeywords(format, QList<int>({1})));
+  }
+
+  void testChargeConfigSetIncremental()
+  {
+    typedef comp::ChargeConfigSet ECS;
+    QByteArray dists =
+      "<elec_dist>"
+      "<dist energy=\"0.3\" count=\"1\" physically_valid=\"1\" state_count=\"3\">-0-</dist>"
+      "<dist energy=\"0.1\" count=\"2\" physically_valid=\"1\" state_count=\"3\">0--</dist>"
+      "<dist energy=\"0.2\" count=\"1\" physically_valid=\"0\" state_count=\"3\">-00</dist>"
+      "<dist energy=\"0.0\" count=\"1\" physically_valid=\"0\" state_count=\"3\">--0</dist>"
+      "</elec_dist>";
+
+    // read all at once like a result file
+    QXmlStreamReader rs(dists);
+    rs.readNextStartElement();
+    ECS full_set(&rs);
+
+    // add the same configs in two batches like streamed results
+    ECS streamed_set;
+    QList<ECS::ChargeConfig> configs;
+    for (int i=full_set.configCount()-1; i>=0; i--)
+      configs.append(full_set.chargeConfig(i));
+    streamed_set.addChargeConfigs(configs.mid(0, 2));
+    streamed_set.addChargeConfigs(configs.mid(2));
+
+    auto unpackAll = [](const ECS &set) -> QList<ECS::ChargeConfig>
+    {
+      QList<ECS::ChargeConfig> unpacked;
+      for (int ind : set.configIndices())
+        unpacked.append(set.chargeConfig(ind));
+      return unpacked;
+    };
+    QCOMPARE(unpackAll(streamed_set), unpackAll(full_set));
+    QCOMPARE(streamed_set.totalConfigCount(), 5);
+    QCOMPARE(streamed_set.netChargeOccurances(), full_set.netChargeOccurances());
+
+    // net charge bins are in ascending order of energy
+    ECS::IndexRange bin = streamed_set.configIndices(false, false, 2);
+    QCOMPARE(bin.length(), 3);
+    QCOMPARE(streamed_set.energy(bin.first()), 0.0f);
+    QCOMPARE(streamed_set.energy(bin.last()), 0.3f);
+
+    // packed charges survive the round trip
+    QCOMPARE(streamed_set.chargeConfig(bin.first()).config, QList<int>({1, 1, 0}));
+
+    // validity lookups are served from the indices
+    QCOMPARE(ECS::lowestPhysicallyValidInd(bin), 1);
+    QCOMPARE(streamed_set.configIndices(true, false, 2).length(), 2);
+    QCOMPARE(streamed_set.configIndices(true, false, 1).length(), 0);
+    float gs_energy;
+    QVERIFY(streamed_set.groundStateEnergy(gs_energy, true));
+    QCOMPARE(gs_energy, 0.1f);
+    ECS::IndexRange by_energy = streamed_set.energyOrderedIndices();
+    QCOMPARE(streamed_set.energy(by_energy.at(2)), 0.2f);
+    QCOMPARE(streamed_set.degenerateConfigs(by_energy.at(2)).length(), 1);
+
+    // repeated configs are merged into the stored one
+    streamed_set.addChargeConfigs(configs.mid(0, 2));
+    QCOMPARE(streamed_set.configCount(), 4);
+    QCOMPARE(streamed_set.totalConfigCount(), 7);
+    QCOMPARE(streamed_set.configInfo(bin.first()).config_occ, 2);
+    QCOMPARE(streamed_set.configInfo(bin.first()).record_count, 2);
+  }
+
+  void testBinaryResultFile()
+  {
+    typedef comp::ChargeConfigSet ECS;
+
+    // elec_dist section with the configs "-0+" and "--0"
+    QByteArray sec;
+    QDataStream ds(&sec, QIODevice::WriteOnly);
+    ds.setByteOrder(QDataStream::LittleEndian);
+    ds.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    ds << quint32(2) << quint32(3) << quint32(3) << quint32(1);
+    ds << 0.5f << qint32(3) << qint32(1);
+    ds << -0.1f << qint32(1) << qint32(0);
+    ds << quint64(0x06) << quint64(0x1A);
+
+    QByteArray file_data;
+    QDataStream fs(&file_data, QIODevice::WriteOnly);
+    fs.setByteOrder(QDataStream::LittleEndian);
+    fs.writeRawData("SQRB", 4);
+    fs << quint32(1) << quint32(1) << quint32(0);
+    fs << quint32(comp::BinaryResultFile::ElecDistSection) << quint32(0)
+       << quint64(40) << quint64(sec.size());
+    fs.writeRawData(sec.constData(), sec.size());
+
+    QTemporaryFile tmp_file;
+    QVERIFY(tmp_file.open());
+    tmp_file.write(file_data);
+    tmp_file.close();
+
+    QVERIFY(comp::BinaryResultFile::isBinaryResultFile(tmp_file.fileName()));
+    QSharedPointer<const comp::BinaryResultFile> file(
+        new comp::BinaryResultFile(tmp_file.fileName()));
+    QVERIFY(file->isValid());
+    ECS set(file);
+    QCOMPARE(set.configCount(), 2);
+
+    // lowest energy first, counts derived from the packed words
+    ECS::IndexRange inds = set.configIndices();
+    QCOMPARE(set.energy(inds.first()), -0.1f);
+    QCOMPARE(set.chargeConfig(inds.first()).config, QList<int>({1, 1, 0}));
+    QCOMPARE(set.configInfo(inds.last()).dbp_count, 1);
+    QCOMPARE(set.configInfo(inds.last()).netNegCharge(), 0);
+    QCOMPARE(set.totalConfigCount(), 4);
+
+    // adding configs to a mapped set copies the packed configs first, 
+    // duplicates of mapped configs are merged into them
+    set.addChargeConfigs({set.chargeConfig(inds.first())});
+    QCOMPARE(set.configCount(), 2);
+    QCOMPARE(set.configInfo(inds.first()).config_occ, 2);
+    QCOMPARE(set.chargeConfig(inds.last()).config, QList<int>({1, 0, -1}));
+  }
+
+  void testBinaryProblem()
+  {
+    typedef comp::BinaryProblem BP;
+
+    BP problem;
+    problem.setSimParams({{"mu", "-0.25"}});
+    int agg = problem.addAggregate(-1);
+    problem.addDBDot(BP::DBDotRecord{1.5f, -2.f, 1, 2, 0, agg});
+    problem.addDBDot(BP::DBDotRecord{3.f, 4.f, 2, 3, 1, -1});
+
+    QByteArray buf(problem.serializedSize(), '\xff');
+    problem.serialize(reinterpret_cast<uchar*>(buf.data()));
+    QVERIFY(buf.startsWith("SQPB"));
+
+    // dbdots is the second last section, records follow the count
+    const uchar *data = reinterpret_cast<const uchar*>(buf.constData());
+    quint32 section_count = *reinterpret_cast<const quint32*>(data + 8);
+    QCOMPARE(section_count, quint32(6));
+    const uchar *entry = data + 16 + (section_count - 2) * 24;
+    QCOMPARE(*reinterpret_cast<const quint32*>(entry), quint32(BP::DBDotsSection));
+    quint64 offset = *reinterpret_cast<const quint64*>(entry + 8);
+    QCOMPARE(offset % 8, quint64(0));
+    QCOMPARE(*reinterpret_cast<const quint64*>(data + offset), quint64(2));
+    const BP::DBDotRecord *dbs = reinterpret_cast<const BP::DBDotRecord*>(data + offset + 8);
+    QCOMPARE(dbs[0].y, -2.f);
+    QCOMPARE(dbs[0].aggregate, 0);
+    QCOMPARE(dbs[1].l, 1);
+  }
+
+  void testResultCacheKey()
+  {
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+    QFile plug_file(tmp_dir.filePath("test.sqplug"));
+    QVERIFY(plug_file.open(QFile::WriteOnly));
+    plug_file.write("<plugin><name>Test</name><version>1</version></plugin>");
+    plug_file.close();
+    comp::PluginEngine engine(plug_file.fileName());
+
+    // problems differing only in the export date and the view state
+    auto writeProblem = [&tmp_dir](const QString &name, const QByteArray &date,
+                                   const QByteArray &zoom) -> QString {
+      QFile problem_file(tmp_dir.filePath(name));
+      problem_file.open(QFile::WriteOnly);
+      problem_file.write("<siqad><program><date>" + date + "</date></program>"
+                         "<gui><zoom>" + zoom + "</zoom></gui>"
+                         "<sim_params><mu>-0.25</mu></sim_params>"
+                         "<design/></siqad>");
+      return problem_file.fileName();
+    };
+    QString path_a = writeProblem("a.xml", "2020-01-01", "0.1");
+    QString path_b = writeProblem("b.xml", "2021-02-02", "0.5");
+    QStringList command({"@BINPATH@", "@PROBLEMPATH@"});
+    QMap<QString, QString> params({{"mu", "-0.25"}});
+
+    QString key_a = comp::ResultCache::cacheKey(path_a, &engine, command, params);
+    QVERIFY(!key_a.isEmpty());
+    QCOMPARE(comp::ResultCache::cacheKey(path_b, &engine, command, params), key_a);
+    params["mu"] = "-0.3";
+    QVERIFY(comp::ResultCache::cacheKey(path_b, &engine, command, params) != key_a);
+  }
+
+  void testOutputCapture()
+  {
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+    comp::OutputLog log(tmp_dir.filePath("stdout.log"), 16);
+
+    // stream records are taken out, the incomplete line waits for more output
+    QByteArray buf = "first line\n[SQSTREAM] <physloc/>\nsecond li";
+    QCOMPARE(comp::takeStreamRecords(buf, &log, false), QByteArrayList({"<physloc/>"}));
+    QCOMPARE(buf, QByteArray("second li"));
+    buf.append("ne\nthird line\nlast");
+    QVERIFY(comp::takeStreamRecords(buf, &log, true).isEmpty());
+    QVERIFY(buf.isEmpty());
+
+    // the ring keeps complete lines within the last 16 bytes, the log file all
+    QCOMPARE(log.totalBytes(), qint64(38));
+    QVERIFY(log.text().startsWith("[23 bytes of earlier output omitted"));
+    QVERIFY(log.text().endsWith("]\nthird line\nlast"));
+    QFile spill(log.spillPath());
+    QVERIFY(spill.open(QFile::ReadOnly));
+    QCOMPARE(spill.readAll(), QByteArray("first line\nsecond line\nthird line\nlast"));
+  }
+
+  void testOccupancyGrid()
+  {
+    // placeholder pointers, the grid never dereferences them
+    prim::DBDot *db1 = reinterpret_cast<prim::DBDot*>(quintptr(0x10));
+    prim::DBDot *db2 = reinterpret_cast<prim::DBDot*>(quintptr(0x20));
+    prim::OccupancyGrid grid(2);
+
+    // sites on both sides of a chunk boundary and at negative coordinates
+    grid.set(prim::LatticeCoord(63, 0, 1), db1);
+    grid.set(prim::LatticeCoord(-1, -70, 0), db2);
+    QVERIFY(grid.contains(prim::LatticeCoord(63, 0, 1)));
+    QVERIFY(!grid.contains(prim::LatticeCoord(63, 0, 0)));
+    QVERIFY(!grid.contains(prim::LatticeCoord(64, 0, 1)));
+    QVERIFY(!grid.contains(prim::LatticeCoord(63, 0, 2)));
+    QCOMPARE(grid.at(prim::LatticeCoord(-1, -70, 0)), db2);
+    QCOMPARE(grid.count(), 2);
+
+    QCOMPARE(grid.dbsInRange(-5, -100, 100, 0), QList<prim::DBDot*>({db2, db1}));
+    QCOMPARE(grid.dbsInRange(0, -100, 62, 100), QList<prim::DBDot*>());
+    QCOMPARE(grid.unoccupied({prim::LatticeCoord(63, 0, 0), prim::LatticeCoord(63, 0, 1)}),
+             QList<prim::LatticeCoord>({prim::LatticeCoord(63, 0, 0)}));
+
+    // site indices n*n_cell+l run contiguously across chunks
+    QCOMPARE(grid.occupancyWord(0, 100), quint64(1) << 27);
+    QCOMPARE(grid.occupancyWord(-70, -10), quint64(1) << 8);
+    QCOMPARE(grid.occupancyWord(1, 100), quint64(0));
+
+    grid.set(prim::LatticeCoord(63, 0, 1), nullptr);
+    QVERIFY(!grid.contains(prim::LatticeCoord(63, 0, 1)));
+    QCOMPARE(grid.at(prim::LatticeCoord(63, 0, 1)), static_cast<prim::DBDot*>(nullptr));
+    QCOMPARE(grid.count(), 1);
+  }
+
+  void testResourceLimits()
+  {
+    QList<int> cpus;
+    QVERIFY(comp::ResourceLimits::parseCpuList("0-2, 5,1", cpus));
+    QCOMPARE(cpus, QList<int>({0, 1, 2, 5}));
+    QVERIFY(comp::ResourceLimits::parseCpuList("", cpus));
+    QVERIFY(cpus.isEmpty());
+    QVERIFY(!comp::ResourceLimits::parseCpuList("3-1", cpus));
+    QVERIFY(!comp::ResourceLimits::parseCpuList("0-1-2", cpus));
+    QVERIFY(!comp::ResourceLimits::parseCpuList("a", cpus));
+    QVERIFY(!comp::ResourceLimits::parseCpuList("0-99999999", cpus));
+
+    // usage deltas keep the lifetime peak RSS
+    comp::ResourceUsage earlier, later;
+    earlier.user_s = 1; earlier.sys_s = 0.5; earlier.peak_rss_kb = 100;
+    earlier.read_bytes = 10; earlier.write_bytes = 20;
+    later = earlier;
+    later.user_s = 3; later.read_bytes = 15; later.peak_rss_kb = 200;
+    comp::ResourceUsage delta = later.since(earlier);
+    QCOMPARE(delta.user_s, 2.);
+    QCOMPARE(delta.sys_s, 0.);
+    QCOMPARE(delta.read_bytes, qint64(5));
+    QCOMPARE(delta.peak_rss_kb, qint64(200));
+  }
+
+  void testPotentialRaster()
+  {
+    // 3x2 grid of samples in no particular order
+    QByteArray pots =
+      "<potential_map>"
+      "<potential_val x=\"2\" y=\"0\" val=\"0.5\"/>"
+      "<potential_val x=\"0\" y=\"0\" val=\"-1\"/>"
+      "<potential_val x=\"1\" y=\"1\" val=\"0\"/>"
+      "<potential_val x=\"1\" y=\"0\" val=\"0\"/>"
+      "<potential_val x=\"0\" y=\"1\" val=\"0\"/>"
+      "<potential_val x=\"2\" y=\"1\" val=\"0\"/>"
+      "</potential_map>";
+    QXmlStreamReader rs(pots);
+    rs.readNextStartElement();
+    comp::PotentialLandscape landscape(&rs, QString());
+
+    QVector<QImage> pyramid = landscape.rasterPyramid();
+    QCOMPARE(pyramid.size(), 1);
+    QCOMPARE(pyramid.first().size(), QSize(3, 2));
+    QCOMPARE(pyramid.first().pixel(0, 0), qRgb(0, 0, 255));
+    QCOMPARE(pyramid.first().pixel(1, 1), qRgb(255, 255, 255));
+    QCOMPARE(pyramid.first().pixel(2, 0), qRgb(255, 127, 127));
+    QCOMPARE(landscape.rasterBounds(), QRectF(-0.5, -0.5, 3, 2));
+
+    // scattered samples whose coordinate counts multiply up to the sample 
+    // count aren't rasterized
+    QList<QByteArray> scattered({
+        "<potential_map>"   // uneven spacing
+        "<potential_val x=\"0\" y=\"0\" val=\"0\"/>"
+        "<potential_val x=\"1\" y=\"0\" val=\"0\"/>"
+        "<potential_val x=\"3\" y=\"0\" val=\"0\"/>"
+        "</potential_map>",
+        "<potential_map>"   // repeated point leaving a hole
+        "<potential_val x=\"0\" y=\"0\" val=\"0\"/>"
+        "<potential_val x=\"0\" y=\"0\" val=\"0\"/>"
+        "<potential_val x=\"1\" y=\"1\" val=\"0\"/>"
+        "<potential_val x=\"1\" y=\"0\" val=\"0\"/>"
+        "</potential_map>"});
+    for (const QByteArray &scattered_pots : scattered) {
+      QXmlStreamReader scattered_rs(scattered_pots);
+      scattered_rs.readNextStartElement();
+      comp::PotentialLandscape scattered_landscape(&scattered_rs, QString());
+      QVERIFY(scattered_landscape.rasterPyramid().isEmpty());
+    }
+  }
+
 };
 
 QTEST_MAIN(SiQADTests)